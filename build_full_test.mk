@@ -30,4 +30,6 @@ $(TEST)_SRC += $(patsubst $(ROOTDIR)/%,%,$(wildcard $(TEST_PATH)/*.cpp))
 
 $(TEST)_DEFS=$(TMK_COMMON_DEFS) $(OPT_DEFS)
 $(TEST)_CONFIG=$(TEST_PATH)/config.h
+# the config.h of the test is found like the one of a keyboard
+VPATH+=$(TOP_DIR)/$(TEST_PATH)
 VPATH+=$(TOP_DIR)/tests/test_common
@@ -344,6 +344,19 @@ VPATH += $(KEYBOARD_PATHS)
 VPATH += $(COMMON_VPATH)
 
 include common_features.mk
+
+# The LED geometry tables are generated after common_features.mk, once RGB_MATRIX_ENABLE is final
+ifeq ($(strip $(RGB_MATRIX_ENABLE)), yes)
+    OPT_DEFS += -DRGB_MATRIX_GEOMETRY_H=\"$(KEYBOARD_OUTPUT)/src/rgb_matrix_geometry.h\"
+    # the tables are checked against the g_led_config of the keyboard's C files, so they are inputs as well
+    RGB_MATRIX_GEOMETRY_SOURCES := $(wildcard $(addsuffix /*.c,$(KEYBOARD_PATHS)))
+
+$(KEYBOARD_OUTPUT)/src/rgb_matrix_geometry.h: $(INFO_JSON_FILES) $(RGB_MATRIX_GEOMETRY_SOURCES)
+	bin/qmk generate-rgb-matrix-geometry --quiet --keyboard $(KEYBOARD) --output $(KEYBOARD_OUTPUT)/src/rgb_matrix_geometry.h
+
+generated-files: $(KEYBOARD_OUTPUT)/src/rgb_matrix_geometry.h
+endif
+
 include $(TMK_PATH)/protocol.mk
 include $(TMK_PATH)/common.mk
 include bootloader.mk
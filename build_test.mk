@@ -49,8 +49,13 @@ endif
 
 include common_features.mk
 include $(TMK_PATH)/common.mk
+include $(DRIVER_PATH)/avr/tests/rules.mk
+include $(DRIVER_PATH)/oled/tests/rules.mk
+include $(QUANTUM_PATH)/debounce/tests/rules.mk
 include $(QUANTUM_PATH)/sequencer/tests/rules.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(QUANTUM_PATH)/split_common/tests/rules.mk
+include $(TMK_PATH)/common/chibios/tests/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
 endif
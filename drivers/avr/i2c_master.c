@@ -18,7 +18,10 @@
  */
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <util/twi.h>
+#include <string.h>
 
 #include "i2c_master.h"
 #include "timer.h"
@@ -30,6 +33,112 @@
 
 #define TWBR_val (((F_CPU / F_SCL) - 16) / 2)
 
+#if I2C_ASYNC_BUFFER_SIZE > 0
+#    if I2C_ASYNC_BUFFER_SIZE > 0x7FFF
+#        error I2C_ASYNC_BUFFER_SIZE must be 32767 or less
+#    endif
+
+/* Every queued job is the shifted address, the length as two bytes and the data. Jobs never wrap around
+ * the end of the buffer, a job that doesn't fit there starts at the beginning and the end is marked as
+ * unused with an odd address.
+ */
+#    define ASYNC_HEADER_SIZE 3
+#    define ASYNC_UNUSED 0xFF
+
+static uint8_t               async_buffer[I2C_ASYNC_BUFFER_SIZE];
+static uint16_t              async_head;  // where the next job is queued
+static volatile uint16_t     async_tail;  // the job being sent
+static volatile uint16_t     async_used;  // bytes between tail and head, including an unused end
+static uint16_t              async_sent;  // bytes of the current job sent so far
+static volatile i2c_status_t async_status = I2C_STATUS_SUCCESS;
+volatile bool                i2c_async_active;
+
+static inline uint16_t async_job_length(const uint8_t* job) { return job[1] | (job[2] << 8); }
+
+// starts the next job, or releases the bus when the queue is empty, always called with interrupts disabled
+static void async_next(uint8_t stop) {
+    if (async_used && async_buffer[async_tail] == ASYNC_UNUSED) {
+        async_used -= I2C_ASYNC_BUFFER_SIZE - async_tail;
+        async_tail = 0;
+    }
+
+    if (async_used) {
+        i2c_async_active = true;
+        TWCR             = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | (1 << TWSTA) | (stop << TWSTO);
+    } else {
+        i2c_async_active = false;
+        TWCR             = (1 << TWINT) | (1 << TWEN) | (stop << TWSTO);
+    }
+}
+
+void i2c_async_isr(void) {
+    const uint8_t* job = &async_buffer[async_tail];
+
+    switch (TW_STATUS) {
+        case TW_START:
+        case TW_REP_START:
+            async_sent = 0;
+            TWDR       = job[0];
+            TWCR       = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+            return;
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (async_sent < async_job_length(job)) {
+                TWDR = job[ASYNC_HEADER_SIZE + async_sent++];
+                TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+                return;
+            }
+            break;
+        default:
+            // the job is dropped, the next one may well be for another device
+            async_status = I2C_STATUS_ERROR;
+            break;
+    }
+
+    uint16_t size = ASYNC_HEADER_SIZE + async_job_length(job);
+    async_tail += size;
+    if (async_tail == I2C_ASYNC_BUFFER_SIZE) {
+        async_tail = 0;
+    }
+    async_used -= size;
+    async_next(1);
+}
+
+// i2c_slave provides the interrupt when both are used
+ISR(TWI_vect, __attribute__((weak))) { i2c_async_isr(); }
+
+static uint16_t async_room(void) {
+    uint16_t used;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { used = async_used; }
+    return I2C_ASYNC_BUFFER_SIZE - used;
+}
+
+// waits until `room` bytes are free in the queue, the queue is dropped when it stops moving for the timeout
+static i2c_status_t async_wait(uint16_t room, uint16_t timeout) {
+    uint16_t timeout_timer = timer_read();
+    uint16_t last_room     = async_room();
+    while (last_room < room) {
+        if (timeout == I2C_TIMEOUT_IMMEDIATE) {
+            // not waiting at all, the queue is still moving
+            return I2C_STATUS_TIMEOUT;
+        }
+        uint16_t current = async_room();
+        if (current != last_room) {
+            last_room     = current;
+            timeout_timer = timer_read();
+        } else if ((timeout != I2C_TIMEOUT_INFINITE) && ((timer_read() - timeout_timer) >= timeout)) {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                TWCR             = 0;
+                async_used       = 0;
+                i2c_async_active = false;
+            }
+            return I2C_STATUS_TIMEOUT;
+        }
+    }
+    return I2C_STATUS_SUCCESS;
+}
+#endif
+
 void i2c_init(void) {
     TWSR = 0; /* no prescaler */
     TWBR = (uint8_t)TWBR_val;
@@ -48,6 +157,13 @@ void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address, uint16_t timeout) {
+#if I2C_ASYNC_BUFFER_SIZE > 0
+    // queued transmissions go first
+    if (async_wait(I2C_ASYNC_BUFFER_SIZE, timeout) < 0) {
+        return I2C_STATUS_TIMEOUT;
+    }
+#endif
+
     // reset TWI control register
     TWCR = 0;
     // transmit START condition
@@ -222,3 +338,69 @@ void i2c_stop(void) {
     // transmit STOP condition
     TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
 }
+
+#if I2C_ASYNC_BUFFER_SIZE > 0
+static i2c_status_t async_queue(uint8_t address, const uint8_t* prefix, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    uint16_t data_length = length + (prefix ? 1 : 0);
+    uint16_t size        = ASYNC_HEADER_SIZE + data_length;
+    if (size > I2C_ASYNC_BUFFER_SIZE) {
+        // too big to be queued at all, the queue is sent first by the synchronous functions
+        return prefix ? i2c_writeReg(address, *prefix, data, length, timeout) : i2c_transmit(address, data, length, timeout);
+    }
+
+    uint16_t head, need;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!async_used) {
+            async_head = async_tail = 0;
+        }
+        head = async_head;
+    }
+    // the end of the buffer is left unused when the job doesn't fit there
+    need = I2C_ASYNC_BUFFER_SIZE - head < size ? I2C_ASYNC_BUFFER_SIZE - head + size : size;
+    if (async_wait(need, timeout) < 0) {
+        return I2C_STATUS_TIMEOUT;
+    }
+    if (need != size) {
+        async_buffer[head] = ASYNC_UNUSED;
+        head               = 0;
+    }
+    uint8_t* job = &async_buffer[head];
+    job[0]       = address;
+    job[1]       = data_length & 0xFF;
+    job[2]       = data_length >> 8;
+    job += ASYNC_HEADER_SIZE;
+    if (prefix) {
+        *job++ = *prefix;
+    }
+    memcpy(job, data, length);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        async_head = head + size == I2C_ASYNC_BUFFER_SIZE ? 0 : head + size;
+        async_used += need;
+        if (!i2c_async_active) {
+            async_next(0);
+        }
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) { return async_queue(address | I2C_WRITE, NULL, data, length, timeout); }
+
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) { return async_queue(devaddr | I2C_WRITE, &regaddr, data, length, timeout); }
+
+i2c_status_t i2c_async_flush(uint16_t timeout) {
+    if (async_wait(I2C_ASYNC_BUFFER_SIZE, timeout) < 0) {
+        return I2C_STATUS_TIMEOUT;
+    }
+
+    i2c_status_t status = async_status;
+    async_status        = I2C_STATUS_SUCCESS;
+    return status;
+}
+#else
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_transmit(address, data, length, timeout); }
+
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_writeReg(devaddr, regaddr, data, length, timeout); }
+
+i2c_status_t i2c_async_flush(uint16_t timeout) { return I2C_STATUS_SUCCESS; }
+#endif
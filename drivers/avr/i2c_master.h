@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define I2C_READ 0x01
 #define I2C_WRITE 0x00
 
@@ -31,6 +34,11 @@ typedef int16_t i2c_status_t;
 #define I2C_TIMEOUT_IMMEDIATE (0)
 #define I2C_TIMEOUT_INFINITE (0xFFFF)
 
+// size of the buffer queuing asynchronous transmissions, 0 makes them synchronous
+#ifndef I2C_ASYNC_BUFFER_SIZE
+#    define I2C_ASYNC_BUFFER_SIZE 0
+#endif
+
 void         i2c_init(void);
 i2c_status_t i2c_start(uint8_t address, uint16_t timeout);
 i2c_status_t i2c_write(uint8_t data, uint16_t timeout);
@@ -41,3 +49,17 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout);
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 void         i2c_stop(void);
+
+/* The data of asynchronous transmissions is copied into a queue sent from the TWI interrupt, so the
+ * buffer can be reused right away. The functions only wait when the queue is full, and the synchronous
+ * ones wait for it to be empty. Errors are reported by i2c_async_flush().
+ */
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_async_flush(uint16_t timeout);
+
+#if I2C_ASYNC_BUFFER_SIZE > 0
+// set while the queue is being sent, the TWI interrupt of i2c_slave hands over to i2c_async_isr() then
+extern volatile bool i2c_async_active;
+void                 i2c_async_isr(void);
+#endif
@@ -23,6 +23,7 @@
 #include <stdbool.h>
 
 #include "i2c_slave.h"
+#include "i2c_master.h"
 
 volatile uint8_t i2c_slave_reg[I2C_SLAVE_REG_COUNT];
 
@@ -42,6 +43,14 @@ void i2c_slave_stop(void) {
 }
 
 ISR(TWI_vect) {
+#if I2C_ASYNC_BUFFER_SIZE > 0
+    // the master is sending its queue
+    if (i2c_async_active) {
+        i2c_async_isr();
+        return;
+    }
+#endif
+
     uint8_t ack = 1;
 
     switch (TW_STATUS) {
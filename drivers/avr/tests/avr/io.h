@@ -0,0 +1,46 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// The TWI registers of the ATmega, simulated by twi_mock.c
+
+#include <stdint.h>
+
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+
+// Every access to TWCR goes through twi_mock_twcr(), that is how the mock sees what the driver writes
+#define TWCR (*twi_mock_twcr())
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+volatile uint16_t *twi_mock_twcr(void);
+
+extern volatile uint8_t TWDR;
+extern volatile uint8_t TWSR;
+extern volatile uint8_t TWBR;
+
+#ifdef __cplusplus
+}
+#endif
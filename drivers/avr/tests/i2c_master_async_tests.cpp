@@ -0,0 +1,132 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "i2c_master.h"
+#include "twi_mock.h"
+}
+
+// The queue is I2C_ASYNC_BUFFER_SIZE bytes, every transfer takes its length and a header of 3 bytes
+class I2cMasterAsync : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        twi_mock_reset();
+        i2c_init();
+        // a failure left over from a previous test
+        ASSERT_EQ(i2c_async_flush(100), I2C_STATUS_SUCCESS);
+        twi_mock_log[0] = '\0';
+    }
+
+    // lets the bus run until `text` went over it
+    void run_until(const std::string &text) {
+        for (int i = 0; i < 1000 && log().find(text) == std::string::npos; i++) {
+            twi_mock_tick();
+        }
+        ASSERT_NE(log().find(text), std::string::npos) << log();
+    }
+
+    void run() {
+        for (int i = 0; i < 1000 && !twi_mock_idle(); i++) {
+            twi_mock_tick();
+        }
+    }
+
+    std::string log() { return twi_mock_log; }
+
+    const uint8_t data[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+};
+
+TEST_F(I2cMasterAsync, TransfersAreSentInOrder) {
+    EXPECT_EQ(i2c_transmit_async(0x20, data + 1, 2, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_writeReg_async(0x22, 0x10, data + 3, 1, 100), I2C_STATUS_SUCCESS);
+
+    // the synchronous transfers wait for the queue
+    EXPECT_EQ(i2c_transmit(0x24, data + 4, 1, 100), I2C_STATUS_SUCCESS);
+    run();
+    EXPECT_EQ(log(), "S 20 01 02 P S 22 10 03 P S 24 04 P");
+    EXPECT_EQ(i2c_async_flush(100), I2C_STATUS_SUCCESS);
+}
+
+TEST_F(I2cMasterAsync, DataIsCopied) {
+    uint8_t buffer[2] = {0x11, 0x22};
+    EXPECT_EQ(i2c_transmit_async(0x20, buffer, sizeof(buffer), 100), I2C_STATUS_SUCCESS);
+    buffer[0] = 0x33;
+    EXPECT_EQ(i2c_async_flush(100), I2C_STATUS_SUCCESS);
+    run();
+    EXPECT_EQ(log(), "S 20 11 22 P");
+}
+
+TEST_F(I2cMasterAsync, TransfersLargerThanTheQueueAreSentRightAway) {
+    EXPECT_EQ(i2c_transmit_async(0x20, data + 1, 1, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_transmit_async(0x22, data, 14, 100), I2C_STATUS_SUCCESS);
+    run();
+    EXPECT_EQ(log(), "S 20 01 P S 22 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D P");
+}
+
+TEST_F(I2cMasterAsync, AFullQueueWaitsForRoom) {
+    twi_mock_stalled = true;
+    EXPECT_EQ(i2c_transmit_async(0x20, data + 1, 5, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_transmit_async(0x22, data + 1, 3, 100), I2C_STATUS_SUCCESS);
+    twi_mock_stalled = false;
+
+    // the third one doesn't fit at the end, it waits for the first one and goes at the start of the buffer
+    run_until("S 22");
+    EXPECT_EQ(i2c_transmit_async(0x24, data + 1, 3, 100), I2C_STATUS_SUCCESS);
+    run();
+    EXPECT_EQ(log(), "S 20 01 02 03 04 05 P S 22 01 02 03 P S 24 01 02 03 P");
+}
+
+TEST_F(I2cMasterAsync, ImmediateTimeoutKeepsTheQueue) {
+    EXPECT_EQ(i2c_async_flush(I2C_TIMEOUT_IMMEDIATE), I2C_STATUS_SUCCESS);
+
+    twi_mock_stalled = true;
+    EXPECT_EQ(i2c_transmit_async(0x20, data + 1, 5, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_transmit_async(0x22, data + 1, 6, I2C_TIMEOUT_IMMEDIATE), I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(i2c_async_flush(I2C_TIMEOUT_IMMEDIATE), I2C_STATUS_TIMEOUT);
+
+    twi_mock_stalled = false;
+    EXPECT_EQ(i2c_async_flush(100), I2C_STATUS_SUCCESS);
+    run();
+    EXPECT_EQ(log(), "S 20 01 02 03 04 05 P");
+}
+
+TEST_F(I2cMasterAsync, AStuckBusDropsTheQueue) {
+    twi_mock_stalled = true;
+    EXPECT_EQ(i2c_transmit_async(0x20, data + 1, 5, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_async_flush(10), I2C_STATUS_TIMEOUT);
+
+    twi_mock_stalled = false;
+    run();
+    EXPECT_EQ(log(), "");
+    EXPECT_EQ(i2c_transmit_async(0x22, data + 1, 1, 100), I2C_STATUS_SUCCESS);
+    run();
+    EXPECT_EQ(log(), "S 22 01 P");
+}
+
+TEST_F(I2cMasterAsync, ErrorsAreReportedByTheFlush) {
+    twi_mock_nack_address = 0x20;
+    EXPECT_EQ(i2c_transmit_async(0x20, data + 1, 2, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_transmit_async(0x22, data + 1, 2, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_async_flush(100), I2C_STATUS_ERROR);
+    run();
+    // the next transfer is still sent
+    EXPECT_EQ(log(), "S 20 P S 22 01 02 P");
+    EXPECT_EQ(i2c_async_flush(100), I2C_STATUS_SUCCESS);
+}
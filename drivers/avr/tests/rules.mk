@@ -0,0 +1,10 @@
+# The AVR driver runs against a simulated TWI, see twi_mock.c
+
+i2c_master_async_DEFS := -DNO_DEBUG -DF_CPU=16000000UL -DI2C_ASYNC_BUFFER_SIZE=16
+
+i2c_master_async_SRC := \
+	$(DRIVER_PATH)/avr/tests/i2c_master_async_tests.cpp \
+	$(DRIVER_PATH)/avr/tests/twi_mock.c \
+	$(DRIVER_PATH)/avr/i2c_master.c
+
+i2c_master_async_INC := $(DRIVER_PATH)/avr/tests $(DRIVER_PATH)/avr
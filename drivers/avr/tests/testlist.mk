@@ -0,0 +1 @@
+TEST_LIST += i2c_master_async
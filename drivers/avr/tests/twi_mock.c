@@ -0,0 +1,132 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <util/twi.h>
+
+#include "twi_mock.h"
+#include "timer.h"
+
+// Set by the mock on the value it leaves in TWCR, so that any write of the driver shows, even of the same value
+#define TWCR_SEEN (1 << 8)
+
+char    twi_mock_log[1024];
+uint8_t twi_mock_nack_address;
+bool    twi_mock_stalled;
+
+volatile uint8_t TWDR;
+volatile uint8_t TWSR;
+volatile uint8_t TWBR;
+
+static volatile uint16_t twcr = TWCR_SEEN;
+static uint8_t           command;  // the last value written by the driver
+static bool              pending;  // whether the command is yet to be carried out
+static uint16_t          time;
+
+// only writes are simulated
+static enum { BUS_IDLE, BUS_ADDRESS, BUS_DATA } bus;
+
+// the interrupt handler of the driver
+void TWI_vect(void);
+
+static void log_bus(const char *text) {
+    size_t length = strlen(twi_mock_log);
+    snprintf(twi_mock_log + length, sizeof(twi_mock_log) - length, "%s%s", length ? " " : "", text);
+}
+
+static void latch(void) {
+    if (twcr & TWCR_SEEN) {
+        return;
+    }
+
+    command = twcr;
+    if (!(command & (1 << TWEN))) {
+        // disabling the TWI drops what it was doing
+        bus     = BUS_IDLE;
+        pending = false;
+    } else {
+        pending = true;
+    }
+    // writing TWINT clears it
+    twcr = (command & ~(1 << TWINT)) | TWCR_SEEN;
+}
+
+volatile uint16_t *twi_mock_twcr(void) {
+    latch();
+    return &twcr;
+}
+
+void twi_mock_reset(void) {
+    twcr                  = TWCR_SEEN;
+    command               = 0;
+    pending               = false;
+    bus                   = BUS_IDLE;
+    twi_mock_log[0]       = '\0';
+    twi_mock_nack_address = 0;
+    twi_mock_stalled      = false;
+}
+
+bool twi_mock_idle(void) {
+    latch();
+    return !pending;
+}
+
+void twi_mock_tick(void) {
+    latch();
+    if (!pending || twi_mock_stalled) {
+        return;
+    }
+    pending = false;
+
+    if (command & (1 << TWSTO)) {
+        log_bus("P");
+        bus = BUS_IDLE;
+        // a stop clears TWSTO and doesn't raise TWINT, unless a start follows it
+        twcr &= ~(1 << TWSTO);
+        if (!(command & (1 << TWSTA))) {
+            return;
+        }
+    }
+
+    char byte[3];
+    if (command & (1 << TWSTA)) {
+        log_bus("S");
+        TWSR = bus == BUS_IDLE ? TW_START : TW_REP_START;
+        bus  = BUS_ADDRESS;
+    } else if (bus == BUS_ADDRESS) {
+        snprintf(byte, sizeof(byte), "%02X", TWDR);
+        log_bus(byte);
+        TWSR = TWDR == twi_mock_nack_address ? TW_MT_SLA_NACK : TW_MT_SLA_ACK;
+        bus  = BUS_DATA;
+    } else {
+        snprintf(byte, sizeof(byte), "%02X", TWDR);
+        log_bus(byte);
+        TWSR = TW_MT_DATA_ACK;
+    }
+
+    twcr |= 1 << TWINT;
+    if (command & (1 << TWIE)) {
+        TWI_vect();
+    }
+}
+
+// Time only passes while the driver waits, a millisecond every time it looks at the timer, and the bus takes a step each time
+uint16_t timer_read(void) {
+    twi_mock_tick();
+    return time++;
+}
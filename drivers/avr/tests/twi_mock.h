@@ -0,0 +1,38 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// What went over the bus, "S" for a start, "P" for a stop and the bytes in hex, separated by spaces
+extern char twi_mock_log[1024];
+
+// The shifted address that doesn't acknowledge, 0 when all of them do
+extern uint8_t twi_mock_nack_address;
+
+// Set when the bus doesn't move, like when a device holds SCL low
+extern bool twi_mock_stalled;
+
+// Puts the TWI back in its state after reset and clears the log
+void twi_mock_reset(void);
+
+// Carries out the last command written to TWCR, and raises the interrupt when it's done
+void twi_mock_tick(void);
+
+// Whether the last command written to TWCR has been carried out
+bool twi_mock_idle(void);
@@ -57,6 +57,94 @@ static i2c_status_t chibios_to_qmk(const msg_t* status) {
     }
 }
 
+#if I2C_ASYNC_BUFFER_SIZE > 0
+/* Every queued job is the shifted address, the length and the timeout as two bytes each, and the data.
+ * Jobs never wrap around the end of the buffer, a job that doesn't fit there starts at the beginning and
+ * the end is marked as unused with an odd address.
+ */
+#    define ASYNC_HEADER_SIZE 5
+#    define ASYNC_UNUSED 0xFF
+
+static uint8_t      async_buffer[I2C_ASYNC_BUFFER_SIZE];
+static uint16_t     async_head;  // where the next job is queued
+static uint16_t     async_tail;  // the job being sent
+static uint16_t     async_used;  // bytes between tail and head, including an unused end
+static i2c_status_t async_status = I2C_STATUS_SUCCESS;
+static thread_t*    async_thread;
+static SEMAPHORE_DECL(async_jobs, 0);
+static BSEMAPHORE_DECL(async_progress, true);
+
+static THD_WORKING_AREA(waI2cAsyncThread, 256);
+static THD_FUNCTION(I2cAsyncThread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_async");
+
+    while (true) {
+        chSemWait(&async_jobs);
+
+        chSysLock();
+        if (async_buffer[async_tail] == ASYNC_UNUSED) {
+            async_used -= I2C_ASYNC_BUFFER_SIZE - async_tail;
+            async_tail = 0;
+        }
+        chSysUnlock();
+
+        // the job can't be overwritten before it is released below
+        const uint8_t* job     = &async_buffer[async_tail];
+        uint16_t       length  = job[1] | (job[2] << 8);
+        uint16_t       timeout = job[3] | (job[4] << 8);
+        i2cStart(&I2C_DRIVER, &i2cconfig);
+        msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (job[0] >> 1), job + ASYNC_HEADER_SIZE, length, 0, 0, TIME_MS2I(timeout));
+
+        chSysLock();
+        if (status != I2C_NO_ERROR && async_status == I2C_STATUS_SUCCESS) {
+            async_status = chibios_to_qmk(&status);
+        }
+        async_tail += ASYNC_HEADER_SIZE + length;
+        if (async_tail == I2C_ASYNC_BUFFER_SIZE) {
+            async_tail = 0;
+        }
+        async_used -= ASYNC_HEADER_SIZE + length;
+        chBSemSignalI(&async_progress);
+        chSchRescheduleS();
+        chSysUnlock();
+    }
+}
+
+// waits until `room` bytes are free in the queue
+static i2c_status_t async_wait(uint16_t room, sysinterval_t timeout) {
+    systime_t start = chVTGetSystemTime();
+    while (true) {
+        chSysLock();
+        uint16_t free = I2C_ASYNC_BUFFER_SIZE - async_used;
+        chSysUnlock();
+        if (free >= room) {
+            return I2C_STATUS_SUCCESS;
+        }
+
+        sysinterval_t remaining = TIME_INFINITE;
+        if (timeout != TIME_INFINITE) {
+            sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+            if (elapsed >= timeout) {
+                return I2C_STATUS_TIMEOUT;
+            }
+            remaining = timeout - elapsed;
+        }
+        chBSemWaitTimeout(&async_progress, remaining);
+    }
+}
+
+// queued transmissions go first, the thread gives up on each of them after its own timeout
+#    define ASYNC_DRAIN(timeout)                                                     \
+        do {                                                                         \
+            if (async_wait(I2C_ASYNC_BUFFER_SIZE, (timeout)) != I2C_STATUS_SUCCESS) { \
+                return I2C_STATUS_TIMEOUT;                                           \
+            }                                                                        \
+        } while (0)
+#else
+#    define ASYNC_DRAIN(timeout)
+#endif
+
 __attribute__((weak)) void i2c_init(void) {
     static bool is_initialised = false;
     if (!is_initialised) {
@@ -78,12 +166,14 @@ __attribute__((weak)) void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address) {
+    ASYNC_DRAIN(TIME_INFINITE);
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    ASYNC_DRAIN(TIME_MS2I(timeout));
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
@@ -91,6 +181,7 @@ i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length,
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    ASYNC_DRAIN(TIME_MS2I(timeout));
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
@@ -98,6 +189,7 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    ASYNC_DRAIN(TIME_MS2I(timeout));
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -112,10 +204,89 @@ i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data,
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    ASYNC_DRAIN(TIME_MS2I(timeout));
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
     return chibios_to_qmk(&status);
 }
 
-void i2c_stop(void) { i2cStop(&I2C_DRIVER); }
+void i2c_stop(void) {
+#if I2C_ASYNC_BUFFER_SIZE > 0
+    async_wait(I2C_ASYNC_BUFFER_SIZE, TIME_INFINITE);
+#endif
+    i2cStop(&I2C_DRIVER);
+}
+
+#if I2C_ASYNC_BUFFER_SIZE > 0
+static i2c_status_t async_queue(uint8_t address, const uint8_t* prefix, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    uint16_t data_length = length + (prefix ? 1 : 0);
+    uint16_t size        = ASYNC_HEADER_SIZE + data_length;
+    if (size > I2C_ASYNC_BUFFER_SIZE) {
+        // too big to be queued at all, the queue is sent first by the synchronous functions
+        return prefix ? i2c_writeReg(address, *prefix, data, length, timeout) : i2c_transmit(address, data, length, timeout);
+    }
+
+    if (!async_thread) {
+        async_thread = chThdCreateStatic(waI2cAsyncThread, sizeof(waI2cAsyncThread), NORMALPRIO + 1, I2cAsyncThread, NULL);
+    }
+
+    chSysLock();
+    if (!async_used) {
+        async_head = async_tail = 0;
+    }
+    chSysUnlock();
+    uint16_t head = async_head;
+    // the end of the buffer is left unused when the job doesn't fit there
+    uint16_t need = I2C_ASYNC_BUFFER_SIZE - head < size ? I2C_ASYNC_BUFFER_SIZE - head + size : size;
+    if (async_wait(need, TIME_MS2I(timeout)) != I2C_STATUS_SUCCESS) {
+        return I2C_STATUS_TIMEOUT;
+    }
+
+    if (need != size) {
+        async_buffer[head] = ASYNC_UNUSED;
+        head               = 0;
+    }
+    uint8_t* job = &async_buffer[head];
+    job[0]       = address;
+    job[1]       = data_length & 0xFF;
+    job[2]       = data_length >> 8;
+    job[3]       = timeout & 0xFF;
+    job[4]       = timeout >> 8;
+    job += ASYNC_HEADER_SIZE;
+    if (prefix) {
+        *job++ = *prefix;
+    }
+    memcpy(job, data, length);
+
+    chSysLock();
+    async_head = head + size == I2C_ASYNC_BUFFER_SIZE ? 0 : head + size;
+    async_used += need;
+    chSemSignalI(&async_jobs);
+    chSchRescheduleS();
+    chSysUnlock();
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) { return async_queue(address, NULL, data, length, timeout); }
+
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) { return async_queue(devaddr, &regaddr, data, length, timeout); }
+
+i2c_status_t i2c_async_flush(uint16_t timeout) {
+    if (async_wait(I2C_ASYNC_BUFFER_SIZE, TIME_MS2I(timeout)) != I2C_STATUS_SUCCESS) {
+        return I2C_STATUS_TIMEOUT;
+    }
+
+    chSysLock();
+    i2c_status_t status = async_status;
+    async_status        = I2C_STATUS_SUCCESS;
+    chSysUnlock();
+    return status;
+}
+#else
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_transmit(address, data, length, timeout); }
+
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_writeReg(devaddr, regaddr, data, length, timeout); }
+
+i2c_status_t i2c_async_flush(uint16_t timeout) { return I2C_STATUS_SUCCESS; }
+#endif
@@ -98,6 +98,11 @@
 #    endif
 #endif
 
+// size of the buffer queuing asynchronous transmissions, 0 makes them synchronous
+#ifndef I2C_ASYNC_BUFFER_SIZE
+#    define I2C_ASYNC_BUFFER_SIZE 0
+#endif
+
 typedef int16_t i2c_status_t;
 
 #define I2C_STATUS_SUCCESS (0)
@@ -111,3 +116,11 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout);
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 void         i2c_stop(void);
+
+/* The data of asynchronous transmissions is copied into a queue sent by a separate thread, so the
+ * buffer can be reused right away. The functions only wait when the queue is full, and the synchronous
+ * ones wait for it to be empty. Errors are reported by i2c_async_flush().
+ */
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_async_flush(uint16_t timeout);
@@ -39,50 +39,81 @@
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * 1250))
 #define PREAMBLE_SIZE 4
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+// Without WS2812_SPI_SYNC, a frame is encoded into one buffer while the previous one is still sent from the other
+#ifdef WS2812_SPI_SYNC
+#    define TX_BUFFERS 1
+#else
+#    define TX_BUFFERS 2
+#endif
+
+static uint8_t txbuf[TX_BUFFERS][PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {{0}};
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
+ * the ws2812b protocol, every bit of a LED byte is sent as 4 SPI bits with
+ * the appropriate timing: 0b1110 for a 1, 0b1000 for a 0. A nibble of the
+ * LED byte therefore takes two SPI bytes, which are looked up here.
  */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
+#define SPI_BITS(high, low) (((high) ? 0b11100000 : 0b10000000) | ((low) ? 0b1110 : 0b1000))
+#define SPI_NIBBLE(nibble) \
+    { SPI_BITS((nibble)&8, (nibble)&4), SPI_BITS((nibble)&2, (nibble)&1) }
+
+static const uint8_t nibble_patterns[16][2] = {
+    SPI_NIBBLE(0), SPI_NIBBLE(1), SPI_NIBBLE(2),  SPI_NIBBLE(3),  SPI_NIBBLE(4),  SPI_NIBBLE(5),  SPI_NIBBLE(6),  SPI_NIBBLE(7),
+    SPI_NIBBLE(8), SPI_NIBBLE(9), SPI_NIBBLE(10), SPI_NIBBLE(11), SPI_NIBBLE(12), SPI_NIBBLE(13), SPI_NIBBLE(14), SPI_NIBBLE(15),
+};
+
+static inline uint8_t* encode_byte(uint8_t* dst, uint8_t data) {
+    const uint8_t* high = nibble_patterns[data >> 4];
+    const uint8_t* low  = nibble_patterns[data & 0x0F];
+    dst[0]              = high[0];
+    dst[1]              = high[1];
+    dst[2]              = low[0];
+    dst[3]              = low[1];
+    return dst + BYTES_FOR_LED_BYTE;
 }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(uint8_t* buf, LED_TYPE color, int pos) {
+    uint8_t* tx = &buf[PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    tx = encode_byte(tx, color.g);
+    tx = encode_byte(tx, color.r);
+    encode_byte(tx, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    tx = encode_byte(tx, color.r);
+    tx = encode_byte(tx, color.g);
+    encode_byte(tx, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+    tx = encode_byte(tx, color.b);
+    tx = encode_byte(tx, color.g);
+    encode_byte(tx, color.r);
 #endif
 }
 
+#ifndef WS2812_SPI_SYNC
+// signaled by the SPI driver when a transfer is complete, taken until the first one is
+static BSEMAPHORE_DECL(tx_done, true);
+static bool tx_in_flight = false;
+
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    (void)spip;
+    chSysLockFromISR();
+    chBSemSignalI(&tx_done);
+    chSysUnlockFromISR();
+}
+#endif
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE);
 
     // TODO: more dynamic baudrate
     static const SPIConfig spicfg = {
+#ifdef WS2812_SPI_SYNC
         0, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
+#else
+        0, ws2812_spi_end_cb, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
+#endif
         SPI_CR1_BR_1 | SPI_CR1_BR_0  // baudrate : fpclk / 8 => 1tick is 0.32us (2.25 MHz)
     };
 
@@ -98,15 +129,27 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+#ifdef WS2812_SPI_SYNC
+    uint8_t* buf = txbuf[0];
+#else
+    // the other buffer may still be going out, this one was sent before it
+    static uint8_t back = 0;
+    uint8_t*       buf  = txbuf[back];
+#endif
+
     for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+        set_led_color_rgb(buf, ledarray[i], i);
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
 #ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiSend(&WS2812_SPI, sizeof(txbuf[0]), buf);
 #else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    // the SPI can only send one frame at a time, so wait for the previous one before starting this one
+    if (tx_in_flight) {
+        chBSemWait(&tx_done);
+    }
+    tx_in_flight = true;
+    spiStartSend(&WS2812_SPI, sizeof(txbuf[0]), buf);
+    back ^= 1;
 #endif
 }
@@ -61,8 +61,9 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+uint8_t  g_pwm_buffer[DRIVER_COUNT][144];
+// Bit n is set when the registers of the n-th 16 byte transfer changed since they were last sent.
+uint16_t g_pwm_buffer_update_required[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][18]             = {{0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -94,14 +95,18 @@ void IS31FL3731_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static uint16_t IS31FL3731_write_pwm_blocks(uint8_t addr, uint8_t *pwm_buffer, uint16_t blocks) {
     // assumes bank is already selected
+    // returns the blocks that could not be sent
 
-    // transmit PWM registers in 9 transfers of 16 bytes
+    // transmit the PWM registers of the requested blocks in transfers of 16 bytes
     // g_twi_transfer_buffer[] is 20 bytes
 
     // iterate over the pwm_buffer contents at 16 byte intervals
     for (int i = 0; i < 144; i += 16) {
+        uint16_t block = 1 << (i / 16);
+        if (!(blocks & block)) continue;
+
         // set the first register, e.g. 0x24, 0x34, 0x44, etc.
         g_twi_transfer_buffer[0] = 0x24 + i;
         // copy the data from i to i+15
@@ -113,14 +118,22 @@ void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
 
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) {
+                blocks &= ~block;
+                break;
+            }
         }
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+        if (i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) {
+            blocks &= ~block;
+        }
 #endif
     }
+    return blocks;
 }
 
+void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) { IS31FL3731_write_pwm_blocks(addr, pwm_buffer, 0x1FF); }
+
 void IS31FL3731_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, first enable software shutdown,
@@ -173,15 +186,22 @@ void IS31FL3731_init(uint8_t addr) {
     IS31FL3731_write_register(addr, ISSI_COMMANDREGISTER, 0);
 }
 
+// Only marks the transfer of the register to be sent if its value changes.
+static inline void IS31FL3731_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_update_required[driver] |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3731_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
         // Subtract 0x24 to get the second index of g_pwm_buffer
-        g_pwm_buffer[led.driver][led.r - 0x24]   = red;
-        g_pwm_buffer[led.driver][led.g - 0x24]   = green;
-        g_pwm_buffer[led.driver][led.b - 0x24]   = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3731_set_pwm(led.driver, led.r - 0x24, red);
+        IS31FL3731_set_pwm(led.driver, led.g - 0x24, green);
+        IS31FL3731_set_pwm(led.driver, led.b - 0x24, blue);
     }
 }
 
@@ -222,9 +242,14 @@ void IS31FL3731_set_led_control_register(uint8_t index, bool red, bool green, bo
 
 void IS31FL3731_update_pwm_buffers(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
-        IS31FL3731_write_pwm_buffer(addr, g_pwm_buffer[index]);
+        uint16_t blocks = g_pwm_buffer_update_required[index];
+        // the blocks that failed are sent again on the next update
+        g_pwm_buffer_update_required[index] = IS31FL3731_write_pwm_blocks(addr, g_pwm_buffer[index], blocks);
+        // the queued transfers only report their errors now, send all of them again then
+        if (i2c_async_flush(ISSI_TIMEOUT) != 0) {
+            g_pwm_buffer_update_required[index] = blocks;
+        }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3731_update_led_control_registers(uint8_t addr, uint8_t index) {
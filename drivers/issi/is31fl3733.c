@@ -65,8 +65,9 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3733_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+uint8_t  g_pwm_buffer[DRIVER_COUNT][192];
+// Bit n is set when the registers of the n-th 16 byte transfer changed since they were last sent.
+uint16_t g_pwm_buffer_update_required[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {{0}, {0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -90,14 +91,18 @@ bool IS31FL3733_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
     return true;
 }
 
-bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static uint16_t IS31FL3733_write_pwm_blocks(uint8_t addr, uint8_t *pwm_buffer, uint16_t blocks) {
     // Assumes PG1 is already selected.
-    // If any of the transactions fails function returns false.
-    // Transmit PWM registers in 12 transfers of 16 bytes.
+    // If any of the transactions fails function stops there, and returns the blocks that were not sent.
+    // The queued transactions only report their errors to i2c_async_flush().
+    // Transmit the PWM registers of the requested blocks in transfers of 16 bytes.
     // g_twi_transfer_buffer[] is 20 bytes
 
     // Iterate over the pwm_buffer contents at 16 byte intervals.
     for (int i = 0; i < 192; i += 16) {
+        uint16_t block = 1 << (i / 16);
+        if (!(blocks & block)) continue;
+
         g_twi_transfer_buffer[0] = i;
         // Copy the data from i to i+15.
         // Device will auto-increment register for data after the first byte
@@ -109,16 +114,21 @@ bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
             if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
-                return false;
+                return blocks;
             }
         }
 #else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
-            return false;
+        if (i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
+            return blocks;
         }
 #endif
+        blocks &= ~block;
     }
-    return true;
+    return blocks;
+}
+
+bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    return IS31FL3733_write_pwm_blocks(addr, pwm_buffer, 0xFFF) == 0;
 }
 
 void IS31FL3733_init(uint8_t addr, uint8_t sync) {
@@ -163,14 +173,21 @@ void IS31FL3733_init(uint8_t addr, uint8_t sync) {
     wait_ms(10);
 }
 
+// Only marks the transfer of the register to be sent if its value changes.
+static inline void IS31FL3733_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_update_required[driver] |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3733_set_pwm(led.driver, led.r, red);
+        IS31FL3733_set_pwm(led.driver, led.g, green);
+        IS31FL3733_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -216,12 +233,17 @@ void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
         IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
         // If any of the transactions fail we risk writing dirty PG0,
-        // refresh page 0 just in case.
-        if (!IS31FL3733_write_pwm_buffer(addr, g_pwm_buffer[index])) {
+        // refresh page 0 just in case. The blocks that were not sent are sent on the next update.
+        uint16_t blocks                     = g_pwm_buffer_update_required[index];
+        g_pwm_buffer_update_required[index] = IS31FL3733_write_pwm_blocks(addr, g_pwm_buffer[index], blocks);
+        // The queued transactions only report their errors now, all of them are sent again then.
+        if (i2c_async_flush(ISSI_TIMEOUT) != 0) {
+            g_pwm_buffer_update_required[index] = blocks;
+        }
+        if (g_pwm_buffer_update_required[index]) {
             g_led_control_registers_update_required[index] = true;
         }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -232,6 +254,7 @@ void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index) {
         for (int i = 0; i < 24; i++) {
             IS31FL3733_write_register(addr, i, g_led_control_registers[index][i]);
         }
+        // Refresh them again on the next update if a queued transaction failed in the meantime.
+        g_led_control_registers_update_required[index] = i2c_async_flush(ISSI_TIMEOUT) != 0;
     }
-    g_led_control_registers_update_required[index] = false;
 }
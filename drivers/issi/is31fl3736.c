@@ -103,7 +103,7 @@ void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
             if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
         }
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+        i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
 #endif
     }
 }
@@ -251,8 +251,9 @@ void IS31FL3736_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
 
         IS31FL3736_write_pwm_buffer(addr1, g_pwm_buffer[0]);
         // IS31FL3736_write_pwm_buffer(addr2, g_pwm_buffer[1]);
+        // the queued transfers only report their errors now, send the buffer again then
+        g_pwm_buffer_update_required = i2c_async_flush(ISSI_TIMEOUT) != 0;
     }
-    g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3736_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
@@ -65,8 +65,9 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3737_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required = false;
+uint8_t  g_pwm_buffer[DRIVER_COUNT][192];
+// Bit n is set when the registers of the n-th 16 byte transfer changed since they were last sent.
+uint16_t g_pwm_buffer_update_required = 0;
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}};
 bool    g_led_control_registers_update_required   = false;
@@ -84,14 +85,18 @@ void IS31FL3737_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static uint16_t IS31FL3737_write_pwm_blocks(uint8_t addr, uint8_t *pwm_buffer, uint16_t blocks) {
     // assumes PG1 is already selected
+    // returns the blocks that could not be sent
 
-    // transmit PWM registers in 12 transfers of 16 bytes
+    // transmit the PWM registers of the requested blocks in transfers of 16 bytes
     // g_twi_transfer_buffer[] is 20 bytes
 
     // iterate over the pwm_buffer contents at 16 byte intervals
     for (int i = 0; i < 192; i += 16) {
+        uint16_t block = 1 << (i / 16);
+        if (!(blocks & block)) continue;
+
         g_twi_transfer_buffer[0] = i;
         // copy the data from i to i+15
         // device will auto-increment register for data after the first byte
@@ -102,14 +107,22 @@ void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
 
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) {
+                blocks &= ~block;
+                break;
+            }
         }
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+        if (i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) {
+            blocks &= ~block;
+        }
 #endif
     }
+    return blocks;
 }
 
+void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) { IS31FL3737_write_pwm_blocks(addr, pwm_buffer, 0xFFF); }
+
 void IS31FL3737_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -151,14 +164,21 @@ void IS31FL3737_init(uint8_t addr) {
     wait_ms(10);
 }
 
+// Only marks the transfer of the register to be sent if its value changes.
+static inline void IS31FL3737_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_update_required |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3737_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3737_set_pwm(led.driver, led.r, red);
+        IS31FL3737_set_pwm(led.driver, led.g, green);
+        IS31FL3737_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -203,10 +223,15 @@ void IS31FL3737_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
         IS31FL3737_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3737_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3737_write_pwm_buffer(addr1, g_pwm_buffer[0]);
+        uint16_t blocks = g_pwm_buffer_update_required;
+        // the blocks that failed are sent again on the next update
+        g_pwm_buffer_update_required = IS31FL3737_write_pwm_blocks(addr1, g_pwm_buffer[0], blocks);
         // IS31FL3737_write_pwm_buffer(addr2, g_pwm_buffer[1]);
+        // the queued transfers only report their errors now, send all of them again then
+        if (i2c_async_flush(ISSI_TIMEOUT) != 0) {
+            g_pwm_buffer_update_required = blocks;
+        }
     }
-    g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3737_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
@@ -62,6 +62,8 @@
 #endif
 
 #define ISSI_MAX_LEDS 351
+// one bit for each transfer of IS31FL3741_write_pwm_blocks()
+#define ISSI_PWM_BLOCKS_ALL 0xFFFFF
 
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20] = {0xFF};
@@ -72,9 +74,10 @@ uint8_t g_twi_transfer_buffer[20] = {0xFF};
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3741_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required                      = false;
-bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
+uint8_t  g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
+// Bit n is set when the registers of the n-th 18 byte transfer changed since they were last sent.
+uint32_t g_pwm_buffer_update_required                     = 0;
+bool     g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
@@ -91,53 +94,47 @@ void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // unlock the command register and select PG2
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM0);
+// Returns the blocks that were not sent, it stops at the first transaction that fails.
+static uint32_t IS31FL3741_write_pwm_blocks(uint8_t addr, uint8_t *pwm_buffer, uint32_t blocks) {
+    uint8_t page = 0xFF;  // none selected yet
+
+    // transmit the PWM registers of the requested blocks in transfers of 18 bytes, the last one has the 9 left
+    // cause the total number is 351, PG0 has the first 180 and PG1 the rest
+    for (int i = 0; i < ISSI_MAX_LEDS; i += 18) {
+        uint32_t block = (uint32_t)1 << (i / 18);
+        if (!(blocks & block)) continue;
 
-    for (int i = 0; i < 342; i += 18) {
-        if (i == 180) {
-            // unlock the command register and select PG2
+        uint8_t block_page = i < 180 ? ISSI_PAGE_PWM0 : ISSI_PAGE_PWM1;
+        if (page != block_page) {
+            page = block_page;
+            // unlock the command register and select PG0 or PG1
             IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM1);
+            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, page);
         }
 
+        uint8_t length           = ISSI_MAX_LEDS - i < 18 ? ISSI_MAX_LEDS - i : 18;
         g_twi_transfer_buffer[0] = i % 180;
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 18);
+        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, length);
 
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-                return false;
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+                return blocks;
             }
         }
 #else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-            return false;
+        if (i2c_transmit_async(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+            return blocks;
         }
 #endif
+        blocks &= ~block;
     }
 
-    // transfer the left cause the total number is 351
-    g_twi_transfer_buffer[0] = 162;
-    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + 342, 9);
-
-#if ISSI_PERSISTENCE > 0
-    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
-            return false;
-        }
-    }
-#else
-    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
-        return false;
-    }
-#endif
-
-    return true;
+    return blocks;
 }
 
+bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) { return IS31FL3741_write_pwm_blocks(addr, pwm_buffer, ISSI_PWM_BLOCKS_ALL) == 0; }
+
 void IS31FL3741_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -161,18 +158,28 @@ void IS31FL3741_init(uint8_t addr) {
 
     // IS31FL3741_update_led_scaling_registers(addr, 0xFF, 0xFF, 0xFF);
 
+    // The PWM registers are not cleared, send all of them on the next update.
+    g_pwm_buffer_update_required = ISSI_PWM_BLOCKS_ALL;
+
     // Wait 10ms to ensure the device has woken up.
     wait_ms(10);
 }
 
+// Only marks the transfer of the register to be sent if its value changes.
+static inline void IS31FL3741_set_pwm(uint8_t driver, uint16_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_update_required |= (uint32_t)1 << (reg / 18);
+    }
+}
+
 void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3741_set_pwm(led.driver, led.r, red);
+        IS31FL3741_set_pwm(led.driver, led.g, green);
+        IS31FL3741_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -208,18 +215,20 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 
 void IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
     if (g_pwm_buffer_update_required) {
-        IS31FL3741_write_pwm_buffer(addr1, g_pwm_buffer[0]);
+        uint32_t blocks = g_pwm_buffer_update_required;
+        // the blocks that were not sent are sent on the next update
+        g_pwm_buffer_update_required = IS31FL3741_write_pwm_blocks(addr1, g_pwm_buffer[0], blocks);
+        // the queued transfers only report their errors now, send all of them again then
+        if (i2c_async_flush(ISSI_TIMEOUT) != 0) {
+            g_pwm_buffer_update_required = blocks;
+        }
     }
-
-    g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
-    g_pwm_buffer[pled->driver][pled->r] = red;
-    g_pwm_buffer[pled->driver][pled->g] = green;
-    g_pwm_buffer[pled->driver][pled->b] = blue;
-
-    g_pwm_buffer_update_required = true;
+    IS31FL3741_set_pwm(pled->driver, pled->r, red);
+    IS31FL3741_set_pwm(pled->driver, pled->g, green);
+    IS31FL3741_set_pwm(pled->driver, pled->b, blue);
 }
 
 void IS31FL3741_update_led_control_registers(uint8_t addr, uint8_t index) {
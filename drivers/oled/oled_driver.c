@@ -94,6 +94,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif  // defined(__AVR__)
 #define I2C_TRANSMIT(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
 #define I2C_WRITE_REG(mode, data, size) i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
+// rendering doesn't wait for the transfers when I2C_ASYNC_BUFFER_SIZE is set, the data is copied
+#define I2C_TRANSMIT_ASYNC(data) i2c_transmit_async((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
+#define I2C_WRITE_REG_ASYNC(mode, data, size) i2c_writeReg_async((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
 
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
@@ -104,6 +107,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 uint8_t         oled_buffer[OLED_MATRIX_SIZE];
 uint8_t *       oled_cursor;
 OLED_BLOCK_TYPE oled_dirty          = 0;
+OLED_BLOCK_TYPE oled_queued_block   = 0;  // the block sent by the last render, its transfers may still be queued
 bool            oled_initialized    = false;
 bool            oled_active         = false;
 bool            oled_scrolling      = false;
@@ -122,6 +126,10 @@ uint32_t oled_scroll_timeout;
 #if OLED_UPDATE_INTERVAL > 0
 uint16_t oled_update_timeout;
 #endif
+#if OLED_LAYER_COUNT > 0
+static const uint8_t *oled_background = NULL;
+static bool           oled_background_dirty;
+#endif
 
 // Internal variables to reduce math instructions
 
@@ -211,6 +219,10 @@ bool oled_init(uint8_t rotation) {
 #endif
 
     oled_clear();
+#if OLED_LAYER_COUNT > 0
+    // layers set before the rotation was known are drawn now
+    oled_background_dirty = true;
+#endif
     oled_initialized = true;
     oled_active      = true;
     oled_scrolling   = false;
@@ -275,6 +287,12 @@ void oled_render(void) {
         return;
     }
 
+    // The block sent by the last render is only known to have made it now, send it again if it didn't
+    if (i2c_async_flush(OLED_I2C_TIMEOUT) != I2C_STATUS_SUCCESS) {
+        oled_dirty |= oled_queued_block;
+    }
+    oled_queued_block = 0;
+
     // Do we have work to do?
     oled_dirty &= OLED_ALL_BLOCKS_MASK;
     if (!oled_dirty || oled_scrolling) {
@@ -296,14 +314,14 @@ void oled_render(void) {
     }
 
     // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
+    if (I2C_TRANSMIT_ASYNC(display_start) != I2C_STATUS_SUCCESS) {
         print("oled_render offset command failed\n");
         return;
     }
 
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
         // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        if (I2C_WRITE_REG_ASYNC(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render data failed\n");
             return;
         }
@@ -319,7 +337,7 @@ void oled_render(void) {
         }
 
         // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        if (I2C_WRITE_REG_ASYNC(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render90 data failed\n");
             return;
         }
@@ -330,6 +348,7 @@ void oled_render(void) {
 
     // Clear dirty flag
     oled_dirty &= ~((OLED_BLOCK_TYPE)1 << update_start);
+    oled_queued_block = (OLED_BLOCK_TYPE)1 << update_start;
 }
 
 void oled_set_cursor(uint8_t col, uint8_t line) {
@@ -484,6 +503,45 @@ void oled_write_raw(const char *data, uint16_t size) {
     }
 }
 
+const char *oled_write_rle_P(const char *data) {
+    uint16_t index = 0;
+    while (index < OLED_MATRIX_SIZE) {
+        uint8_t  op    = pgm_read_byte(data++);
+        uint16_t count = (op & OLED_RLE_COUNT_MASK) + 1;
+        if ((op & OLED_RLE_OP_MASK) == OLED_RLE_SKIP_LONG) {
+            count *= 64;
+        }
+        if (count > OLED_MATRIX_SIZE - index) {
+            count = OLED_MATRIX_SIZE - index;
+        }
+
+        switch (op & OLED_RLE_OP_MASK) {
+            case OLED_RLE_REPEAT: {
+                uint8_t c = pgm_read_byte(data++);
+                for (uint16_t i = index; i < index + count; i++) {
+                    if (oled_buffer[i] == c) continue;
+                    oled_buffer[i] = c;
+                    oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
+                }
+                break;
+            }
+            case OLED_RLE_LITERAL:
+                for (uint16_t i = index; i < index + count; i++) {
+                    uint8_t c = pgm_read_byte(data++);
+                    if (oled_buffer[i] == c) continue;
+                    oled_buffer[i] = c;
+                    oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
+                }
+                break;
+            default:
+                // skipped bytes are left as they are
+                break;
+        }
+        index += count;
+    }
+    return data;
+}
+
 void oled_write_pixel(uint8_t x, uint8_t y, bool on) {
     if (x >= oled_rotation_width) {
         return;
@@ -530,6 +588,227 @@ void oled_write_raw_P(const char *data, uint16_t size) {
 }
 #endif  // defined(__AVR__)
 
+#if OLED_LAYER_COUNT > 0
+// A rectangle of the buffer, in columns and pages, ending before x1 and p1
+typedef struct {
+    uint8_t x0, x1, p0, p1;
+} oled_rect_t;
+
+typedef struct {
+    const uint8_t *data;
+    uint8_t        x, y, width, height;
+    uint8_t        flags;
+    bool           visible;
+    oled_rect_t    dirty;
+} oled_layer_t;
+
+static oled_layer_t oled_layers[OLED_LAYER_COUNT];
+
+static uint8_t oled_buffer_pages(void) { return OLED_MATRIX_SIZE / oled_rotation_width; }
+
+// Adds the pixels x, y to x + width, y + height to the dirty rectangle of a layer
+static void oled_layer_dirty(oled_layer_t *layer, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    if (!width || !height || !oled_rotation_width) {
+        return;
+    }
+    uint8_t x1 = x + width > oled_rotation_width ? oled_rotation_width : x + width;
+    uint8_t p0 = y / 8;
+    uint8_t p1 = (y + height + 7) / 8 > oled_buffer_pages() ? oled_buffer_pages() : (y + height + 7) / 8;
+    if (x >= x1 || p0 >= p1) {
+        return;
+    }
+
+    oled_rect_t *dirty = &layer->dirty;
+    if (dirty->x0 >= dirty->x1) {
+        *dirty = (oled_rect_t){x, x1, p0, p1};
+        return;
+    }
+    if (x < dirty->x0) dirty->x0 = x;
+    if (x1 > dirty->x1) dirty->x1 = x1;
+    if (p0 < dirty->p0) dirty->p0 = p0;
+    if (p1 > dirty->p1) dirty->p1 = p1;
+}
+
+static void oled_layer_dirty_all(oled_layer_t *layer) {
+    if (layer->visible) {
+        oled_layer_dirty(layer, layer->x, layer->y, layer->width, layer->height);
+    }
+}
+
+static uint8_t oled_layer_read(const oled_layer_t *layer, uint8_t page, uint8_t column) {
+    if (page >= (layer->height + 7) / 8) {
+        return 0;
+    }
+    const uint8_t *data = &layer->data[page * layer->width + column];
+    return (layer->flags & OLED_LAYER_PROGMEM) ? pgm_read_byte(data) : *data;
+}
+
+// Draws the 8 pixels of a layer that fall on the buffer byte at page and column over value
+static uint8_t oled_layer_draw(const oled_layer_t *layer, uint8_t page, uint8_t column, uint8_t value) {
+    if (column < layer->x || column >= layer->x + layer->width) {
+        return value;
+    }
+    // layer row drawn on the first bit of this byte
+    int16_t top = page * 8 - layer->y;
+    if (top <= -8 || top >= layer->height) {
+        return value;
+    }
+
+    uint8_t column_in_layer = column - layer->x;
+    uint8_t bits;
+    if (top >= 0) {
+        uint8_t shift = top % 8;
+        bits          = oled_layer_read(layer, top / 8, column_in_layer) >> shift;
+        if (shift) {
+            bits |= oled_layer_read(layer, top / 8 + 1, column_in_layer) << (8 - shift);
+        }
+    } else {
+        bits = oled_layer_read(layer, 0, column_in_layer) << -top;
+    }
+
+    // keep the rows that are inside the layer
+    uint8_t first = top < 0 ? -top : 0;
+    uint8_t last  = layer->height - top < 8 ? layer->height - top : 8;
+    uint8_t mask  = (uint8_t)(((uint16_t)1 << last) - 1) & (uint8_t)~((1 << first) - 1);
+
+    if (layer->flags & OLED_LAYER_OPAQUE) {
+        return (value & ~mask) | (bits & mask);
+    }
+    return value | (bits & mask);
+}
+
+static void oled_composite_rect(const oled_rect_t *rect) {
+    for (uint8_t page = rect->p0; page < rect->p1; page++) {
+        for (uint8_t column = rect->x0; column < rect->x1; column++) {
+            uint16_t index = page * oled_rotation_width + column;
+            uint8_t  value = oled_background ? pgm_read_byte(&oled_background[index]) : 0;
+            for (uint8_t i = 0; i < OLED_LAYER_COUNT; i++) {
+                if (oled_layers[i].visible) {
+                    value = oled_layer_draw(&oled_layers[i], page, column, value);
+                }
+            }
+            if (oled_buffer[index] != value) {
+                oled_buffer[index] = value;
+                oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
+            }
+        }
+    }
+}
+
+void oled_set_background_P(const char *data) {
+    oled_background       = (const uint8_t *)data;
+    oled_background_dirty = true;
+}
+
+void oled_layer_set(uint8_t layer, const char *data, uint8_t width, uint8_t height, uint8_t flags) {
+    if (layer >= OLED_LAYER_COUNT) {
+        return;
+    }
+    oled_layer_t *l = &oled_layers[layer];
+    oled_layer_dirty_all(l);
+    l->data    = (const uint8_t *)data;
+    l->width   = width;
+    l->height  = height;
+    l->flags   = flags;
+    l->visible = true;
+    oled_layer_dirty_all(l);
+}
+
+void oled_layer_set_data(uint8_t layer, const char *data) {
+    if (layer >= OLED_LAYER_COUNT || oled_layers[layer].data == (const uint8_t *)data) {
+        return;
+    }
+    oled_layers[layer].data = (const uint8_t *)data;
+    oled_layer_dirty_all(&oled_layers[layer]);
+}
+
+void oled_layer_move(uint8_t layer, uint8_t x, uint8_t y) {
+    if (layer >= OLED_LAYER_COUNT) {
+        return;
+    }
+    oled_layer_t *l = &oled_layers[layer];
+    if (l->x == x && l->y == y) {
+        return;
+    }
+    oled_layer_dirty_all(l);
+    l->x = x;
+    l->y = y;
+    oled_layer_dirty_all(l);
+}
+
+void oled_layer_show(uint8_t layer, bool visible) {
+    if (layer >= OLED_LAYER_COUNT || oled_layers[layer].visible == visible) {
+        return;
+    }
+    oled_layer_t *l = &oled_layers[layer];
+    l->visible      = true;
+    oled_layer_dirty_all(l);
+    l->visible = visible;
+}
+
+void oled_layer_write(uint8_t layer, uint8_t col, uint8_t line, const char *data, bool invert) {
+    if (layer >= OLED_LAYER_COUNT) {
+        return;
+    }
+    oled_layer_t *l = &oled_layers[layer];
+    if (!l->data || (l->flags & OLED_LAYER_PROGMEM) || line >= (l->height + 7) / 8) {
+        return;
+    }
+
+    uint8_t *cursor = (uint8_t *)&l->data[line * l->width];
+    uint8_t  x      = col * OLED_FONT_WIDTH;
+    uint8_t  first  = l->width;
+    uint8_t  last   = 0;
+    for (; *data && x + OLED_FONT_WIDTH <= l->width; data++, x += OLED_FONT_WIDTH) {
+        uint8_t glyph[OLED_FONT_WIDTH];
+        uint8_t cast_data = (uint8_t)*data;  // font based on unsigned type for index
+        if (cast_data < OLED_FONT_START || cast_data > OLED_FONT_END) {
+            memset(glyph, 0x00, OLED_FONT_WIDTH);
+        } else {
+            memcpy_P(glyph, &font[(cast_data - OLED_FONT_START) * OLED_FONT_WIDTH], OLED_FONT_WIDTH);
+        }
+        if (invert) {
+            InvertCharacter(glyph);
+        }
+        if (memcmp(&cursor[x], glyph, OLED_FONT_WIDTH)) {
+            memcpy(&cursor[x], glyph, OLED_FONT_WIDTH);
+            if (x < first) first = x;
+            last = x + OLED_FONT_WIDTH;
+        }
+    }
+
+    if (l->visible && first < last) {
+        oled_layer_dirty(l, l->x + first, l->y + line * 8, last - first, 8);
+    }
+}
+
+void oled_layer_invalidate(uint8_t layer) {
+    if (layer < OLED_LAYER_COUNT) {
+        oled_layer_dirty_all(&oled_layers[layer]);
+    }
+}
+
+void oled_composite(void) {
+    if (oled_background_dirty) {
+        oled_background_dirty = false;
+        oled_composite_rect(&(oled_rect_t){0, oled_rotation_width, 0, oled_buffer_pages()});
+        for (uint8_t i = 0; i < OLED_LAYER_COUNT; i++) {
+            oled_layers[i].dirty.x1 = 0;
+        }
+        return;
+    }
+
+    // each layer redraws its own rectangle, so that far apart changes don't redraw everything between them
+    for (uint8_t i = 0; i < OLED_LAYER_COUNT; i++) {
+        oled_rect_t *dirty = &oled_layers[i].dirty;
+        if (dirty->x0 < dirty->x1) {
+            oled_composite_rect(dirty);
+            dirty->x1 = 0;
+        }
+    }
+}
+#endif
+
 bool oled_on(void) {
     if (!oled_initialized) {
         return oled_active;
@@ -694,6 +973,10 @@ void oled_task(void) {
     oled_task_user();
 #endif
 
+#if OLED_LAYER_COUNT > 0
+    oled_composite();
+#endif
+
 #if OLED_SCROLL_TIMEOUT > 0
     if (oled_dirty && oled_scrolling) {
         oled_scroll_timeout = timer_read32() + OLED_SCROLL_TIMEOUT;
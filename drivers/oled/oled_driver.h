@@ -158,11 +158,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define OLED_I2C_TIMEOUT 100
 #endif
 
+// Number of layers the compositor draws over the background, 0 disables it
+#if !defined(OLED_LAYER_COUNT)
+#    define OLED_LAYER_COUNT 0
+#endif
+
 typedef struct __attribute__((__packed__)) {
     uint8_t *current_element;
     uint16_t remaining_element_count;
 } oled_buffer_reader_t;
 
+// OLED layer flags
+enum {
+    OLED_LAYER_PROGMEM = 1,  // the layer data is in PROGMEM
+    OLED_LAYER_OPAQUE  = 2,  // the layer hides what is below its rectangle, instead of being or'ed over it
+};
+
+// Ops of the run-length encoded images written by oled_write_rle_P, n is the count in the low 6 bits
+#define OLED_RLE_OP_MASK 0xC0
+#define OLED_RLE_COUNT_MASK 0x3F
+#define OLED_RLE_SKIP 0x00       // the next n + 1 bytes are unchanged
+#define OLED_RLE_REPEAT 0x40     // the following byte is written n + 1 times
+#define OLED_RLE_LITERAL 0x80    // the following n + 1 bytes are written as is
+#define OLED_RLE_SKIP_LONG 0xC0  // the next (n + 1) * 64 bytes are unchanged
+
 // OLED Rotation enum values are flags
 typedef enum {
     OLED_ROTATION_0   = 0,
@@ -223,6 +242,11 @@ oled_buffer_reader_t oled_read_raw(uint16_t start_index);
 void oled_write_raw(const char *data, uint16_t size);
 void oled_write_raw_byte(const char data, uint16_t index);
 
+// Decodes a run-length encoded PROGMEM image made by `qmk img2oled` into the buffer, starting at index 0
+// Unchanged bytes are skipped, so only the blocks that differ are rendered
+// Returns a pointer past the image, where the next frame of an animation starts
+const char *oled_write_rle_P(const char *data);
+
 // Sets a specific pixel on or off
 // Coordinates start at top-left and go right and down for positive x and y
 void oled_write_pixel(uint8_t x, uint8_t y, bool on);
@@ -308,3 +332,33 @@ uint8_t oled_max_chars(void);
 
 // Returns the maximum number of lines that will fit on the oled
 uint8_t oled_max_lines(void);
+
+#if OLED_LAYER_COUNT > 0
+// Sets the PROGMEM image the layers are drawn over, OLED_MATRIX_SIZE bytes in the buffer layout, NULL to clear it
+// Redraws the whole display on the next composite
+void oled_set_background_P(const char *data);
+
+// Sets the data, size and flags of a layer, and shows it
+// Data is (height + 7) / 8 pages of width bytes each, in the buffer layout, with the first page on top
+void oled_layer_set(uint8_t layer, const char *data, uint8_t width, uint8_t height, uint8_t flags);
+
+// Swaps the data of a layer for another one of the same size, such as the next frame of a sprite
+void oled_layer_set_data(uint8_t layer, const char *data);
+
+// Moves the top-left corner of a layer to the pixel at x and y
+void oled_layer_move(uint8_t layer, uint8_t x, uint8_t y);
+
+// Shows or hides a layer
+void oled_layer_show(uint8_t layer, bool visible);
+
+// Writes a string into the data of a layer in RAM, at the character position indicated by column and line
+// Inverts the pixels if true, only the changed columns are redrawn
+void oled_layer_write(uint8_t layer, uint8_t col, uint8_t line, const char *data, bool invert);
+
+// Redraws the whole rectangle of a layer on the next composite, after its RAM data was changed directly
+void oled_layer_invalidate(uint8_t layer);
+
+// Draws the changed parts of the background and layers into the buffer, and marks the changed blocks dirty
+// Called by oled_task after oled_task_user
+void oled_composite(void);
+#endif
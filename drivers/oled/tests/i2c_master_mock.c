@@ -0,0 +1,31 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "i2c_master.h"
+
+// A display that acknowledges everything, the tests only look at the buffer
+
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout) { return I2C_STATUS_SUCCESS; }
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout) { return I2C_STATUS_SUCCESS; }
+
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout) { return I2C_STATUS_SUCCESS; }
+
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout) { return I2C_STATUS_SUCCESS; }
+
+i2c_status_t i2c_async_flush(uint16_t timeout) { return I2C_STATUS_SUCCESS; }
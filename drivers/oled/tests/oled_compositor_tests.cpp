@@ -0,0 +1,224 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "oled_driver.h"
+
+extern uint8_t         oled_buffer[OLED_MATRIX_SIZE];
+extern OLED_BLOCK_TYPE oled_dirty;
+extern uint8_t         oled_rotation_width;
+}
+
+#define MAX_LAYER_SIZE 64
+#define LAYER_DATA_SIZE (MAX_LAYER_SIZE * MAX_LAYER_SIZE / 8)
+
+// What the test set on each layer, to draw them again pixel by pixel
+typedef struct {
+    const uint8_t *data;
+    uint8_t        x, y, width, height, flags;
+    bool           visible;
+} layer_state_t;
+
+class OledCompositorTest : public ::testing::Test {
+   protected:
+    void init(oled_rotation_t rotation) {
+        ASSERT_TRUE(oled_init(rotation));
+        pixel_height = OLED_MATRIX_SIZE / oled_rotation_width * 8;
+
+        for (auto &layer_data : data) {
+            for (auto &frame : layer_data) {
+                for (auto &value : frame) {
+                    value = rand();
+                }
+            }
+        }
+        for (auto &value : background) {
+            value = rand();
+        }
+        background_set = false;
+        oled_set_background_P(NULL);
+
+        for (uint8_t i = 0; i < OLED_LAYER_COUNT; i++) {
+            layers[i] = {data[i][0], 0, 0, 1, 1, 0, false};
+            oled_layer_set(i, (const char *)data[i][0], 1, 1, 0);
+            oled_layer_move(i, 0, 0);
+            oled_layer_show(i, false);
+        }
+    }
+
+    // A random change through the layer API, like oled_task_user() would do
+    void random_change() {
+        uint8_t        i     = rand() % OLED_LAYER_COUNT;
+        layer_state_t *layer = &layers[i];
+        switch (rand() % 8) {
+            case 0:
+                background_set = rand() % 4;
+                for (uint16_t j = 0; j < 32; j++) {
+                    background[rand() % OLED_MATRIX_SIZE] = rand();
+                }
+                oled_set_background_P(background_set ? (const char *)background : NULL);
+                break;
+            case 1:
+                layer->data    = data[i][rand() % 2];
+                layer->width   = 1 + rand() % MAX_LAYER_SIZE;
+                layer->height  = 1 + rand() % MAX_LAYER_SIZE;
+                layer->flags   = rand() % 4;
+                layer->visible = true;
+                oled_layer_set(i, (const char *)layer->data, layer->width, layer->height, layer->flags);
+                break;
+            case 2:
+                layer->data = data[i][layer->data == data[i][0]];
+                oled_layer_set_data(i, (const char *)layer->data);
+                break;
+            case 3:
+            case 4:
+                // mostly small steps, like a sprite walking, sometimes anywhere including past the edges
+                if (rand() % 4) {
+                    layer->x = (layer->x + oled_rotation_width + rand() % 5 - 2) % oled_rotation_width;
+                    layer->y = (layer->y + pixel_height + rand() % 5 - 2) % pixel_height;
+                } else {
+                    layer->x = rand() % oled_rotation_width;
+                    layer->y = rand() % pixel_height;
+                }
+                oled_layer_move(i, layer->x, layer->y);
+                break;
+            case 5:
+                layer->visible = rand() % 2;
+                oled_layer_show(i, layer->visible);
+                break;
+            case 6: {
+                // ignored for layers in PROGMEM
+                char text[5] = {};
+                for (uint8_t j = 0; j < 4; j++) {
+                    text[j] = ' ' + rand() % 95;
+                }
+                oled_layer_write(i, rand() % 4, rand() % 8, text, rand() % 2);
+                break;
+            }
+            default: {
+                // the RAM data is changed directly
+                uint8_t *frame = (uint8_t *)layer->data;
+                for (uint8_t j = 0; j < 8; j++) {
+                    frame[rand() % LAYER_DATA_SIZE] = rand();
+                }
+                oled_layer_invalidate(i);
+                break;
+            }
+        }
+    }
+
+    // Composites, then checks the blocks marked dirty and the buffer against the direct-write reference
+    void composite_and_check(const char *when) {
+        uint8_t before[OLED_MATRIX_SIZE];
+        memcpy(before, oled_buffer, sizeof(before));
+        oled_dirty = 0;
+        oled_composite();
+
+        for (uint8_t block = 0; block < OLED_BLOCK_COUNT; block++) {
+            bool changed = memcmp(&before[block * OLED_BLOCK_SIZE], &oled_buffer[block * OLED_BLOCK_SIZE], OLED_BLOCK_SIZE) != 0;
+            bool dirty   = oled_dirty & ((OLED_BLOCK_TYPE)1 << block);
+            ASSERT_EQ(dirty, changed) << "block " << (int)block << " " << when;
+        }
+
+        uint8_t composited[OLED_MATRIX_SIZE];
+        memcpy(composited, oled_buffer, sizeof(composited));
+        draw_reference();
+        for (uint16_t i = 0; i < OLED_MATRIX_SIZE; i++) {
+            ASSERT_EQ(composited[i], oled_buffer[i]) << "column " << i % oled_rotation_width << ", page " << i / oled_rotation_width << " " << when;
+        }
+        memcpy(oled_buffer, composited, sizeof(composited));
+        oled_dirty = 0;
+    }
+
+    // Draws the whole screen into the buffer with oled_write_pixel(), one pixel of each layer at a time
+    void draw_reference() {
+        if (background_set) {
+            memcpy(oled_buffer, background, sizeof(background));
+        } else {
+            memset(oled_buffer, 0, sizeof(background));
+        }
+
+        for (auto &layer : layers) {
+            if (!layer.visible) {
+                continue;
+            }
+            for (uint8_t y = 0; y < layer.height; y++) {
+                for (uint8_t x = 0; x < layer.width; x++) {
+                    bool on = layer.data[(y / 8) * layer.width + x] & (1 << (y % 8));
+                    if (on || (layer.flags & OLED_LAYER_OPAQUE)) {
+                        oled_write_pixel(layer.x + x, layer.y + y, on);
+                    }
+                }
+            }
+        }
+    }
+
+    uint8_t       data[OLED_LAYER_COUNT][2][LAYER_DATA_SIZE];
+    uint8_t       background[OLED_MATRIX_SIZE];
+    bool          background_set;
+    layer_state_t layers[OLED_LAYER_COUNT];
+    uint8_t       pixel_height;
+};
+
+TEST_F(OledCompositorTest, MatchesDrawingEveryPixel) {
+    static const oled_rotation_t rotations[] = {OLED_ROTATION_0, OLED_ROTATION_90, OLED_ROTATION_180, OLED_ROTATION_270};
+
+    srand(1);
+    for (auto rotation : rotations) {
+        init(rotation);
+        composite_and_check("after oled_init");
+
+        for (int step = 0; step < 3000; step++) {
+            // several changes per frame, or none
+            for (int changes = rand() % 4; changes > 0; changes--) {
+                random_change();
+            }
+            std::string when = "at step " + std::to_string(step) + ", rotation " + std::to_string(rotation);
+            composite_and_check(when.c_str());
+            if (HasFatalFailure()) {
+                return;
+            }
+        }
+    }
+}
+
+TEST_F(OledCompositorTest, UnchangedFramesSendNothing) {
+    srand(2);
+    init(OLED_ROTATION_0);
+    for (int step = 0; step < 100; step++) {
+        random_change();
+    }
+    oled_composite();
+
+    oled_dirty = 0;
+    oled_composite();
+    EXPECT_EQ(oled_dirty, 0);
+
+    // moving a layer back and forth within a frame redraws its rectangle, but nothing changes
+    oled_layer_set(0, (const char *)data[0][0], 16, 16, OLED_LAYER_OPAQUE);
+    oled_layer_move(0, 8, 8);
+    oled_composite();
+    oled_dirty = 0;
+    oled_layer_move(0, 9, 8);
+    oled_layer_move(0, 8, 8);
+    oled_composite();
+    EXPECT_EQ(oled_dirty, 0);
+}
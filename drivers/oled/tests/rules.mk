@@ -0,0 +1,17 @@
+# The layer compositor against a per-pixel reference drawn with oled_write_pixel(), see oled_compositor_tests.cpp
+
+oled_compositor_DEFS := -DNO_DEBUG -DNO_PRINT -DOLED_LAYER_COUNT=3
+
+oled_compositor_SRC := \
+	$(DRIVER_PATH)/oled/tests/oled_compositor_tests.cpp \
+	$(DRIVER_PATH)/oled/tests/i2c_master_mock.c \
+	$(DRIVER_PATH)/oled/oled_driver.c \
+	$(TMK_PATH)/common/test/timer.c
+
+oled_compositor_INC := $(DRIVER_PATH)/oled $(DRIVER_PATH)/avr
+
+# The same on a 128x64 display
+
+oled_compositor_128x64_DEFS := $(oled_compositor_DEFS) -DOLED_DISPLAY_128X64
+oled_compositor_128x64_SRC := $(oled_compositor_SRC)
+oled_compositor_128x64_INC := $(oled_compositor_INC)
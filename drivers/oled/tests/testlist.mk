@@ -0,0 +1 @@
+TEST_LIST += oled_compositor oled_compositor_128x64
@@ -0,0 +1,15 @@
+#include QMK_KEYBOARD_H
+
+#ifdef RGB_MATRIX_ENABLE
+// Must match the rgb_matrix layout of info.json
+led_config_t g_led_config = { {
+    // Key Matrix to LED Index
+    { 0 }
+}, {
+    // LED Index to Physical Position
+    { 0, 0 }, { 224, 64 }
+}, {
+    // LED Index to Flag
+    4, 2
+} };
+#endif
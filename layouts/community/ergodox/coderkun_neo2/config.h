@@ -0,0 +1,4 @@
+#pragma once
+
+// Start Unicode input with NEO_U instead of KC_U
+#define UNICODE_KEY_LNX LCTL(LSFT(KC_A))
@@ -258,14 +258,3 @@ void matrix_scan_user(void)
     }
 
 };
-
-
-// Override Unicode start method to use NEO_U instead of KC_U
-void unicode_input_start (void) {
-    register_code(KC_LCTL);
-    register_code(KC_LSFT);
-    register_code(NEO_U);
-    unregister_code(NEO_U);
-    unregister_code(KC_LSFT);
-    unregister_code(KC_LCTL);
-};
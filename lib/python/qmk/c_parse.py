@@ -10,6 +10,7 @@ from qmk.comment_remover import comment_remover
 default_key_entry = {'x': -1, 'y': 0, 'w': 1}
 single_comment_regex = re.compile(r' */[/*].*$')
 multi_comment_regex = re.compile(r'/\*(.|\n)*?\*/', re.MULTILINE)
+led_config_regex = re.compile(r'\bg_led_config\s*=\s*{')
 
 
 def strip_line_comment(string):
@@ -132,6 +133,54 @@ def parse_config_h_file(config_h_file, config_h=None):
     return config_h
 
 
+def find_led_config_points(file):
+    """Returns the LED positions of the g_led_config defined in a C file, or None if it doesn't define one.
+
+    Only an initializer of integer literals can be read, ValueError is raised for anything else.
+    """
+    file = Path(file)
+    file_contents = comment_remover(file.read_text(encoding='utf-8', errors='replace'))
+    match = led_config_regex.search(file_contents)
+
+    if not match:
+        return None
+
+    # Split the initializer into nested lists of tokens
+    stack = [[]]
+    for token in re.findall(r'[{},]|[^{},\s]+', file_contents[match.end() - 1:]):
+        if token == '{':
+            stack.append([])
+        elif token == '}':
+            value = stack.pop()
+            stack[-1].append(value)
+            if len(stack) == 1:
+                break
+        elif token.startswith('#'):
+            raise ValueError('%s: g_led_config has preprocessor directives in it' % (file,))
+        elif token != ',':
+            stack[-1].append(token)
+
+    led_config = stack[0][0] if stack[0] else []
+
+    # Split boards may wrap the initializer in another set of braces
+    while len(led_config) == 1 and isinstance(led_config[0], list):
+        led_config = led_config[0]
+
+    if len(led_config) != 3 or not isinstance(led_config[1], list):
+        raise ValueError('%s: Could not find the LED positions of g_led_config' % (file,))
+
+    points = []
+    for point in led_config[1]:
+        if not isinstance(point, list) or len(point) != 2:
+            raise ValueError('%s: LED %d of g_led_config is not an {x, y} pair' % (file, len(points)))
+        try:
+            points.append([int(point[0], 0), int(point[1], 0)])
+        except (TypeError, ValueError):
+            raise ValueError('%s: LED %d of g_led_config is not made of integer literals' % (file, len(points)))
+
+    return points
+
+
 def _default_key(label=None):
     """Increment x and return a copy of the default_key_entry.
     """
@@ -19,6 +19,7 @@ from . import flash
 from . import format
 from . import generate
 from . import hello
+from . import img2oled
 from . import info
 from . import json2c
 from . import lint
@@ -5,4 +5,5 @@ from . import docs
 from . import info_json
 from . import layouts
 from . import rgb_breathe_table
+from . import rgb_matrix_geometry
 from . import rules_mk
@@ -0,0 +1,179 @@
+"""Used by the make system to generate rgb_matrix_geometry.h from info.json.
+"""
+from pathlib import Path
+
+from milc import cli
+
+from qmk.c_parse import find_led_config_points
+from qmk.decorators import automagic_keyboard, automagic_keymap
+from qmk.info import info_json
+from qmk.keyboard import keyboard_folder
+from qmk.path import is_keyboard, normpath
+
+# Must match the default of RGB_MATRIX_CENTER in quantum/rgb_matrix.c
+DEFAULT_CENTER = [112, 32]
+
+
+def int8(value):
+    """Wraps value around like a C int8_t.
+    """
+    return (value + 128) % 256 - 128
+
+
+def c_div(a, b):
+    """Integer division truncating towards zero, like C does.
+    """
+    quotient = abs(a) // abs(b)
+    return quotient if (a < 0) == (b < 0) else -quotient
+
+
+def atan2_8(dy, dx):
+    """Same as atan2_8() in lib/lib8tion/trig8.h.
+    """
+    if dy == 0:
+        return 0 if dx >= 0 else 128
+
+    abs_y = abs(dy)
+
+    if dx >= 0:
+        a = int8(32 - c_div(32 * (dx - abs_y), dx + abs_y))
+    else:
+        a = int8(96 - c_div(32 * (dx + abs_y), abs_y - dx))
+
+    return (-a if dy < 0 else a) & 0xFF
+
+
+def sqrt16(x):
+    """Same as sqrt16() in lib/lib8tion/math8.h.
+    """
+    x &= 0xFFFF
+    if x <= 1:
+        return x
+
+    low = 1
+    hi = 255 if x > 7904 else (x >> 5) + 8
+
+    while True:
+        mid = (low + hi) >> 1
+        if (mid * mid) & 0xFFFF > x:
+            hi = mid - 1
+        else:
+            if mid == 255:
+                return 255
+            low = mid + 1
+
+        if hi < low:
+            return low - 1
+
+
+def led_config_points(keyboard):
+    """Returns the LED positions of the g_led_config in the C files of the keyboard, or None.
+
+    A g_led_config in a more specific folder takes precedence.
+    """
+    points = None
+    current_path = Path('keyboards/')
+
+    for directory in Path(keyboard).parts:
+        current_path = current_path / directory
+
+        for file in sorted(current_path.glob('*.c')):
+            points = find_led_config_points(file) or points
+
+    return points
+
+
+def polar_table(leds, center):
+    """Returns the lines of the angle and distance of every LED around the center.
+    """
+    lines = ['static const polar_t PROGMEM rgb_matrix_geometry_polar[] = {']
+
+    for led in leds:
+        dx = led['x'] - center[0]
+        dy = led['y'] - center[1]
+        lines.append('    {%3d, %3d},' % (atan2_8(dy, dx), sqrt16(dx * dx + dy * dy)))
+
+    lines.append('};')
+
+    return lines
+
+
+@cli.argument('-o', '--output', arg_only=True, type=normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help="Quiet mode, only output error messages")
+@cli.argument('-kb', '--keyboard', type=keyboard_folder, help='Keyboard to generate rgb_matrix_geometry.h for.')
+@cli.subcommand('Used by the make system to generate rgb_matrix_geometry.h from info.json', hidden=True)
+@automagic_keyboard
+@automagic_keymap
+def generate_rgb_matrix_geometry(cli):
+    """Generates the rgb_matrix_geometry.h file.
+    """
+    # Determine our keyboard(s)
+    if not cli.config.generate_rgb_matrix_geometry.keyboard:
+        cli.log.error('Missing parameter: --keyboard')
+        cli.subcommands['info'].print_help()
+        return False
+
+    if not is_keyboard(cli.config.generate_rgb_matrix_geometry.keyboard):
+        cli.log.error('Invalid keyboard: "%s"', cli.config.generate_rgb_matrix_geometry.keyboard)
+        return False
+
+    # Build the info.json file
+    kb_info_json = info_json(cli.config.generate_rgb_matrix_geometry.keyboard)
+    rgb_matrix = kb_info_json.get('rgb_matrix', {})
+    leds = rgb_matrix.get('layout', [])
+
+    # Build the rgb_matrix_geometry.h file. Without a LED layout it stays empty, and rgb_matrix.c computes the geometry at runtime.
+    geometry_h_lines = ['/* This file was generated by `qmk generate-rgb-matrix-geometry`. Do not edit or copy.' ' */', '', '#pragma once']
+
+    if leds:
+        # The effects read the LED positions from g_led_config, the tables must be computed from the same ones
+        try:
+            points = led_config_points(cli.config.generate_rgb_matrix_geometry.keyboard)
+        except ValueError as e:
+            cli.log.error('%s, so the rgb_matrix layout of info.json can not be checked against it.', e)
+            return False
+
+        if points is None:
+            cli.log.error('No g_led_config found for %s, the rgb_matrix layout of info.json can not be checked against it.', cli.config.generate_rgb_matrix_geometry.keyboard)
+            return False
+
+        if len(points) != len(leds):
+            cli.log.error('g_led_config has %d LEDs, but the rgb_matrix layout of info.json has %d.', len(points), len(leds))
+            return False
+
+        for i, (point, led) in enumerate(zip(points, leds)):
+            if point != [led['x'], led['y']]:
+                cli.log.error('LED %d is at %s in g_led_config, but at %s in the rgb_matrix layout of info.json.', i, point, [led['x'], led['y']])
+                return False
+
+        center = rgb_matrix.get('center', DEFAULT_CENTER)
+
+        # RGB_MATRIX_CENTER is a brace initializer, which the preprocessor can't compare to the center of the tables, so it must not be set at all
+        geometry_h_lines.append('')
+        geometry_h_lines.append('#ifdef RGB_MATRIX_CENTER')
+        geometry_h_lines.append('#    error "The rgb_matrix geometry tables are generated around rgb_matrix.center of info.json, set the center there instead of RGB_MATRIX_CENTER"')
+        geometry_h_lines.append('#endif')
+        geometry_h_lines.append('')
+        geometry_h_lines.append('#define RGB_MATRIX_GEOMETRY_TABLES')
+        geometry_h_lines.append('#define RGB_MATRIX_GEOMETRY_LED_COUNT %d' % len(leds))
+        geometry_h_lines.append('#define RGB_MATRIX_GEOMETRY_CENTER_X %d' % center[0])
+        geometry_h_lines.append('#define RGB_MATRIX_GEOMETRY_CENTER_Y %d' % center[1])
+        geometry_h_lines.append('')
+        geometry_h_lines.append('// clang-format off')
+        geometry_h_lines.append('')
+        geometry_h_lines.extend(polar_table(leds, center))
+
+    # Show the results
+    geometry_h = '\n'.join(geometry_h_lines) + '\n'
+
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.parent / (cli.args.output.name + '.bak'))
+        cli.args.output.write_text(geometry_h)
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote rgb_matrix_geometry.h to %s.', cli.args.output)
+
+    else:
+        print(geometry_h)
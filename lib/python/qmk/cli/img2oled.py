@@ -0,0 +1,172 @@
+"""Convert images to run-length encoded OLED frames.
+"""
+from milc import cli
+
+import qmk.path
+
+# Ops of the encoded frames, these match OLED_RLE_* in drivers/oled/oled_driver.h
+RLE_SKIP = 0x00
+RLE_REPEAT = 0x40
+RLE_LITERAL = 0x80
+RLE_SKIP_LONG = 0xC0
+RLE_MAX_COUNT = 64
+
+# Runs shorter than these are cheaper as literals
+MIN_SKIP = 2
+MIN_REPEAT = 3
+
+
+def image_to_buffer(image, width, height, threshold, invert):
+    """Returns the bytes of an image in the layout of oled_buffer: pages of 8 rows, one byte per column, the top row in bit 0.
+    """
+    pixels = image.convert('L').load()
+    buffer = []
+
+    for page in range(height // 8):
+        for x in range(width):
+            value = 0
+            for bit in range(8):
+                if (pixels[x, page * 8 + bit] >= threshold) != invert:
+                    value |= 1 << bit
+            buffer.append(value)
+
+    return buffer
+
+
+def run_length(values, start, equal):
+    """Returns how many values starting at `start` satisfy `equal(index)`.
+    """
+    end = start
+    while end < len(values) and equal(end):
+        end += 1
+
+    return end - start
+
+
+def encode_frame(frame, previous=None):
+    """Encodes a frame, skipping the bytes that are the same in `previous`. Without `previous` every byte is written.
+    """
+    encoded = []
+    literal = []
+
+    def flush_literal():
+        for i in range(0, len(literal), RLE_MAX_COUNT):
+            chunk = literal[i:i + RLE_MAX_COUNT]
+            encoded.append(RLE_LITERAL | (len(chunk) - 1))
+            encoded.extend(chunk)
+        literal.clear()
+
+    index = 0
+    while index < len(frame):
+        skip = run_length(frame, index, lambda i: previous[i] == frame[i]) if previous else 0
+        if skip >= MIN_SKIP:
+            flush_literal()
+            index += skip
+            while skip >= RLE_MAX_COUNT:
+                blocks = min(skip // RLE_MAX_COUNT, RLE_MAX_COUNT)
+                encoded.append(RLE_SKIP_LONG | (blocks - 1))
+                skip -= blocks * RLE_MAX_COUNT
+            if skip:
+                encoded.append(RLE_SKIP | (skip - 1))
+            continue
+
+        repeat = run_length(frame, index, lambda i: frame[i] == frame[index])
+        if repeat >= MIN_REPEAT:
+            flush_literal()
+            index += repeat
+            while repeat:
+                count = min(repeat, RLE_MAX_COUNT)
+                encoded.extend((RLE_REPEAT | (count - 1), frame[index - repeat]))
+                repeat -= count
+            continue
+
+        literal.append(frame[index])
+        index += 1
+
+    flush_literal()
+
+    return encoded
+
+
+def load_frames(filenames):
+    """Returns every frame of the given images, animated GIFs and PNGs give one frame per image frame.
+    """
+    from PIL import Image, ImageSequence
+
+    frames = []
+    for filename in filenames:
+        with Image.open(filename) as image:
+            frames.extend(frame.copy() for frame in ImageSequence.Iterator(image))
+
+    return frames
+
+
+@cli.argument('-o', '--output', arg_only=True, type=qmk.path.normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help="Quiet mode, only output error messages")
+@cli.argument('-n', '--name', arg_only=True, default='oled_image', help='Name of the C array. Default: oled_image')
+@cli.argument('-W', '--width', arg_only=True, type=int, default=128, help='Width of the display, swapped with the height when rotated by 90 degrees. Default: 128')
+@cli.argument('-H', '--height', arg_only=True, type=int, default=32, help='Height of the display, a multiple of 8. Default: 32')
+@cli.argument('-t', '--threshold', arg_only=True, type=int, default=128, help='Brightness from which a pixel is on, from 0 to 255. Default: 128')
+@cli.argument('-i', '--invert', arg_only=True, action='store_true', help='Turn on the dark pixels instead of the bright ones')
+@cli.argument('filenames', nargs='+', arg_only=True, help='PNG or GIF images, every frame of every image is a frame of the animation')
+@cli.subcommand('Converts images to run-length encoded frames for the OLED driver.')
+def img2oled(cli):
+    """Convert images to a C array of run-length encoded frames for oled_write_rle_P().
+
+    The first frame is written in full, the following ones only encode the bytes that differ from the frame before them.
+    """
+    if cli.args.height % 8:
+        cli.log.error('The height must be a multiple of 8.')
+        return False
+
+    try:
+        images = load_frames(cli.args.filenames)
+    except ImportError:
+        cli.log.error('Pillow is required to read images. Run `python3 -m pip install -r requirements.txt`.')
+        return False
+    except OSError as e:
+        cli.log.error('Could not read image: %s', e)
+        return False
+
+    frames = []
+    for number, image in enumerate(images):
+        if image.size != (cli.args.width, cli.args.height):
+            cli.log.error('Frame %d is %dx%d, the display is %dx%d.', number, *image.size, cli.args.width, cli.args.height)
+            return False
+        frames.append(image_to_buffer(image, cli.args.width, cli.args.height, cli.args.threshold, cli.args.invert))
+
+    # Build the header
+    image_h_lines = ['/* This file was generated by `qmk img2oled`. */', '', '#pragma once', '']
+    image_h_lines.append('#define %s_FRAME_COUNT %d' % (cli.args.name.upper(), len(frames)))
+    image_h_lines.append('')
+    image_h_lines.append('// clang-format off')
+    image_h_lines.append('')
+    image_h_lines.append('static const char PROGMEM %s[] = {' % cli.args.name)
+
+    total = 0
+    previous = None
+    for number, frame in enumerate(frames):
+        encoded = encode_frame(frame, previous)
+        total += len(encoded)
+        previous = frame
+
+        image_h_lines.append('    // frame %d, %d bytes' % (number, len(encoded)))
+        for i in range(0, len(encoded), 16):
+            image_h_lines.append('    ' + ' '.join('0x%02X,' % value for value in encoded[i:i + 16]))
+
+    image_h_lines.append('};')
+
+    # Show the results
+    image_h = '\n'.join(image_h_lines) + '\n'
+
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.parent / (cli.args.output.name + '.bak'))
+        cli.args.output.write_text(image_h)
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote %d frames in %d bytes, instead of %d, to %s.', len(frames), total, len(frames) * len(frames[0]), cli.args.output)
+
+    else:
+        print(image_h)
@@ -150,6 +150,20 @@ def test_json2c_stdin():
     assert result.stdout == '#include QMK_KEYBOARD_H\nconst uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {\t[0] = LAYOUT_ortho_1x1(KC_A)};\n\n'
 
 
+def test_img2oled(tmp_path):
+    from PIL import Image
+
+    frames = [Image.new('1', (128, 32)) for i in range(2)]
+    frames[1].putpixel((0, 0), 1)
+    frames[0].save(tmp_path / 'anim.gif', save_all=True, append_images=frames[1:])
+
+    result = check_subcommand('img2oled', '-n', 'anim', str(tmp_path / 'anim.gif'))
+    check_returncode(result)
+    assert '#define ANIM_FRAME_COUNT 2' in result.stdout
+    assert '    // frame 0, 16 bytes\n    0x7F, 0x00, 0x7F, 0x00,' in result.stdout
+    assert '    // frame 1, 4 bytes\n    0x80, 0x01, 0xC6, 0x3E,\n' in result.stdout
+
+
 def test_info():
     result = check_subcommand('info', '-kb', 'handwired/pytest/basic')
     check_returncode(result)
@@ -261,6 +275,16 @@ def test_generate_layouts():
     assert '#define LAYOUT_custom(k0A) {' in result.stdout
 
 
+def test_generate_rgb_matrix_geometry():
+    result = check_subcommand('generate-rgb-matrix-geometry', '-kb', 'handwired/pytest/basic')
+    check_returncode(result)
+    assert '#define RGB_MATRIX_GEOMETRY_LED_COUNT 2' in result.stdout
+    assert '#define RGB_MATRIX_GEOMETRY_CENTER_X 112' in result.stdout
+    assert '#ifdef RGB_MATRIX_CENTER' in result.stdout
+    assert '    {143, 116},' in result.stdout
+    assert '    { 15, 116},' in result.stdout
+
+
 def test_format_json_keyboard():
     result = check_subcommand('format-json', '--format', 'keyboard', 'lib/python/qmk/tests/minimal_info.json')
     check_returncode(result)
@@ -0,0 +1,47 @@
+import pytest
+
+from qmk.c_parse import find_led_config_points
+
+
+def test_find_led_config_points(tmp_path):
+    file = tmp_path / 'keyboard.c'
+    file.write_text('''
+led_config_t g_led_config = { {
+    { 0, NO_LED }
+}, {
+    // LED Index to Physical Position
+    { 0, 0 }, { 0x10, 64 }
+}, {
+    LED_FLAG_KEYLIGHT, 2
+} };
+''')
+    assert find_led_config_points(file) == [[0, 0], [16, 64]]
+
+
+def test_find_led_config_points_none(tmp_path):
+    file = tmp_path / 'keyboard.c'
+    file.write_text('extern led_config_t g_led_config;\n')
+    assert find_led_config_points(file) is None
+
+
+def test_find_led_config_points_unreadable(tmp_path):
+    file = tmp_path / 'keyboard.c'
+    file.write_text('''
+led_config_t g_led_config = { {
+    { 0, 1 }
+}, {
+#ifdef LEFT
+    { 0, 0 }, { 16, 0 }
+#else
+    { 224, 0 }, { 208, 0 }
+#endif
+}, {
+    4, 4
+} };
+''')
+    with pytest.raises(ValueError):
+        find_led_config_points(file)
+
+    file.write_text('led_config_t g_led_config = { { { 0 } }, { { 224 / 2, 0 } }, { 4 } };\n')
+    with pytest.raises(ValueError):
+        find_led_config_points(file)
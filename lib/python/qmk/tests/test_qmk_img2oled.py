@@ -0,0 +1,83 @@
+import random
+
+from qmk.cli.img2oled import RLE_LITERAL, RLE_MAX_COUNT, RLE_REPEAT, RLE_SKIP_LONG, encode_frame
+
+FRAME_SIZE = 512  # 128x32
+
+
+def write_rle(buffer, data):
+    """Decodes a frame into `buffer` like oled_write_rle_P() in drivers/oled/oled_driver.c, returns the number of bytes read.
+    """
+    position = 0
+    index = 0
+    while index < len(buffer):
+        op = data[position]
+        position += 1
+        count = (op & 0x3F) + 1
+        if op & 0xC0 == RLE_SKIP_LONG:
+            count *= 64
+        count = min(count, len(buffer) - index)
+
+        if op & 0xC0 == RLE_REPEAT:
+            buffer[index:index + count] = [data[position]] * count
+            position += 1
+        elif op & 0xC0 == RLE_LITERAL:
+            buffer[index:index + count] = data[position:position + count]
+            position += count
+        index += count
+
+    return position
+
+
+def random_frame(rng, previous=None):
+    """Returns a frame with runs of repeated bytes, and when given a previous frame, runs of unchanged ones.
+    """
+    frame = []
+    while len(frame) < FRAME_SIZE:
+        length = min(rng.choice([1, 2, 3, 5, 63, 64, 65, 200, 4096]), FRAME_SIZE - len(frame))
+        kind = rng.randrange(3)
+        if kind == 0 and previous:
+            frame.extend(previous[len(frame):len(frame) + length])
+        elif kind == 1:
+            frame.extend([rng.randrange(256)] * length)
+        else:
+            frame.extend(rng.randrange(256) for _ in range(length))
+
+    return frame
+
+
+def test_encode_frame_round_trip():
+    rng = random.Random(1)
+    for _ in range(200):
+        frame = random_frame(rng)
+        buffer = [0xAA] * FRAME_SIZE
+        encoded = encode_frame(frame)
+        assert write_rle(buffer, encoded) == len(encoded)
+        assert buffer == frame
+
+
+def test_encode_frame_round_trip_animation():
+    rng = random.Random(2)
+    frame = random_frame(rng)
+    buffer = list(frame)
+    for _ in range(200):
+        previous, frame = frame, random_frame(rng, frame)
+        encoded = encode_frame(frame, previous)
+        assert write_rle(buffer, encoded) == len(encoded)
+        assert buffer == frame
+
+
+def test_encode_frame_unchanged():
+    frame = [0x55] * FRAME_SIZE
+    buffer = list(frame)
+    encoded = encode_frame(frame, frame)
+    # a skip of 512 bytes is a single long skip
+    assert encoded == [RLE_SKIP_LONG | (FRAME_SIZE // RLE_MAX_COUNT - 1)]
+    assert write_rle(buffer, encoded) == 1
+    assert buffer == frame
+
+
+def test_encode_frame_repeat():
+    frame = [0xFF] * FRAME_SIZE
+    encoded = encode_frame(frame)
+    assert encoded == [RLE_REPEAT | (RLE_MAX_COUNT - 1), 0xFF] * (FRAME_SIZE // RLE_MAX_COUNT)
@@ -93,7 +93,7 @@ void process_api(uint16_t length, uint8_t* data) {
                 }
                 case DT_BACKLIGHT: {
 #ifdef BACKLIGHT_ENABLE
-                    uint8_t backlight_bytes[1] = {eeprom_read_byte(EECONFIG_BACKLIGHT)};
+                    uint8_t backlight_bytes[1] = {eeconfig_read_backlight()};
                     MT_GET_DATA_ACK(DT_BACKLIGHT, backlight_bytes, 1);
 #else
                     MT_GET_DATA_ACK(DT_BACKLIGHT, NULL, 0);
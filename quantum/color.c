@@ -18,42 +18,22 @@
 #include "led_tables.h"
 #include "progmem.h"
 
-RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
-    RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
+// v is the value after the CIE curve
+static inline RGB hsv_to_rgb_kernel(uint8_t h, uint8_t s, uint8_t v) {
+    RGB     rgb;
+    uint8_t region, remainder, p, q, t;
 
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-        } else {
-            rgb.r = hsv.v;
-            rgb.g = hsv.v;
-            rgb.b = hsv.v;
-        }
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
+    if (s == 0) {
+        rgb.r = v;
+        rgb.g = v;
+        rgb.b = v;
         return rgb;
     }
 
-    h = hsv.h;
-    s = hsv.s;
-#ifdef USE_CIE1931_CURVE
-    if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-    } else {
-        v = hsv.v;
-    }
-#else
-    v = hsv.v;
-#endif
-
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
+    // h * 6 / 255 without a division, exact for every hue
+    uint16_t h6 = h * 6;
+    region      = (h6 + 1 + (h6 >> 8)) >> 8;
+    remainder   = (h * 2 - region * 85) * 3;
 
     p = (v * (255 - s)) >> 8;
     q = (v * (255 - ((s * remainder) >> 8))) >> 8;
@@ -96,6 +76,15 @@ RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
     return rgb;
 }
 
+RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
+#ifdef USE_CIE1931_CURVE
+    if (use_cie) {
+        return hsv_to_rgb_kernel(hsv.h, hsv.s, pgm_read_byte(&CIE1931_CURVE[hsv.v]));
+    }
+#endif
+    return hsv_to_rgb_kernel(hsv.h, hsv.s, hsv.v);
+}
+
 RGB hsv_to_rgb(HSV hsv) {
 #ifdef USE_CIE1931_CURVE
     return hsv_to_rgb_impl(hsv, true);
@@ -106,6 +95,16 @@ RGB hsv_to_rgb(HSV hsv) {
 
 RGB hsv_to_rgb_nocie(HSV hsv) { return hsv_to_rgb_impl(hsv, false); }
 
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+#ifdef USE_CIE1931_CURVE
+        rgb[i] = hsv_to_rgb_kernel(hsv[i].h, hsv[i].s, pgm_read_byte(&CIE1931_CURVE[hsv[i].v]));
+#else
+        rgb[i] = hsv_to_rgb_kernel(hsv[i].h, hsv[i].s, hsv[i].v);
+#endif
+    }
+}
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
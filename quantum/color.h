@@ -91,6 +91,8 @@ typedef struct PACKED {
 
 RGB hsv_to_rgb(HSV hsv);
 RGB hsv_to_rgb_nocie(HSV hsv);
+// converts count colors like hsv_to_rgb(), cheaper than one call per color
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count);
 #ifdef RGBW
 void convert_rgb_to_rgbw(LED_TYPE *led);
 #endif
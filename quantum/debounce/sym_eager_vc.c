@@ -0,0 +1,126 @@
+/*
+Copyright 2021 QMK
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Per-key eager algorithm using vertical counters.
+Behaves like sym_eager_pk, but the counters of a whole row are bit-sliced across DEBOUNCE_VC_BITS
+matrix_row_t words, so every key of a row is counted with a few bitwise operations per millisecond.
+After pressing a key, it immediately changes state, and starts its counter.
+No further inputs are accepted until DEBOUNCE milliseconds have occurred.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#if DEBOUNCE <= 1
+#    define DEBOUNCE_VC_BITS 1
+#elif DEBOUNCE <= 3
+#    define DEBOUNCE_VC_BITS 2
+#elif DEBOUNCE <= 7
+#    define DEBOUNCE_VC_BITS 3
+#elif DEBOUNCE <= 15
+#    define DEBOUNCE_VC_BITS 4
+#elif DEBOUNCE <= 31
+#    define DEBOUNCE_VC_BITS 5
+#elif DEBOUNCE <= 63
+#    define DEBOUNCE_VC_BITS 6
+#elif DEBOUNCE <= 127
+#    define DEBOUNCE_VC_BITS 7
+#elif DEBOUNCE <= 255
+#    define DEBOUNCE_VC_BITS 8
+#else
+#    error DEBOUNCE must be 255 or less for this debounce algorithm
+#endif
+
+// bit n of every key's counter lives in counters[row][n]
+static matrix_row_t counters[MATRIX_ROWS][DEBOUNCE_VC_BITS];
+// keys that changed state less than DEBOUNCE milliseconds ago
+static matrix_row_t locked[MATRIX_ROWS];
+static bool         counting;
+
+static uint16_t last_time;
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t bit = 0; bit < DEBOUNCE_VC_BITS; bit++) {
+            counters[row][bit] = 0;
+        }
+        locked[row] = 0;
+    }
+    counting  = false;
+    last_time = timer_read();
+}
+
+#if DEBOUNCE > 0
+// Counts the locked keys of a row up by `ticks` milliseconds and returns the keys reaching DEBOUNCE.
+static matrix_row_t count_row(matrix_row_t *counter, matrix_row_t active, uint8_t ticks) {
+    matrix_row_t expired = 0;
+
+    while (ticks-- && active) {
+        matrix_row_t carry = active;
+        for (uint8_t bit = 0; bit < DEBOUNCE_VC_BITS && carry; bit++) {
+            matrix_row_t next_carry = counter[bit] & carry;
+            counter[bit] ^= carry;
+            carry = next_carry;
+        }
+
+        matrix_row_t reached = active;
+        for (uint8_t bit = 0; bit < DEBOUNCE_VC_BITS; bit++) {
+            reached &= (DEBOUNCE & (1 << bit)) ? counter[bit] : ~counter[bit];
+        }
+        for (uint8_t bit = 0; bit < DEBOUNCE_VC_BITS; bit++) {
+            counter[bit] &= ~reached;
+        }
+        expired |= reached;
+        active &= ~reached;
+    }
+    return expired;
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+
+    if (!changed && !counting) return;
+
+    // after DEBOUNCE milliseconds every counter has expired, so more ticks make no difference
+    uint8_t ticks = elapsed > DEBOUNCE ? DEBOUNCE : elapsed;
+
+    counting = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        locked[row] &= ~count_row(counters[row], locked[row], ticks);
+
+        // upload changes of unlocked keys right away, and lock them
+        matrix_row_t flipped = (raw[row] ^ cooked[row]) & ~locked[row];
+        cooked[row] ^= flipped;
+        locked[row] |= flipped;
+        counting |= locked[row] != 0;
+    }
+}
+#else  // no debouncing.
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        cooked[row] = raw[row];
+    }
+}
+#endif
+
+bool debounce_active(void) { return counting; }
@@ -0,0 +1,559 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Correctness and benchmark harness for the debounce algorithms.
+Each test binary links a single algorithm (selected by DEBOUNCE_ALGORITHM) and the reference model
+it must reproduce (selected by DEBOUNCE_MODEL_*). Key traces are replayed scan by scan through both,
+and the debounced matrices must be identical after every scan. The benchmark test also reports the
+cost of a debounce() call and the latency the algorithm adds on top of the physical key transitions.
+*/
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "matrix.h"
+#include "timer.h"
+#include "debounce.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+#define DEBOUNCE_STR_(x) #x
+#define DEBOUNCE_STR(x) DEBOUNCE_STR_(x)
+#define ALGORITHM_NAME DEBOUNCE_STR(DEBOUNCE_ALGORITHM)
+
+namespace {
+
+// A single toggle of one raw key. A physical press or release is one toggle plus an even number of bounces.
+struct KeyToggle {
+    uint32_t time;
+    uint8_t  row;
+    uint8_t  col;
+};
+
+// The transition the user actually made, used to measure latency.
+struct KeyTransition {
+    uint32_t time;
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+};
+
+struct Trace {
+    std::string                name;
+    uint32_t                   duration;
+    std::vector<KeyToggle>     toggles;
+    std::vector<KeyTransition> transitions;
+    // extra time added to every scan interval, 0 means one scan per millisecond
+    std::vector<uint8_t> scan_jitter;
+    // the switch bounces for longer than DEBOUNCE, so eager algorithms may report the bounce
+    bool bounce_exceeds_debounce;
+};
+
+class TraceBuilder {
+   public:
+    explicit TraceBuilder(std::string name) { trace_.name = name; }
+
+    // Toggles the key at each offset after `time`; an odd number of offsets changes its state.
+    TraceBuilder& transition(uint32_t time, uint8_t row, uint8_t col, std::vector<uint32_t> bounce = {0}) {
+        bool& state = state_[row][col];
+        for (auto offset : bounce) {
+            trace_.toggles.push_back({time + offset, row, col});
+        }
+        if (bounce.size() % 2) {
+            state = !state;
+            trace_.transitions.push_back({time, row, col, state});
+        }
+        trace_.duration = std::max(trace_.duration, time + bounce.back());
+        return *this;
+    }
+
+    TraceBuilder& tap(uint32_t time, uint8_t row, uint8_t col, uint32_t hold, std::vector<uint32_t> press_bounce = {0}, std::vector<uint32_t> release_bounce = {0}) {
+        transition(time, row, col, press_bounce);
+        return transition(time + hold, row, col, release_bounce);
+    }
+
+    // A contact that closes for a moment without being pressed, e.g. ESD or a scratchy switch.
+    TraceBuilder& glitch(uint32_t time, uint8_t row, uint8_t col) { return transition(time, row, col, {0, 1}); }
+
+    TraceBuilder& bounce_exceeds_debounce() {
+        trace_.bounce_exceeds_debounce = true;
+        return *this;
+    }
+
+    TraceBuilder& jitter(std::vector<uint8_t> jitter) {
+        trace_.scan_jitter = jitter;
+        return *this;
+    }
+
+    Trace build() {
+        std::stable_sort(trace_.toggles.begin(), trace_.toggles.end(), [](const KeyToggle& a, const KeyToggle& b) { return a.time < b.time; });
+        std::stable_sort(trace_.transitions.begin(), trace_.transitions.end(), [](const KeyTransition& a, const KeyTransition& b) { return a.time < b.time; });
+        return trace_;
+    }
+
+   private:
+    Trace trace_ = {"", 0, {}, {}, {}, false};
+    bool  state_[MATRIX_ROWS][MATRIX_COLS] = {};
+};
+
+bool get_bit(const matrix_row_t matrix[], uint8_t row, uint8_t col) { return matrix[row] & (MATRIX_ROW_SHIFTER << col); }
+
+void set_bit(matrix_row_t matrix[], uint8_t row, uint8_t col, bool value) {
+    if (value) {
+        matrix[row] |= MATRIX_ROW_SHIFTER << col;
+    } else {
+        matrix[row] &= ~(MATRIX_ROW_SHIFTER << col);
+    }
+}
+
+/* Reference models, written for clarity with explicit 32-bit timestamps. */
+
+// Global defer: the whole matrix is copied once nothing changed for more than DEBOUNCE ms.
+class DeferGlobalModel {
+   public:
+    void init(uint8_t num_rows) {
+        num_rows_   = num_rows;
+        debouncing_ = false;
+    }
+
+    void debounce(uint32_t now, const matrix_row_t raw[], matrix_row_t cooked[], bool changed) {
+        if (changed) {
+            debouncing_ = true;
+            start_      = now;
+        }
+        if (debouncing_ && now - start_ > DEBOUNCE) {
+            std::copy(raw, raw + num_rows_, cooked);
+            debouncing_ = false;
+        }
+    }
+
+   private:
+    uint8_t  num_rows_   = 0;
+    bool     debouncing_ = false;
+    uint32_t start_      = 0;
+};
+
+// Per-key defer: a key is copied once it kept differing from its debounced state for DEBOUNCE ms.
+class DeferPerKeyModel {
+   public:
+    void init(uint8_t num_rows) {
+        num_rows_ = num_rows;
+        std::fill(&timing_[0][0], &timing_[0][0] + MATRIX_ROWS * MATRIX_COLS, false);
+    }
+
+    void debounce(uint32_t now, const matrix_row_t raw[], matrix_row_t cooked[], bool changed) {
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (timing_[row][col] && now - start_[row][col] >= DEBOUNCE) {
+                    timing_[row][col] = false;
+                    set_bit(cooked, row, col, get_bit(raw, row, col));
+                }
+            }
+        }
+        if (!changed) return;
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (get_bit(raw, row, col) == get_bit(cooked, row, col)) {
+                    timing_[row][col] = false;
+                } else if (!timing_[row][col]) {
+                    timing_[row][col] = true;
+                    start_[row][col]  = now;
+                }
+            }
+        }
+    }
+
+   private:
+    uint8_t  num_rows_ = 0;
+    bool     timing_[MATRIX_ROWS][MATRIX_COLS];
+    uint32_t start_[MATRIX_ROWS][MATRIX_COLS];
+};
+
+// Per-key eager: a key is copied as soon as it changes, then ignored for DEBOUNCE ms.
+class EagerPerKeyModel {
+   public:
+    void init(uint8_t num_rows) {
+        num_rows_    = num_rows;
+        need_update_ = false;
+        std::fill(&timing_[0][0], &timing_[0][0] + MATRIX_ROWS * MATRIX_COLS, false);
+    }
+
+    void debounce(uint32_t now, const matrix_row_t raw[], matrix_row_t cooked[], bool changed) {
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (timing_[row][col] && now - start_[row][col] >= DEBOUNCE) {
+                    timing_[row][col] = false;
+                }
+            }
+        }
+        if (!changed && !need_update_) return;
+        need_update_ = false;
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (get_bit(raw, row, col) == get_bit(cooked, row, col)) continue;
+                if (timing_[row][col]) {
+                    need_update_ = true;
+                } else {
+                    set_bit(cooked, row, col, get_bit(raw, row, col));
+                    timing_[row][col] = true;
+                    start_[row][col]  = now;
+                }
+            }
+        }
+    }
+
+   private:
+    uint8_t  num_rows_    = 0;
+    bool     need_update_ = false;
+    bool     timing_[MATRIX_ROWS][MATRIX_COLS];
+    uint32_t start_[MATRIX_ROWS][MATRIX_COLS];
+};
+
+// Per-row eager: a row is copied as soon as it changes, then ignored for DEBOUNCE ms.
+// A copy is also attempted on the scan where the last row stops being ignored.
+class EagerPerRowModel {
+   public:
+    void init(uint8_t num_rows) {
+        num_rows_    = num_rows;
+        need_update_ = false;
+        std::fill(timing_, timing_ + MATRIX_ROWS, false);
+    }
+
+    void debounce(uint32_t now, const matrix_row_t raw[], matrix_row_t cooked[], bool changed) {
+        bool was_timing = false;
+        bool is_timing  = false;
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            was_timing |= timing_[row];
+            if (timing_[row] && now - start_[row] >= DEBOUNCE) {
+                timing_[row] = false;
+            }
+            is_timing |= timing_[row];
+        }
+        if (!changed && !need_update_ && !(was_timing && !is_timing)) return;
+        need_update_ = false;
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            if (raw[row] == cooked[row]) continue;
+            if (timing_[row]) {
+                need_update_ = true;
+            } else {
+                cooked[row]  = raw[row];
+                timing_[row] = true;
+                start_[row]  = now;
+            }
+        }
+    }
+
+   private:
+    uint8_t  num_rows_    = 0;
+    bool     need_update_ = false;
+    bool     timing_[MATRIX_ROWS];
+    uint32_t start_[MATRIX_ROWS];
+};
+
+#if defined(DEBOUNCE_MODEL_DEFER_G)
+typedef DeferGlobalModel ReferenceModel;
+#elif defined(DEBOUNCE_MODEL_DEFER_PK)
+typedef DeferPerKeyModel ReferenceModel;
+#elif defined(DEBOUNCE_MODEL_EAGER_PK)
+typedef EagerPerKeyModel ReferenceModel;
+#elif defined(DEBOUNCE_MODEL_EAGER_PR)
+typedef EagerPerRowModel ReferenceModel;
+#else
+#    error "No reference model selected for this debounce algorithm"
+#endif
+
+// One scan of a replayed trace: the raw matrix as seen by the algorithm and the time it was read.
+struct Scan {
+    uint32_t                  time;
+    bool                      changed;
+    std::vector<matrix_row_t> raw;
+};
+
+// Scans long enough after the last toggle for every algorithm to settle.
+const uint32_t SETTLE_TIME = 4 * DEBOUNCE + 10;
+
+std::vector<Scan> scan_trace(const Trace& trace, uint8_t num_rows) {
+    std::vector<Scan>         scans;
+    std::vector<matrix_row_t> raw(num_rows, 0);
+    size_t                    next   = 0;
+    size_t                    jitter = 0;
+
+    for (uint32_t now = 1; now <= trace.duration + SETTLE_TIME;) {
+        bool changed = false;
+        for (; next < trace.toggles.size() && trace.toggles[next].time <= now; next++) {
+            const KeyToggle& toggle = trace.toggles[next];
+            raw[toggle.row] ^= MATRIX_ROW_SHIFTER << toggle.col;
+            changed = true;
+        }
+        // toggles that cancel out within one scan are never seen
+        changed = changed && (scans.empty() ? std::any_of(raw.begin(), raw.end(), [](matrix_row_t row) { return row != 0; }) : raw != scans.back().raw);
+        scans.push_back({now, changed, raw});
+
+        now += 1;
+        if (!trace.scan_jitter.empty()) {
+            now += trace.scan_jitter[jitter++ % trace.scan_jitter.size()];
+        }
+    }
+    return scans;
+}
+
+struct LatencyStats {
+    uint32_t count    = 0;
+    uint64_t total    = 0;
+    uint32_t max      = 0;
+    uint32_t dropped  = 0;
+    uint32_t spurious = 0;
+
+    void merge(const LatencyStats& other) {
+        count += other.count;
+        total += other.total;
+        max = std::max(max, other.max);
+        dropped += other.dropped;
+        spurious += other.spurious;
+    }
+
+    double average() const { return count ? (double)total / count : 0.0; }
+};
+
+class Debounce : public ::testing::TestWithParam<uint8_t> {
+   protected:
+    void SetUp() override {
+        num_rows_ = GetParam();
+        // both the algorithm and the harness keep time moving forward across tests
+        advance_time(1000);
+        debounce_init(num_rows_);
+        model_.init(num_rows_);
+        std::fill(cooked_, cooked_ + MATRIX_ROWS, 0);
+        std::fill(expected_, expected_ + MATRIX_ROWS, 0);
+        // a few idle scans flush any state left over from a previous test
+        for (int i = 0; i < DEBOUNCE + 2; i++) {
+            advance_time(1);
+            debounce(idle_, cooked_, num_rows_, false);
+        }
+    }
+
+    // Replays a trace through the algorithm and the reference model, failing on the first divergence.
+    LatencyStats replay(const Trace& trace) {
+        std::vector<Scan> scans  = scan_trace(trace, num_rows_);
+        uint32_t          origin = timer_read32();
+        LatencyStats      stats;
+
+        // time of the latest physical transition of each key, and whether it reached the debounced matrix
+        std::vector<const KeyTransition*> latest(MATRIX_ROWS * MATRIX_COLS, nullptr);
+        std::vector<bool>                 reported(trace.transitions.size(), false);
+        std::vector<bool>                 diverted(MATRIX_ROWS * MATRIX_COLS, false);
+        size_t                            next = 0;
+
+        for (const Scan& scan : scans) {
+            set_time(origin + scan.time);
+            for (; next < trace.transitions.size() && trace.transitions[next].time <= scan.time; next++) {
+                const KeyTransition& transition                                 = trace.transitions[next];
+                latest[transition.row * MATRIX_COLS + transition.col] = &transition;
+            }
+
+            matrix_row_t previous[MATRIX_ROWS];
+            std::copy(cooked_, cooked_ + MATRIX_ROWS, previous);
+
+            debounce(const_cast<matrix_row_t*>(scan.raw.data()), cooked_, num_rows_, scan.changed);
+            model_.debounce(scan.time, scan.raw.data(), expected_, scan.changed);
+
+            for (uint8_t row = 0; row < num_rows_; row++) {
+                EXPECT_EQ(cooked_[row], expected_[row]) << trace.name << ": row " << (int)row << " differs from the reference model " << scan.time << " ms into the trace";
+                if (cooked_[row] != expected_[row]) {
+                    return stats;
+                }
+
+                matrix_row_t delta = cooked_[row] ^ previous[row];
+                for (uint8_t col = 0; delta; col++, delta >>= 1) {
+                    if (!(delta & 1)) continue;
+                    size_t               key        = row * MATRIX_COLS + col;
+                    const KeyTransition* transition = latest[key];
+                    bool                 pressed    = get_bit(cooked_, row, col);
+                    if (!transition || transition->pressed != pressed) {
+                        // the debounced state moved away from the physical one
+                        stats.spurious++;
+                        diverted[key] = true;
+                    } else if (diverted[key]) {
+                        // and came back again, which is not a new transition
+                        diverted[key] = false;
+                    } else {
+                        uint32_t latency = scan.time - transition->time;
+                        stats.count++;
+                        stats.total += latency;
+                        stats.max                                    = std::max(stats.max, latency);
+                        reported[transition - trace.transitions.data()] = true;
+                    }
+                }
+            }
+        }
+
+        for (uint8_t row = 0; row < num_rows_; row++) {
+            EXPECT_EQ(cooked_[row], scans.back().raw[row]) << trace.name << ": row " << (int)row << " did not settle to its raw state";
+        }
+        stats.dropped = std::count(reported.begin(), reported.end(), false);
+        return stats;
+    }
+
+    // Nanoseconds per debounce() call when replaying the scans of a trace.
+    double measure(const Trace& trace, int repeat) {
+        std::vector<Scan> scans = scan_trace(trace, num_rows_);
+        auto              total = std::chrono::nanoseconds::zero();
+
+        for (int i = 0; i < repeat; i++) {
+            uint32_t origin = timer_read32();
+            auto     start  = std::chrono::steady_clock::now();
+            for (const Scan& scan : scans) {
+                set_time(origin + scan.time);
+                debounce(const_cast<matrix_row_t*>(scan.raw.data()), cooked_, num_rows_, scan.changed);
+            }
+            total += std::chrono::steady_clock::now() - start;
+            advance_time(DEBOUNCE + 1);
+        }
+        return (double)total.count() / (scans.size() * repeat);
+    }
+
+    uint8_t        num_rows_;
+    ReferenceModel model_;
+    matrix_row_t   idle_[MATRIX_ROWS]     = {};
+    matrix_row_t   cooked_[MATRIX_ROWS]   = {};
+    matrix_row_t   expected_[MATRIX_ROWS] = {};
+};
+
+std::vector<Trace> scripted_traces(uint8_t num_rows) {
+    uint8_t last = num_rows - 1;
+    return {
+        TraceBuilder("clean tap").tap(10, 0, 0, 40).build(),
+        TraceBuilder("press bounce").tap(10, 1, 3, 60, {0, 1, 2}).build(),
+        TraceBuilder("release bounce").tap(10, 2, 5, 60, {0}, {0, 1, 3, 4, 5}).build(),
+        TraceBuilder("long bounce").tap(10, 3, 7, 80, {0, 2, 3, 6, 8}, {0, 3, 4, 7, 9}).bounce_exceeds_debounce().build(),
+        TraceBuilder("chord").tap(10, 0, 1, 50, {0, 1, 2}).tap(11, 0, 2, 50, {0}).tap(12, 1, 1, 48, {0, 2, 3}).tap(10, last, MATRIX_COLS - 1, 55).build(),
+        TraceBuilder("roll").tap(10, 1, 0, 30, {0, 1, 2}).tap(20, 1, 1, 30, {0, 1, 2}).tap(30, 1, 2, 30, {0, 1, 2}).tap(40, 1, 3, 30, {0, 1, 2}).build(),
+        TraceBuilder("fast repeat").tap(10, 2, 2, 12).tap(30, 2, 2, 12).tap(50, 2, 2, 12).tap(70, 2, 2, 12).build(),
+        TraceBuilder("bounce into another key").tap(10, 0, 4, 40, {0, 1, 2}).tap(12, 0, 5, 40, {0, 1, 2}, {0, 2, 4}).build(),
+        TraceBuilder("jittered scans").tap(10, 1, 6, 40, {0, 1, 2}, {0, 2, 3}).tap(15, last, 0, 40, {0, 3, 4}).jitter({0, 2, 1, 0, 0, 3}).build(),
+    };
+}
+
+// Random typing on a handful of keys, with contact bounce on every transition.
+Trace random_trace(uint8_t num_rows, uint32_t seed, uint32_t duration, bool jitter, bool glitches) {
+    std::mt19937                            rng(seed);
+    std::uniform_int_distribution<uint32_t> idle(5, 200);
+    std::uniform_int_distribution<uint32_t> hold(2 * DEBOUNCE + 10, 150);
+    std::uniform_int_distribution<uint32_t> bounces(0, 3);
+    std::uniform_int_distribution<uint32_t> bounce_step(1, 2);
+    std::uniform_int_distribution<int>      row_dist(0, num_rows - 1);
+    std::uniform_int_distribution<int>      col_dist(0, MATRIX_COLS - 1);
+
+    std::ostringstream name;
+    name << "random seed " << seed;
+    TraceBuilder builder(name.str());
+
+    auto bounce = [&]() {
+        std::vector<uint32_t> offsets = {0};
+        for (uint32_t n = bounces(rng) * 2; n; n--) {
+            offsets.push_back(offsets.back() + bounce_step(rng));
+        }
+        return offsets;
+    };
+
+    // each key types on its own, so pick distinct keys to keep their transitions from overlapping
+    std::vector<int> keys;
+    while (keys.size() < 12) {
+        int key = row_dist(rng) * MATRIX_COLS + col_dist(rng);
+        if (std::find(keys.begin(), keys.end(), key) == keys.end()) keys.push_back(key);
+    }
+    for (int key : keys) {
+        for (uint32_t t = idle(rng); t + 200 < duration; t += idle(rng)) {
+            uint32_t held = hold(rng);
+            builder.tap(t, key / MATRIX_COLS, key % MATRIX_COLS, held, bounce(), bounce());
+            // leave room for the release bounce
+            t += held + 12;
+        }
+    }
+    if (glitches) {
+        for (uint32_t t = idle(rng); t + 200 < duration; t += idle(rng)) {
+            builder.glitch(t, row_dist(rng), col_dist(rng));
+        }
+    }
+    if (jitter) {
+        std::uniform_int_distribution<int> step(0, 2);
+        std::vector<uint8_t>               pattern(97);
+        for (auto& p : pattern) p = step(rng);
+        builder.jitter(pattern);
+    }
+    return builder.build();
+}
+
+}  // namespace
+
+TEST_P(Debounce, ScriptedTracesMatchReference) {
+    for (const Trace& trace : scripted_traces(num_rows_)) {
+        LatencyStats stats = replay(trace);
+        if (HasFailure()) return;
+        EXPECT_EQ(stats.dropped, 0u) << trace.name;
+        if (!trace.bounce_exceeds_debounce) {
+            EXPECT_EQ(stats.spurious, 0u) << trace.name;
+        }
+        EXPECT_LE(stats.max, 4u * DEBOUNCE + 10) << trace.name;
+    }
+}
+
+TEST_P(Debounce, RandomTracesMatchReference) {
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        replay(random_trace(num_rows_, seed, 3000, seed % 2, false));
+        if (HasFailure()) return;
+    }
+}
+
+TEST_P(Debounce, GlitchyTracesMatchReference) {
+    for (uint32_t seed = 100; seed < 104; seed++) {
+        replay(random_trace(num_rows_, seed, 3000, seed % 2, true));
+        if (HasFailure()) return;
+    }
+}
+
+TEST_P(Debounce, Benchmark) {
+    LatencyStats latency;
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        latency.merge(replay(random_trace(num_rows_, seed, 3000, false, false)));
+    }
+    ASSERT_FALSE(HasFailure());
+
+    double typing = measure(random_trace(num_rows_, 1, 3000, false, false), 20);
+    double idle   = measure(TraceBuilder("idle").tap(1, 0, 0, 2 * DEBOUNCE + 10).tap(3000, 0, 0, 2 * DEBOUNCE + 10).build(), 20);
+
+    std::ostringstream size;
+    size << (int)num_rows_ << "x" << MATRIX_COLS;
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1) << typing << " ns/scan typing, " << idle << " ns/scan idle, latency avg " << latency.average() << " ms max " << latency.max << " ms";
+    std::cout << "[ DEBOUNCE ] " << ALGORITHM_NAME << " " << size.str() << ": " << report.str() << std::endl;
+
+    RecordProperty(ALGORITHM_NAME "_" + size.str(), report.str());
+}
+
+INSTANTIATE_TEST_CASE_P(MatrixSizes, Debounce, ::testing::Values(4, 8, 16));
@@ -0,0 +1,26 @@
+# Every algorithm is built into its own test binary, since they all implement the same debounce() API.
+# The vertical counter algorithms are checked against the per-key models they are meant to reproduce.
+
+DEBOUNCE_COMMON_DEFS := -DNO_DEBUG -DMATRIX_ROWS=16 -DMATRIX_COLS=16 -DDEBOUNCE=5
+
+DEBOUNCE_COMMON_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_tests.cpp \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_sym_defer_g_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_ALGORITHM=sym_defer_g -DDEBOUNCE_MODEL_DEFER_G
+debounce_sym_defer_g_SRC := $(DEBOUNCE_COMMON_SRC) $(QUANTUM_PATH)/debounce/sym_defer_g.c
+
+debounce_sym_defer_pk_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_ALGORITHM=sym_defer_pk -DDEBOUNCE_MODEL_DEFER_PK
+debounce_sym_defer_pk_SRC := $(DEBOUNCE_COMMON_SRC) $(QUANTUM_PATH)/debounce/sym_defer_pk.c
+
+debounce_sym_defer_vc_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_ALGORITHM=sym_defer_vc -DDEBOUNCE_MODEL_DEFER_PK
+debounce_sym_defer_vc_SRC := $(DEBOUNCE_COMMON_SRC) $(QUANTUM_PATH)/debounce/sym_defer_vc.c
+
+debounce_sym_eager_pk_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_ALGORITHM=sym_eager_pk -DDEBOUNCE_MODEL_EAGER_PK
+debounce_sym_eager_pk_SRC := $(DEBOUNCE_COMMON_SRC) $(QUANTUM_PATH)/debounce/sym_eager_pk.c
+
+debounce_sym_eager_pr_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_ALGORITHM=sym_eager_pr -DDEBOUNCE_MODEL_EAGER_PR
+debounce_sym_eager_pr_SRC := $(DEBOUNCE_COMMON_SRC) $(QUANTUM_PATH)/debounce/sym_eager_pr.c
+
+debounce_sym_eager_vc_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_ALGORITHM=sym_eager_vc -DDEBOUNCE_MODEL_EAGER_PK
+debounce_sym_eager_vc_SRC := $(DEBOUNCE_COMMON_SRC) $(QUANTUM_PATH)/debounce/sym_eager_vc.c
@@ -21,6 +21,7 @@
 #include "quantum.h"  // for send_string()
 #include "dynamic_keymap.h"
 #include "via.h"  // for default VIA_EEPROM_ADDR_END
+#include <string.h>
 
 #ifndef DYNAMIC_KEYMAP_LAYER_COUNT
 #    define DYNAMIC_KEYMAP_LAYER_COUNT 4
@@ -49,6 +50,14 @@
 #    error DYNAMIC_KEYMAP_EEPROM_MAX_ADDR must be less than 65536
 #endif
 
+// The flash emulated EEPROM of STM32 F0/F1/F3 silently drops the writes past its size
+#if defined(EEPROM_EMU_STM32F303xC) || defined(EEPROM_EMU_STM32F103xB) || defined(EEPROM_EMU_STM32F072xB) || defined(EEPROM_EMU_STM32F042x6)
+#    include "eeprom_stm32.h"
+#    if DYNAMIC_KEYMAP_EEPROM_MAX_ADDR >= FEE_DENSITY_BYTES
+#        error DYNAMIC_KEYMAP_EEPROM_MAX_ADDR is past the end of the emulated EEPROM, lower it or raise FEE_DENSITY_BYTES
+#    endif
+#endif
+
 // If DYNAMIC_KEYMAP_EEPROM_ADDR not explicitly defined in config.h,
 // default it start after VIA_EEPROM_CUSTOM_ADDR+VIA_EEPROM_CUSTOM_SIZE
 #ifndef DYNAMIC_KEYMAP_EEPROM_ADDR
@@ -79,6 +88,53 @@
 #    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
 #endif
 
+#define DYNAMIC_KEYMAP_LAYER_SIZE (MATRIX_ROWS * MATRIX_COLS * 2)
+#define DYNAMIC_KEYMAP_EEPROM_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * DYNAMIC_KEYMAP_LAYER_SIZE)
+
+// Number of layers mirrored in RAM, so looking up a keycode in them doesn't read the EEPROM.
+// The lowest layers are mirrored, as every lookup falls through to them. The layers above are read
+// from the EEPROM one keycode at a time, so any number of active layers costs no more than before.
+// Defaults to every layer, except on AVR where RAM is scarce. 0 reads the EEPROM on every lookup.
+#ifndef DYNAMIC_KEYMAP_CACHE_LAYERS
+#    ifdef __AVR__
+#        define DYNAMIC_KEYMAP_CACHE_LAYERS 2
+#    else
+#        define DYNAMIC_KEYMAP_CACHE_LAYERS DYNAMIC_KEYMAP_LAYER_COUNT
+#    endif
+#endif
+
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > DYNAMIC_KEYMAP_LAYER_COUNT
+#    undef DYNAMIC_KEYMAP_CACHE_LAYERS
+#    define DYNAMIC_KEYMAP_CACHE_LAYERS DYNAMIC_KEYMAP_LAYER_COUNT
+#endif
+
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+#    define DYNAMIC_KEYMAP_CACHE_SIZE (DYNAMIC_KEYMAP_CACHE_LAYERS * DYNAMIC_KEYMAP_LAYER_SIZE)
+
+// Layers 0 to DYNAMIC_KEYMAP_CACHE_LAYERS - 1, in the same big endian layout as the EEPROM
+static uint8_t dynamic_keymap_cache[DYNAMIC_KEYMAP_CACHE_SIZE];
+static bool    dynamic_keymap_cache_loaded = false;
+
+static const uint8_t *dynamic_keymap_cached_layer(uint8_t layer) {
+    if (!dynamic_keymap_cache_loaded) {
+        eeprom_read_block(dynamic_keymap_cache, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, DYNAMIC_KEYMAP_CACHE_SIZE);
+        dynamic_keymap_cache_loaded = true;
+    }
+    return &dynamic_keymap_cache[layer * DYNAMIC_KEYMAP_LAYER_SIZE];
+}
+
+static void dynamic_keymap_cache_update(uint16_t offset, uint16_t size, const uint8_t *data) {
+    if (dynamic_keymap_cache_loaded && offset < DYNAMIC_KEYMAP_CACHE_SIZE) {
+        memcpy(&dynamic_keymap_cache[offset], data, offset + size > DYNAMIC_KEYMAP_CACHE_SIZE ? DYNAMIC_KEYMAP_CACHE_SIZE - offset : size);
+    }
+}
+
+static void dynamic_keymap_cache_clear(void) { dynamic_keymap_cache_loaded = false; }
+#else
+#    define dynamic_keymap_cache_update(offset, size, data)
+#    define dynamic_keymap_cache_clear()
+#endif
+
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
@@ -87,6 +143,13 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
 }
 
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+    if (layer < DYNAMIC_KEYMAP_CACHE_LAYERS) {
+        const uint8_t *key = dynamic_keymap_cached_layer(layer) + (row * MATRIX_COLS * 2) + (column * 2);
+        // Big endian, so we can read/write EEPROM directly from host if we want
+        return (key[0] << 8) | key[1];
+    }
+#endif
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = eeprom_read_byte(address) << 8;
@@ -95,53 +158,49 @@ uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column)
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
-    void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    uint8_t data[2] = {(uint8_t)(keycode >> 8), (uint8_t)(keycode & 0xFF)};
+    dynamic_keymap_set_buffer((layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2) + (column * 2), sizeof(data), data);
 }
 
 void dynamic_keymap_reset(void) {
     // Reset the keymaps in EEPROM to what is in flash.
     // All keyboards using dynamic keymaps should define a layout
     // for the same number of layers as DYNAMIC_KEYMAP_LAYER_COUNT.
+    uint8_t data[MATRIX_COLS * 2];
     for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
         for (int row = 0; row < MATRIX_ROWS; row++) {
             for (int column = 0; column < MATRIX_COLS; column++) {
-                dynamic_keymap_set_keycode(layer, row, column, pgm_read_word(&keymaps[layer][row][column]));
+                uint16_t keycode     = pgm_read_word(&keymaps[layer][row][column]);
+                data[column * 2]     = (uint8_t)(keycode >> 8);
+                data[column * 2 + 1] = (uint8_t)(keycode & 0xFF);
             }
+            dynamic_keymap_set_buffer((layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2), sizeof(data), data);
         }
     }
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
+    uint16_t valid = offset < DYNAMIC_KEYMAP_EEPROM_SIZE ? DYNAMIC_KEYMAP_EEPROM_SIZE - offset : 0;
+    if (valid > size) {
+        valid = size;
     }
+    eeprom_read_block(data, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR + offset, valid);
+    memset(data + valid, 0x00, size - valid);
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    uint16_t valid = offset < DYNAMIC_KEYMAP_EEPROM_SIZE ? DYNAMIC_KEYMAP_EEPROM_SIZE - offset : 0;
+    if (valid > size) {
+        valid = size;
     }
+    eeprom_update_block(data, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR + offset, valid);
+    dynamic_keymap_cache_update(offset, valid, data);
+    clear_layer_lookup_cache();
 }
 
+void dynamic_keymap_clear_cache(void) { dynamic_keymap_cache_clear(); }
+
 // This overrides the one in quantum/keymap_common.c
 uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
     if (layer < DYNAMIC_KEYMAP_LAYER_COUNT && key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
@@ -156,37 +215,27 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *target = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
+    uint16_t valid = offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE ? DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset : 0;
+    if (valid > size) {
+        valid = size;
     }
+    eeprom_read_block(data, (void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset, valid);
+    memset(data + valid, 0x00, size - valid);
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    uint16_t valid = offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE ? DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset : 0;
+    if (valid > size) {
+        valid = size;
     }
+    eeprom_update_block(data, (void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset, valid);
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    uint8_t zeros[16] = {0};
+    // set_buffer clips the last chunk to the end of the buffer
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; offset += sizeof(zeros)) {
+        dynamic_keymap_macro_set_buffer(offset, sizeof(zeros), zeros);
     }
 }
 
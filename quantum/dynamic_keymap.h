@@ -34,6 +34,9 @@ void     dynamic_keymap_reset(void);
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data);
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data);
 
+// The keymap is mirrored in RAM, code writing the keymap in EEPROM directly must clear it
+void dynamic_keymap_clear_cache(void);
+
 // This overrides the one in quantum/keymap_common.c
 // uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
 
@@ -0,0 +1,100 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "led_governor.h"
+#include "timer.h"
+#include "debug.h"
+#ifdef SPLIT_KEYBOARD
+#    include "keyboard.h"
+#    include "transactions.h"
+#endif
+
+#ifdef LED_GOVERNOR_MIN_SCAN_RATE
+static uint8_t  governor_level = 0;
+static uint32_t governor_scans = 0;
+static uint16_t governor_timer = 0;
+
+#    ifdef SPLIT_KEYBOARD
+// The master measures its scan rate and sends its level, so that both halves animate alike
+static uint8_t governor_split_level = 0;
+
+static bool governor_split_prepare(void) {
+    if (governor_split_level == governor_level) return false;
+    governor_split_level = governor_level;
+    return true;
+}
+
+static void governor_split_update(bool received) {
+    if (received) led_governor_set_level(governor_split_level);
+}
+
+static const split_transaction_t governor_split_transaction = {
+    .m2s_buffer = &governor_split_level,
+    .m2s_size   = sizeof(governor_split_level),
+    .interval   = 1000,  // in case the slave was reset
+    .prepare    = governor_split_prepare,
+    .update     = governor_split_update,
+};
+
+void led_governor_split_init(void) {
+    if (split_transaction_register(&governor_split_transaction) == INVALID_SPLIT_TRANSACTION) {
+        dprintf("led governor: no split transaction left, the slave keeps its LEDs at level 0\n");
+    }
+}
+#    endif
+
+uint8_t led_governor_get_level(void) { return governor_level; }
+
+void led_governor_set_level(uint8_t level) {
+    if (level > LED_GOVERNOR_MAX_LEVEL) level = LED_GOVERNOR_MAX_LEVEL;
+    governor_level = level;
+}
+
+uint8_t led_governor_process_limit(uint8_t limit) {
+    limit /= LED_GOVERNOR_PROCESS_DIVISOR();
+    return limit ? limit : 1;
+}
+
+uint16_t led_governor_frame_interval(uint16_t interval) { return interval * LED_GOVERNOR_INTERVAL_MULTIPLIER(); }
+
+void led_governor_task(void) {
+#    ifdef SPLIT_KEYBOARD
+    // the slave uses the level of the master, or none if it can't be sent
+    if (!is_keyboard_master()) return;
+#    endif
+
+    governor_scans++;
+
+    uint16_t elapsed = timer_elapsed(governor_timer);
+    if (elapsed < LED_GOVERNOR_INTERVAL) return;
+
+    uint32_t scan_rate = governor_scans * 1000 / elapsed;
+    uint8_t  level     = governor_level;
+    if (scan_rate < LED_GOVERNOR_MIN_SCAN_RATE) {
+        if (level < LED_GOVERNOR_MAX_LEVEL) level++;
+    } else if (scan_rate > LED_GOVERNOR_MIN_SCAN_RATE + LED_GOVERNOR_HEADROOM) {
+        if (level > 0) level--;
+    }
+
+    if (level != governor_level) {
+        governor_level = level;
+        dprintf("led governor: %lu scans/s, level %u, 1/%u LEDs per task run, frame interval x%u\n", scan_rate, level, LED_GOVERNOR_PROCESS_DIVISOR(), LED_GOVERNOR_INTERVAL_MULTIPLIER());
+    }
+
+    governor_scans = 0;
+    governor_timer = timer_read();
+}
+#endif
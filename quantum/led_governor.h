@@ -0,0 +1,60 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* The LED governor trades animation smoothness for scan rate. Every LED_GOVERNOR_INTERVAL
+ * it measures how many matrix scans ran, and while that is below LED_GOVERNOR_MIN_SCAN_RATE
+ * it raises its level: odd levels halve the LEDs rgb_matrix renders per task run, even
+ * levels double the time between frames of rgb_matrix and rgblight. Once the scan rate is
+ * back above the floor with some headroom, the level drops one step at a time. On split
+ * keyboards, only the master measures, and its level is sent to the slave.
+ */
+#ifdef LED_GOVERNOR_MIN_SCAN_RATE
+#    ifndef LED_GOVERNOR_INTERVAL
+#        define LED_GOVERNOR_INTERVAL 250
+#    endif
+
+#    ifndef LED_GOVERNOR_MAX_LEVEL
+#        define LED_GOVERNOR_MAX_LEVEL 6
+#    endif
+
+// Scans per second above the floor before the governor relaxes, so it does not flip between two levels
+#    ifndef LED_GOVERNOR_HEADROOM
+#        define LED_GOVERNOR_HEADROOM (LED_GOVERNOR_MIN_SCAN_RATE / 4)
+#    endif
+
+void    led_governor_task(void);
+uint8_t led_governor_get_level(void);
+void    led_governor_set_level(uint8_t level);
+
+// Divisor of the LEDs processed per task run, and multiplier of the frame interval
+#    define LED_GOVERNOR_PROCESS_DIVISOR() (1 << ((led_governor_get_level() + 1) / 2))
+#    define LED_GOVERNOR_INTERVAL_MULTIPLIER() (1 << (led_governor_get_level() / 2))
+
+uint8_t  led_governor_process_limit(uint8_t limit);
+uint16_t led_governor_frame_interval(uint16_t interval);
+
+// Registers the split transaction that sends the level of the master to the slave
+void led_governor_split_init(void);
+#else
+#    define led_governor_task()
+#    define led_governor_split_init()
+#    define led_governor_process_limit(limit) (limit)
+#    define led_governor_frame_interval(interval) (interval)
+#endif
@@ -223,6 +223,7 @@ uint8_t matrix_scan(void) {
 #endif
 
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    matrix_update_dirty_rows(0, MATRIX_ROWS, changed);
 
     matrix_scan_quantum();
     return (uint8_t)changed;
@@ -32,6 +32,9 @@ typedef uint32_t matrix_row_t;
 
 #define MATRIX_ROW_SHIFTER ((matrix_row_t)1)
 
+/* size of a dirty row bitmap, one bit per row */
+#define MATRIX_DIRTY_ROWS_SIZE ((MATRIX_ROWS + 7) / 8)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +55,12 @@ bool matrix_is_modified(void) __attribute__((deprecated));
 bool matrix_is_on(uint8_t row, uint8_t col);
 /* matrix state on row */
 matrix_row_t matrix_get_row(uint8_t row);
+/* rows changed since the last call, returns false when changes aren't tracked and every row has to be checked */
+bool matrix_get_dirty_rows(uint8_t dirty_rows[]);
+/* compare debounced rows against the last published state and mark the ones that changed */
+void matrix_update_dirty_rows(uint8_t first_row, uint8_t num_rows, bool changed);
+/* timer_read() of when the debounced row last changed, as marked by matrix_update_dirty_rows(), 0 when not tracked */
+uint16_t matrix_get_row_change_time(uint8_t row);
 /* print matrix for debug */
 void matrix_print(void);
 /* delay between changing matrix pin state and reading values */
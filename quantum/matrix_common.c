@@ -17,6 +17,13 @@ matrix_row_t matrix[MATRIX_ROWS];
 extern const matrix_row_t matrix_mask[];
 #endif
 
+/* debounced state as last seen by matrix_update_dirty_rows() */
+static matrix_row_t matrix_published[MATRIX_ROWS];
+static uint8_t      matrix_dirty_rows[MATRIX_DIRTY_ROWS_SIZE];
+static uint16_t     matrix_row_change_time[MATRIX_ROWS];  // when each row was last seen changing, never 0
+static bool         matrix_dirty_rows_tracked = false;
+static bool         matrix_debounce_pending   = false;
+
 // user-defined overridable functions
 
 __attribute__((weak)) void matrix_init_kb(void) { matrix_init_user(); }
@@ -45,6 +52,37 @@ inline matrix_row_t matrix_get_row(uint8_t row) {
 #endif
 }
 
+void matrix_update_dirty_rows(uint8_t first_row, uint8_t num_rows, bool changed) {
+    bool debounce_was_pending = matrix_debounce_pending;
+    matrix_dirty_rows_tracked = true;
+    matrix_debounce_pending   = debounce_active();
+
+    // raw input is unchanged and nothing was waiting in the debouncer, so the debounced state can't have moved
+    if (!changed && !debounce_was_pending) return;
+
+    uint16_t now = timer_read() | 1;
+    for (uint8_t row = first_row; row < first_row + num_rows; row++) {
+        if (matrix[row] != matrix_published[row]) {
+            matrix_published[row]       = matrix[row];
+            matrix_row_change_time[row] = now;
+            matrix_dirty_rows[row / 8] |= 1 << (row % 8);
+        }
+    }
+}
+
+bool matrix_get_dirty_rows(uint8_t dirty_rows[]) {
+    // a keyboard overriding matrix_scan() without publishing its changes has to be scanned in full
+    if (!matrix_dirty_rows_tracked) return false;
+
+    for (uint8_t i = 0; i < MATRIX_DIRTY_ROWS_SIZE; i++) {
+        dirty_rows[i]        = matrix_dirty_rows[i];
+        matrix_dirty_rows[i] = 0;
+    }
+    return true;
+}
+
+uint16_t matrix_get_row_change_time(uint8_t row) { return matrix_row_change_time[row]; }
+
 // Deprecated.
 bool matrix_is_modified(void) {
     if (debounce_active()) return false;
@@ -113,6 +151,7 @@ __attribute__((weak)) uint8_t matrix_scan(void) {
     bool changed = matrix_scan_custom(raw_matrix);
 
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    matrix_update_dirty_rows(0, MATRIX_ROWS, changed);
 
     matrix_scan_quantum();
     return changed;
@@ -21,9 +21,10 @@
 
 #    include "process_auto_shift.h"
 
-static uint16_t autoshift_time    = 0;
-static uint16_t autoshift_timeout = AUTO_SHIFT_TIMEOUT;
-static uint16_t autoshift_lastkey = KC_NO;
+static uint16_t       autoshift_time          = 0;
+static uint16_t       autoshift_timeout       = AUTO_SHIFT_TIMEOUT;
+static uint16_t       autoshift_lastkey       = KC_NO;
+static deferred_token autoshift_timeout_token = INVALID_DEFERRED_TOKEN;
 static struct {
     // Whether autoshift is enabled.
     bool enabled : 1;
@@ -36,6 +37,8 @@ static struct {
     bool holding_shift : 1;
 } autoshift_flags = {true, false, false, false};
 
+static uint32_t autoshift_timeout_callback(uint32_t trigger_time, void *cb_arg);
+
 /** \brief Record the press of an autoshiftable key
  *
  *  \return Whether the record should be further processed.
@@ -76,6 +79,11 @@ static bool autoshift_press(uint16_t keycode, uint16_t now, keyrecord_t *record)
     autoshift_time              = now;
     autoshift_flags.in_progress = true;
 
+    // Send the shifted key as soon as the timeout expires, rather than on release.
+    if (!extend_deferred_exec(autoshift_timeout_token, autoshift_timeout)) {
+        autoshift_timeout_token = defer_exec(autoshift_timeout, autoshift_timeout_callback, NULL);
+    }
+
 #    if !defined(NO_ACTION_ONESHOT) && !defined(NO_ACTION_TAPPING)
     clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
 #    endif
@@ -94,6 +102,8 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
     if (autoshift_flags.in_progress) {
         // Process the auto-shiftable key.
         autoshift_flags.in_progress = false;
+        cancel_deferred_exec(autoshift_timeout_token);
+        autoshift_timeout_token = INVALID_DEFERRED_TOKEN;
 
         // Time since the initial press was recorded.
         const uint16_t elapsed = TIMER_DIFF_16(now, autoshift_time);
@@ -133,11 +143,22 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
     autoshift_time = now;
 }
 
+static uint32_t autoshift_timeout_callback(uint32_t trigger_time, void *cb_arg) {
+    autoshift_matrix_scan();
+    if (autoshift_flags.in_progress) {
+        // The timeout was raised after the key was pressed.
+        return 1;
+    }
+    autoshift_timeout_token = INVALID_DEFERRED_TOKEN;
+    return 0;
+}
+
 /** \brief Simulates auto-shifted key releases when timeout is hit
  *
- *  Can be called from \c matrix_scan_user so that auto-shifted keys are sent
- *  immediately after the timeout has expired, rather than waiting for the key
- *  to be released.
+ *  This is scheduled whenever an auto-shiftable key is pressed, so that
+ *  auto-shifted keys are sent immediately after the timeout has expired,
+ *  rather than waiting for the key to be released. Calling it from
+ *  \c matrix_scan_user is still supported, but no longer needed.
  */
 void autoshift_matrix_scan(void) {
     if (autoshift_flags.in_progress) {
@@ -149,6 +170,16 @@ void autoshift_matrix_scan(void) {
     }
 }
 
+/** \brief Polls the timeout when no deferred callback could be scheduled for it
+ *
+ *  Called from \c matrix_scan_quantum.
+ */
+void matrix_scan_auto_shift(void) {
+    if (autoshift_timeout_token == INVALID_DEFERRED_TOKEN) {
+        autoshift_matrix_scan();
+    }
+}
+
 void autoshift_toggle(void) {
     autoshift_flags.enabled = !autoshift_flags.enabled;
     del_weak_mods(MOD_BIT(KC_LSFT));
@@ -16,6 +16,9 @@
 
 #include "print.h"
 #include "process_combo.h"
+#ifndef COMBO_NO_INDEX
+#    include <stdlib.h>
+#endif
 
 #ifndef COMBO_VARIABLE_LEN
 __attribute__((weak)) combo_t key_combos[COMBO_COUNT] = {};
@@ -26,11 +29,16 @@ extern int      COMBO_LEN;
 
 __attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
 
-static uint16_t timer               = 0;
-static uint16_t current_combo_index = 0;
-static bool     drop_buffer         = false;
-static bool     is_active           = false;
-static bool     b_combo_enable      = true;  // defaults to enabled
+static deferred_token timeout             = INVALID_DEFERRED_TOKEN;
+static uint16_t       timer               = 0;
+static bool           timer_polled        = false;  // the timeout couldn't be scheduled, and is polled from the matrix scan
+static uint16_t       current_combo_index = 0;
+static bool           drop_buffer         = false;
+static bool           is_active           = false;
+static bool           b_combo_enable      = true;  // defaults to enabled
+
+/* number of combos with at least one of their keys held down */
+static uint16_t combos_with_keys_down = 0;
 
 static uint8_t buffer_size = 0;
 #ifdef COMBO_ALLOW_ACTION_KEYS
@@ -39,6 +47,100 @@ static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
 static uint16_t key_buffer[MAX_COMBO_LENGTH];
 #endif
 
+static inline uint16_t combo_count(void) {
+#ifndef COMBO_VARIABLE_LEN
+    return COMBO_COUNT;
+#else
+    return COMBO_LEN;
+#endif
+}
+
+#ifndef COMBO_NO_INDEX
+/* Every (keycode, combo) pair, sorted by keycode, so that a key event only visits the combos that
+ * contain its key instead of every combo in key_combos. Built on first use, as combos are defined in
+ * keymap code and may be sized at runtime with COMBO_VARIABLE_LEN.
+ */
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo_index;
+} combo_index_entry_t;
+
+static combo_index_entry_t *combo_index       = NULL;
+static uint16_t             combo_index_size  = 0;
+static bool                 combo_index_ready = false;
+
+static int compare_combo_index_entries(const void *a, const void *b) {
+    const combo_index_entry_t *x = a;
+    const combo_index_entry_t *y = b;
+    if (x->keycode != y->keycode) return x->keycode < y->keycode ? -1 : 1;
+    if (x->combo_index != y->combo_index) return x->combo_index < y->combo_index ? -1 : 1;
+    return 0;
+}
+
+static void build_combo_index(void) {
+    uint16_t combos = combo_count();
+    uint32_t size   = 0;
+
+    combo_index_ready = true;
+    for (uint16_t i = 0; i < combos; i++) {
+        uint8_t count = 0;
+        while (COMBO_END != pgm_read_word(&key_combos[i].keys[count])) count++;
+        if (count <= MAX_COMBO_LENGTH) size += count;
+    }
+    if (size == 0 || size > UINT16_MAX) return;
+
+    combo_index = malloc(size * sizeof(combo_index_entry_t));
+    if (!combo_index) return;  // keep going with the linear scan
+
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < combos; i++) {
+        uint8_t count = 0;
+        while (COMBO_END != pgm_read_word(&key_combos[i].keys[count])) count++;
+        if (count > MAX_COMBO_LENGTH) continue;
+        for (uint8_t k = 0; k < count; k++) {
+            combo_index[n].keycode     = pgm_read_word(&key_combos[i].keys[k]);
+            combo_index[n].combo_index = i;
+            n++;
+        }
+    }
+    qsort(combo_index, n, sizeof(combo_index_entry_t), compare_combo_index_entries);
+
+    /* a combo listing the same key twice only needs to be visited once */
+    combo_index_size = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        if (combo_index_size && 0 == compare_combo_index_entries(&combo_index[combo_index_size - 1], &combo_index[i])) continue;
+        combo_index[combo_index_size++] = combo_index[i];
+    }
+}
+
+/* first entry of keycode, or combo_index_size if no combo contains it */
+static uint16_t combo_index_find(uint16_t keycode) {
+    uint16_t low = 0, high = combo_index_size;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_index[mid].keycode < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+#endif
+
+void combo_rebuild_index(void) {
+#ifndef COMBO_NO_INDEX
+    free(combo_index);
+    combo_index       = NULL;
+    combo_index_size  = 0;
+    combo_index_ready = false;
+#endif
+    combos_with_keys_down = 0;
+    for (uint16_t i = 0; i < combo_count(); i++) {
+        if (key_combos[i].state) combos_with_keys_down++;
+    }
+}
+
 static inline void send_combo(uint16_t action, bool pressed) {
     if (action) {
         if (pressed) {
@@ -71,16 +173,48 @@ static inline void dump_key_buffer(bool emit) {
     buffer_size = 0;
 }
 
-#define ALL_COMBO_KEYS_ARE_DOWN (((1 << count) - 1) == combo->state)
-#define KEY_STATE_DOWN(key)         \
-    do {                            \
-        combo->state |= (1 << key); \
+static uint32_t combo_timeout(uint32_t trigger_time, void *cb_arg) {
+    timeout      = INVALID_DEFERRED_TOKEN;
+    timer_polled = false;
+    if (b_combo_enable && is_active) {
+        /* This disables the combo, meaning key events for this
+         * combo will be handled by the next processors in the chain
+         */
+        is_active = false;
+        dump_key_buffer(true);
+    }
+    return 0;
+}
+
+static void restart_combo_timer(void) {
+    if (!extend_deferred_exec(timeout, COMBO_TERM + 1)) {
+        timeout = defer_exec(COMBO_TERM + 1, combo_timeout, NULL);
+    }
+    timer        = timer_read();
+    timer_polled = timeout == INVALID_DEFERRED_TOKEN;
+}
+
+static void stop_combo_timer(void) {
+    cancel_deferred_exec(timeout);
+    timeout      = INVALID_DEFERRED_TOKEN;
+    timer_polled = false;
+}
+
+#define ALL_COMBO_KEYS_ARE_DOWN (all_keys_down_state(count) == combo->state)
+#define KEY_STATE_DOWN(key)                        \
+    do {                                           \
+        combo->state |= ((combo_state_t)1 << key); \
     } while (0)
-#define KEY_STATE_UP(key)            \
-    do {                             \
-        combo->state &= ~(1 << key); \
+#define KEY_STATE_UP(key)                           \
+    do {                                            \
+        combo->state &= ~((combo_state_t)1 << key); \
     } while (0)
 
+static inline combo_state_t all_keys_down_state(uint8_t count) {
+    /* shifting by the full width of the state is undefined */
+    return count ? (combo_state_t)~(combo_state_t)0 >> (sizeof(combo_state_t) * 8 - count) : 0;
+}
+
 static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) {
     uint8_t  count = 0;
     uint16_t index = -1;
@@ -92,9 +226,10 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
     }
 
     /* Continue processing if not a combo key */
-    if (-1 == (int8_t)index) return false;
+    if (-1 == (int8_t)index || count > MAX_COMBO_LENGTH) return false;
 
-    bool is_combo_active = is_active;
+    bool          is_combo_active = is_active;
+    combo_state_t previous_state  = combo->state;
 
     if (record->event.pressed) {
         KEY_STATE_DOWN(index);
@@ -116,15 +251,18 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         KEY_STATE_UP(index);
     }
 
+    if (!previous_state && combo->state) {
+        combos_with_keys_down++;
+    } else if (previous_state && !combo->state) {
+        combos_with_keys_down--;
+    }
+
     return is_combo_active;
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == combo->state)
-
 bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    drop_buffer                = false;
-    bool no_combo_keys_pressed = true;
+    bool is_combo_key = false;
+    drop_buffer       = false;
 
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
@@ -144,33 +282,42 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (!is_combo_enabled()) {
         return true;
     }
-#ifndef COMBO_VARIABLE_LEN
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-#else
-    for (current_combo_index = 0; current_combo_index < COMBO_LEN; ++current_combo_index) {
+
+#ifndef COMBO_NO_INDEX
+    if (!combo_index_ready) {
+        build_combo_index();
+    }
+    if (combo_index) {
+        for (uint16_t i = combo_index_find(keycode); i < combo_index_size && combo_index[i].keycode == keycode; i++) {
+            current_combo_index = combo_index[i].combo_index;
+            is_combo_key |= process_single_combo(&key_combos[current_combo_index], keycode, record);
+        }
+    } else
 #endif
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-        no_combo_keys_pressed = no_combo_keys_pressed && NO_COMBO_KEYS_ARE_DOWN;
+    {
+        for (current_combo_index = 0; current_combo_index < combo_count(); ++current_combo_index) {
+            combo_t *combo = &key_combos[current_combo_index];
+            is_combo_key |= process_single_combo(combo, keycode, record);
+        }
     }
 
     if (drop_buffer) {
         /* buffer is only dropped when we complete a combo, so we refresh the timer
          * here */
-        timer = timer_read();
+        restart_combo_timer();
         dump_key_buffer(false);
     } else if (!is_combo_key) {
         /* if no combos claim the key we need to emit the keybuffer */
         dump_key_buffer(true);
 
         // reset state if there are no combo keys pressed at all
-        if (no_combo_keys_pressed) {
-            timer     = 0;
+        if (!combos_with_keys_down) {
+            stop_combo_timer();
             is_active = true;
         }
     } else if (record->event.pressed && is_active) {
         /* otherwise the key is consumed and placed in the buffer */
-        timer = timer_read();
+        restart_combo_timer();
 
         if (buffer_size < MAX_COMBO_LENGTH) {
 #ifdef COMBO_ALLOW_ACTION_KEYS
@@ -185,12 +332,8 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
 }
 
 void matrix_scan_combo(void) {
-    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
-        /* This disables the combo, meaning key events for this
-         * combo will be handled by the next processors in the chain
-         */
-        is_active = false;
-        dump_key_buffer(true);
+    if (timer_polled && timer_elapsed(timer) > COMBO_TERM) {
+        combo_timeout(timer, NULL);
     }
 }
 
@@ -198,7 +341,7 @@ void combo_enable(void) { b_combo_enable = true; }
 
 void combo_disable(void) {
     b_combo_enable = is_active = false;
-    timer                      = 0;
+    stop_combo_timer();
     dump_key_buffer(true);
 }
 
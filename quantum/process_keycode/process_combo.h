@@ -20,24 +20,31 @@
 #include "quantum.h"
 #include <stdint.h>
 
-#ifdef EXTRA_EXTRA_LONG_COMBOS
-#    define MAX_COMBO_LENGTH 32
-#elif EXTRA_LONG_COMBOS
-#    define MAX_COMBO_LENGTH 16
+#ifndef MAX_COMBO_LENGTH
+#    ifdef EXTRA_EXTRA_LONG_COMBOS
+#        define MAX_COMBO_LENGTH 32
+#    elif defined(EXTRA_LONG_COMBOS)
+#        define MAX_COMBO_LENGTH 16
+#    else
+#        define MAX_COMBO_LENGTH 8
+#    endif
+#endif
+
+/* one bit per key of a combo */
+#if MAX_COMBO_LENGTH <= 8
+typedef uint8_t combo_state_t;
+#elif MAX_COMBO_LENGTH <= 16
+typedef uint16_t combo_state_t;
+#elif MAX_COMBO_LENGTH <= 32
+typedef uint32_t combo_state_t;
 #else
-#    define MAX_COMBO_LENGTH 8
+#    error MAX_COMBO_LENGTH must be 32 or less
 #endif
 
 typedef struct {
     const uint16_t *keys;
     uint16_t        keycode;
-#ifdef EXTRA_EXTRA_LONG_COMBOS
-    uint32_t state;
-#elif EXTRA_LONG_COMBOS
-    uint16_t state;
-#else
-    uint8_t state;
-#endif
+    combo_state_t   state;
 } combo_t;
 
 #define COMBO(ck, ca) \
@@ -57,6 +64,8 @@ bool process_combo(uint16_t keycode, keyrecord_t *record);
 void matrix_scan_combo(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
 
+void combo_rebuild_index(void);
+
 void combo_enable(void);
 void combo_disable(void);
 void combo_toggle(void);
@@ -51,7 +51,7 @@ static void __attribute__((noinline, unused)) handleKeycodeRGBMode(const uint8_t
 /**
  * Handle keycodes for both rgblight and rgbmatrix
  */
-bool process_rgb(const uint16_t keycode, const keyrecord_t *record) {
+bool process_rgb(const uint16_t keycode, keyrecord_t *record) {
 #ifndef SPLIT_KEYBOARD
     if (record->event.pressed) {
 #else
@@ -21,6 +21,8 @@ uint8_t get_oneshot_mods(void);
 
 static uint16_t last_td;
 static int8_t   highest_td = -1;
+// set when a timeout couldn't be scheduled, the dances without one are then polled from the matrix scan
+static bool tap_dance_polling = false;
 
 void qk_tap_dance_pair_on_each_tap(qk_tap_dance_state_t *state, void *user_data) {
     qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -102,6 +104,28 @@ static inline void process_tap_dance_action_on_reset(qk_tap_dance_action_t *acti
     send_keyboard_report();
 }
 
+static uint16_t tap_dance_tapping_term(qk_tap_dance_action_t *action) {
+    if (action->custom_tapping_term > 0) {
+        return action->custom_tapping_term;
+    }
+#ifdef TAPPING_TERM_PER_KEY
+    return get_tapping_term(action->state.keycode, NULL);
+#else
+    return TAPPING_TERM;
+#endif
+}
+
+static uint32_t tap_dance_timeout(uint32_t trigger_time, void *cb_arg) {
+    qk_tap_dance_action_t *action = (qk_tap_dance_action_t *)cb_arg;
+
+    action->timeout = INVALID_DEFERRED_TOKEN;
+    if (action->state.count) {
+        process_tap_dance_action_on_dance_finished(action);
+        reset_tap_dance(&action->state);
+    }
+    return 0;
+}
+
 void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
     qk_tap_dance_action_t *action;
 
@@ -145,6 +169,14 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
                 process_tap_dance_action_on_each_tap(action);
 
                 last_td = keycode;
+
+                // the dance finishes once no other tap follows within the tapping term
+                if (!extend_deferred_exec(action->timeout, tap_dance_tapping_term(action) + 1)) {
+                    action->timeout = defer_exec(tap_dance_tapping_term(action) + 1, tap_dance_timeout, action);
+                    if (action->timeout == INVALID_DEFERRED_TOKEN) {
+                        tap_dance_polling = true;
+                    }
+                }
             } else {
                 if (action->state.count && action->state.finished) {
                     reset_tap_dance(&action->state);
@@ -157,24 +189,19 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
-void matrix_scan_tap_dance() {
-    if (highest_td == -1) return;
-    uint16_t tap_user_defined;
+void matrix_scan_tap_dance(void) {
+    if (!tap_dance_polling) return;
+    tap_dance_polling = false;
 
     for (uint8_t i = 0; i <= highest_td; i++) {
         qk_tap_dance_action_t *action = &tap_dance_actions[i];
-        if (action->custom_tapping_term > 0) {
-            tap_user_defined = action->custom_tapping_term;
-        } else {
-#ifdef TAPPING_TERM_PER_KEY
-            tap_user_defined = get_tapping_term(action->state.keycode, NULL);
-#else
-            tap_user_defined = TAPPING_TERM;
-#endif
-        }
-        if (action->state.count && timer_elapsed(action->state.timer) > tap_user_defined) {
+        if (!action->state.count || action->state.finished || action->timeout != INVALID_DEFERRED_TOKEN) continue;
+
+        if (timer_elapsed(action->state.timer) > tap_dance_tapping_term(action)) {
             process_tap_dance_action_on_dance_finished(action);
             reset_tap_dance(&action->state);
+        } else {
+            tap_dance_polling = true;
         }
     }
 }
@@ -187,6 +214,8 @@ void reset_tap_dance(qk_tap_dance_state_t *state) {
     action = &tap_dance_actions[state->keycode - QK_TAP_DANCE];
 
     process_tap_dance_action_on_reset(action);
+    cancel_deferred_exec(action->timeout);
+    action->timeout = INVALID_DEFERRED_TOKEN;
 
     state->count                = 0;
     state->interrupted          = false;
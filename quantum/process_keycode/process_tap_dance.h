@@ -20,6 +20,7 @@
 
 #    include <stdbool.h>
 #    include <inttypes.h>
+#    include "deferred_exec.h"
 
 typedef struct {
     uint8_t  count;
@@ -46,6 +47,7 @@ typedef struct {
     qk_tap_dance_state_t state;
     uint16_t             custom_tapping_term;
     void *               user_data;
+    deferred_token       timeout;
 } qk_tap_dance_action_t;
 
 typedef struct {
@@ -20,9 +20,7 @@
 
 bool process_unicode(uint16_t keycode, keyrecord_t *record) {
     if (keycode >= QK_UNICODE && keycode <= QK_UNICODE_MAX && record->event.pressed) {
-        unicode_input_start();
-        register_hex(keycode & 0x7FFF);
-        unicode_input_finish();
+        register_unicode(keycode & 0x7FFF);
     }
     return true;
 }
@@ -16,11 +16,11 @@
 
 #include "process_unicode_common.h"
 #include "eeprom.h"
-#include <ctype.h>
+#include "eeconfig.h"
+#include <stdlib.h>
 #include <string.h>
 
 unicode_config_t unicode_config;
-uint8_t          unicode_saved_mods;
 bool             unicode_saved_caps_lock;
 
 #if UNICODE_SELECTED_MODES != -1
@@ -30,7 +30,9 @@ static int8_t  selected_index;
 #endif
 
 void unicode_input_mode_init(void) {
-    unicode_config.raw = eeprom_read_byte(EECONFIG_UNICODEMODE);
+    uint8_t input_mode;
+    eeconfig_read_deferred(&input_mode, EECONFIG_UNICODEMODE, sizeof(input_mode));
+    unicode_config.raw = input_mode;
 #if UNICODE_SELECTED_MODES != -1
 #    if UNICODE_CYCLE_PERSIST
     // Find input_mode in selected modes
@@ -75,9 +77,40 @@ void cycle_unicode_input_mode(int8_t offset) {
 #endif
 }
 
-void persist_unicode_input_mode(void) { eeprom_update_byte(EECONFIG_UNICODEMODE, unicode_config.input_mode); }
+void persist_unicode_input_mode(void) {
+    uint8_t input_mode = unicode_config.input_mode;
+    eeconfig_update_deferred(EECONFIG_UNICODEMODE, &input_mode, sizeof(input_mode));
+}
 
-__attribute__((weak)) void unicode_input_start(void) {
+// Adds a press or a release of a keycode to the steps of send_string, modifiers as weak mods
+static void add_key_step(uint16_t keycode, bool down) {
+    uint8_t mods = (keycode >> 8) & 0xF;
+    uint8_t key  = keycode & 0xFF;
+    if (keycode & QK_RMODS_MIN) {
+        mods <<= 4;
+    }
+    if (IS_MOD(key)) {
+        mods |= MOD_BIT(key);
+        key = KC_NO;
+    }
+
+    if (down && mods) {
+        send_string_add_step(SEND_STRING_MODS_DOWN, mods);
+    }
+    if (key) {
+        send_string_add_step(down ? SEND_STRING_KEY_DOWN : SEND_STRING_KEY_UP, key);
+    }
+    if (!down && mods) {
+        send_string_add_step(SEND_STRING_MODS_UP, mods);
+    }
+}
+
+static void add_tap_steps(uint16_t keycode) {
+    add_key_step(keycode, true);
+    add_key_step(keycode, false);
+}
+
+static void add_start_steps(void) {
     unicode_saved_caps_lock = host_keyboard_led_state().caps_lock;
 
     // Note the order matters here!
@@ -85,74 +118,101 @@ __attribute__((weak)) void unicode_input_start(void) {
     // UNICODE_KEY_LNX (which is usually Ctrl-Shift-U) might not work
     // correctly in the shifted case.
     if (unicode_config.input_mode == UC_LNX && unicode_saved_caps_lock) {
-        tap_code(KC_CAPS);
+        add_tap_steps(KC_CAPS);
     }
 
-    unicode_saved_mods = get_mods();  // Save current mods
-    clear_mods();                     // Unregister mods to start from a clean state
+    // Leave the held mods out of the reports to start from a clean state
+    send_string_add_step(SEND_STRING_SUPPRESS_MODS, true);
 
     switch (unicode_config.input_mode) {
         case UC_MAC:
-            register_code(UNICODE_KEY_MAC);
+            add_key_step(UNICODE_KEY_MAC, true);
             break;
         case UC_LNX:
-            tap_code16(UNICODE_KEY_LNX);
+            add_tap_steps(UNICODE_KEY_LNX);
             break;
         case UC_WIN:
-            register_code(KC_LALT);
-            tap_code(KC_PPLS);
+            add_key_step(KC_LALT, true);
+            add_tap_steps(KC_PPLS);
             break;
         case UC_WINC:
-            tap_code(UNICODE_KEY_WINC);
-            tap_code(KC_U);
+            add_tap_steps(UNICODE_KEY_WINC);
+            add_tap_steps(KC_U);
             break;
     }
-
-    wait_ms(UNICODE_TYPE_DELAY);
 }
 
-__attribute__((weak)) void unicode_input_finish(void) {
+static void add_end_steps(bool cancel) {
     switch (unicode_config.input_mode) {
         case UC_MAC:
-            unregister_code(UNICODE_KEY_MAC);
+            add_key_step(UNICODE_KEY_MAC, false);
             break;
         case UC_LNX:
-            tap_code(KC_SPC);
+            add_tap_steps(cancel ? KC_ESC : KC_SPC);
             if (unicode_saved_caps_lock) {
-                tap_code(KC_CAPS);
+                add_tap_steps(KC_CAPS);
             }
             break;
         case UC_WIN:
-            unregister_code(KC_LALT);
+            add_key_step(KC_LALT, false);
             break;
         case UC_WINC:
-            tap_code(KC_ENTER);
+            add_tap_steps(cancel ? KC_ESC : KC_ENTER);
             break;
     }
 
-    set_mods(unicode_saved_mods);  // Reregister previously set mods
+    send_string_add_step(SEND_STRING_SUPPRESS_MODS, false);  // Reregister previously held mods
+}
+
+__attribute__((weak)) void unicode_input_start(void) {
+    // what send_string_async() queued is typed first, with the mods it expects
+    send_string_flush();
+    add_start_steps();
+    send_string_flush();
+    wait_ms(UNICODE_TYPE_DELAY);
+}
+
+__attribute__((weak)) void unicode_input_finish(void) {
+    add_end_steps(false);
+    send_string_flush();
 }
 
 __attribute__((weak)) void unicode_input_cancel(void) {
-    switch (unicode_config.input_mode) {
-        case UC_MAC:
-            unregister_code(UNICODE_KEY_MAC);
-            break;
-        case UC_LNX:
-            tap_code(KC_ESC);
-            if (unicode_saved_caps_lock) {
-                tap_code(KC_CAPS);
-            }
-            break;
-        case UC_WINC:
-            tap_code(KC_ESC);
-            break;
-        case UC_WIN:
-            unregister_code(KC_LALT);
-            break;
+    add_end_steps(true);
+    send_string_flush();
+}
+
+/** \brief Adds a part of the input sequence of a code point to the steps of send_string
+ *
+ * Called by send_string_task() for a code point of send_unicode_async(), part after part:
+ * the start of the input, the delay, each hex digit, then the finish. Returns false once
+ * the sequence is complete.
+ */
+bool unicode_input_add_steps(uint32_t code_point, uint8_t part) {
+    // the digits register_hex32() types, four of each half of the surrogate pair on macOS
+    uint8_t digits = 8;
+    if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
+        code_point -= 0x10000;
+        code_point = (((code_point & 0xFFC00) >> 10) + 0xD800) << 16 | ((code_point & 0x3FF) + 0xDC00);
+    } else {
+        while (digits > 4 && !(code_point >> ((digits - 1) * 4))) {
+            digits--;
+        }
     }
 
-    set_mods(unicode_saved_mods);  // Reregister previously set mods
+    if (part == 0) {
+        add_start_steps();
+    } else if (part == 1) {
+        send_string_add_delay(UNICODE_TYPE_DELAY);
+    } else if (part < 2 + digits) {
+        uint8_t digit = (code_point >> ((digits - 1 - (part - 2)) * 4)) & 0xF;
+        send_string_add_char_steps(digit < 10 ? digit + '0' : digit - 10 + 'a');
+    } else if (part == 2 + digits) {
+        add_end_steps(false);
+    } else {
+        return false;
+    }
+    return true;
 }
 
 void register_hex(uint16_t hex) {
@@ -186,21 +246,13 @@ void register_unicode(uint32_t code_point) {
         return;
     }
 
-    unicode_input_start();
-    if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
-        // Convert code point to UTF-16 surrogate pair on macOS
-        code_point -= 0x10000;
-        uint32_t lo = code_point & 0x3FF, hi = (code_point & 0xFFC00) >> 10;
-        register_hex32(hi + 0xD800);
-        register_hex32(lo + 0xDC00);
-    } else {
-        register_hex32(code_point);
+    // Queued after what send_string_async() queued, the whole sequence is typed from the main loop
+    if (!send_unicode_async(code_point)) {
+        send_string_flush();
+        send_unicode_async(code_point);
     }
-    unicode_input_finish();
 }
 
-// clang-format off
-
 void send_unicode_hex_string(const char *str) {
     if (!str) {
         return;
@@ -208,28 +260,18 @@ void send_unicode_hex_string(const char *str) {
 
     while (*str) {
         // Find the next code point (token) in the string
-        for (; *str == ' '; str++);    // Skip leading spaces
-        size_t n = strcspn(str, " ");  // Length of the current token
-        char code_point[n+1];
-        strncpy(code_point, str, n);   // Copy token into buffer
-        code_point[n] = '\0';          // Make sure it's null-terminated
-
-        // Normalize the code point: make all hex digits lowercase
-        for (char *p = code_point; *p; p++) {
-            *p = tolower((unsigned char)*p);
+        while (*str == ' ') {
+            str++;
+        }
+        if (!*str) {
+            break;
         }
 
-        // Send the code point as a Unicode input string
-        unicode_input_start();
-        send_string(code_point);
-        unicode_input_finish();
-
-        str += n;  // Move to the first ' ' (or '\0') after the current token
+        register_unicode(strtoul(str, NULL, 16));
+        str += strcspn(str, " ");  // Move to the first ' ' (or '\0') after the current token
     }
 }
 
-// clang-format on
-
 // Borrowed from https://nullprogram.com/blog/2017/10/06/
 static const char *decode_utf8(const char *str, int32_t *code_point) {
     const char *next;
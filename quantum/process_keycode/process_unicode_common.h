@@ -85,6 +85,7 @@ void    persist_unicode_input_mode(void);
 void unicode_input_start(void);
 void unicode_input_finish(void);
 void unicode_input_cancel(void);
+bool unicode_input_add_steps(uint32_t code_point, uint8_t part);
 
 void register_hex(uint16_t hex);
 void register_hex32(uint32_t hex);
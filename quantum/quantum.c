@@ -83,6 +83,8 @@ static void do_code16(uint16_t code, void (*f)(uint8_t)) {
 }
 
 void register_code16(uint16_t code) {
+    // what send_string_async() queued is typed first, before the mods change
+    send_string_flush();
     if (IS_MOD(code) || code == KC_NO) {
         do_code16(code, register_mods);
     } else {
@@ -92,6 +94,7 @@ void register_code16(uint16_t code) {
 }
 
 void unregister_code16(uint16_t code) {
+    send_string_flush();
     unregister_code(code);
     if (IS_MOD(code) || code == KC_NO) {
         do_code16(code, unregister_mods);
@@ -139,6 +142,7 @@ void reset_keyboard(void) {
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
 #endif
+    eeconfig_flush();
     bootloader_jump();
 }
 
@@ -175,112 +179,154 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
-/* Core keycode function, hands off handling to other functions,
-    then processes internal quantum keycodes, and then processes
-    ACTIONs.                                                      */
-bool process_record_quantum(keyrecord_t *record) {
-    uint16_t keycode = get_record_keycode(record, true);
+typedef bool (*process_handler_func_t)(uint16_t keycode, keyrecord_t *record);
 
-    // This is how you use actions here
-    // if (keycode == KC_LEAD) {
-    //   action_t action;
-    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
-    //   process_action(record, action);
-    //   return false;
-    // }
-
-#ifdef VELOCIKEY_ENABLE
-    if (velocikey_enabled() && record->event.pressed) {
-        velocikey_accelerate();
-    }
-#endif
-
-#ifdef WPM_ENABLE
-    if (record->event.pressed) {
-        update_wpm(keycode);
-    }
-#endif
+typedef struct {
+    uint16_t               first;
+    uint16_t               last;
+    process_handler_func_t process;
+} process_handler_t;
 
-#ifdef TAP_DANCE_ENABLE
-    preprocess_tap_dance(keycode, record);
-#endif
+#define PROCESS_KEYCODES(first, last, process) \
+    { first, last, process }
+#define PROCESS_ALL_KEYCODES(process) PROCESS_KEYCODES(QK_BASIC, 0xFFFF, process)
 
-    if (!(
-#if defined(KEY_LOCK_ENABLE)
-            // Must run first to be able to mask key_up events.
-            process_key_lock(&keycode, record) &&
-#endif
+/* The process_* handlers of process_record_quantum(), in the order they run.
+ *
+ * A handler is only called for the keycodes it acts on, so a basic keycode skips
+ * every handler that is not watching all the keys. The order is the order of the
+ * chain of calls this replaces and must be kept: the first handler to return false
+ * hides the key from the ones after it. A handler with several ranges takes
+ * several adjacent entries.
+ */
+static const process_handler_t PROGMEM process_handlers[] = {
 #if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
-            // Must run asap to ensure all keypresses are recorded.
-            process_dynamic_macro(keycode, record) &&
+    // Must run asap to ensure all keypresses are recorded.
+    PROCESS_ALL_KEYCODES(process_dynamic_macro),
 #endif
 #if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
-            process_clicky(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_clicky),
 #endif  // AUDIO_CLICKY
 #ifdef HAPTIC_ENABLE
-            process_haptic(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_haptic),
 #endif  // HAPTIC_ENABLE
 #if defined(VIA_ENABLE)
-            process_record_via(keycode, record) &&
+    PROCESS_KEYCODES(FN_MO13, MACRO15, process_record_via),
 #endif
-            process_record_kb(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_record_kb),
 #if defined(SEQUENCER_ENABLE)
-            process_sequencer(keycode, record) &&
+    PROCESS_KEYCODES(SQ_ON, SEQUENCER_TRACK_MAX, process_sequencer),
 #endif
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+    PROCESS_KEYCODES(MIDI_TONE_MIN, MI_BENDU, process_midi),
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+    PROCESS_KEYCODES(AU_ON, MUV_DE, process_audio),
 #endif
 #ifdef BACKLIGHT_ENABLE
-            process_backlight(keycode, record) &&
+    PROCESS_KEYCODES(BL_ON, BL_BRTG, process_backlight),
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+    PROCESS_KEYCODES(QK_STENO, QK_STENO_MAX, process_steno),
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
-            process_music(keycode, record) &&
+    // plays the keys while music mode is on
+    PROCESS_ALL_KEYCODES(process_music),
 #endif
 #ifdef TAP_DANCE_ENABLE
-            process_tap_dance(keycode, record) &&
+    // any other key ends the tap dance
+    PROCESS_ALL_KEYCODES(process_tap_dance),
 #endif
-#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
-            process_unicode_common(keycode, record) &&
+#if defined(UCIS_ENABLE)
+    // takes the keys typed while looking up a symbol
+    PROCESS_ALL_KEYCODES(process_unicode_common),
+#elif defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE)
+    PROCESS_KEYCODES(UNICODE_MODE_FORWARD, UNICODE_MODE_WINC, process_unicode_common),
+    PROCESS_KEYCODES(QK_UNICODE, QK_UNICODE_MAX, process_unicode_common),
 #endif
 #ifdef LEADER_ENABLE
-            process_leader(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_leader),
 #endif
 #ifdef COMBO_ENABLE
-            process_combo(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_combo),
 #endif
 #ifdef PRINTING_ENABLE
-            process_printer(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_printer),
 #endif
 #ifdef AUTO_SHIFT_ENABLE
-            process_auto_shift(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_auto_shift),
 #endif
 #ifdef TERMINAL_ENABLE
-            process_terminal(keycode, record) &&
+    PROCESS_ALL_KEYCODES(process_terminal),
 #endif
 #ifdef SPACE_CADET_ENABLE
-            process_space_cadet(keycode, record) &&
+    // any other key press cancels the shift
+    PROCESS_ALL_KEYCODES(process_space_cadet),
 #endif
 #ifdef MAGIC_KEYCODE_ENABLE
-            process_magic(keycode, record) &&
+    PROCESS_KEYCODES(MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_TOGGLE_ALT_GUI, process_magic),
+    PROCESS_KEYCODES(MAGIC_SWAP_LCTL_LGUI, MAGIC_EE_HANDS_RIGHT, process_magic),
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+    PROCESS_KEYCODES(GRAVE_ESC, GRAVE_ESC, process_grave_esc),
 #endif
 #if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+    PROCESS_KEYCODES(RGB_TOG, RGB_MODE_RGBTEST, process_rgb),
 #endif
 #ifdef JOYSTICK_ENABLE
-            process_joystick(keycode, record) &&
+    // sends the buttons and axes that changed since the last report
+    PROCESS_ALL_KEYCODES(process_joystick),
 #endif
-            true)) {
+};
+
+/* Core keycode function, hands off handling to other functions,
+    then processes internal quantum keycodes, and then processes
+    ACTIONs.                                                      */
+bool process_record_quantum(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, true);
+
+    // This is how you use actions here
+    // if (keycode == KC_LEAD) {
+    //   action_t action;
+    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
+    //   process_action(record, action);
+    //   return false;
+    // }
+
+#ifdef VELOCIKEY_ENABLE
+    if (velocikey_enabled() && record->event.pressed) {
+        velocikey_accelerate();
+    }
+#endif
+
+#ifdef WPM_ENABLE
+    if (record->event.pressed) {
+        update_wpm(keycode);
+    }
+#endif
+
+#ifdef TAP_DANCE_ENABLE
+    preprocess_tap_dance(keycode, record);
+#endif
+
+#if defined(KEY_LOCK_ENABLE)
+    // Must run first to be able to mask key_up events.
+    if (!process_key_lock(&keycode, record)) {
         return false;
     }
+#endif
+
+    for (uint8_t i = 0; i < sizeof(process_handlers) / sizeof(process_handlers[0]); i++) {
+        uint16_t first = pgm_read_word(&process_handlers[i].first);
+        // one comparison for both bounds, the keycodes below first wrap around past last
+        if ((uint16_t)(keycode - first) > (uint16_t)(pgm_read_word(&process_handlers[i].last) - first)) {
+            continue;
+        }
+        process_handler_func_t process = (process_handler_func_t)pgm_read_ptr(&process_handlers[i].process);
+        if (!process(keycode, record)) {
+            return false;
+        }
+    }
 
     if (record->event.pressed) {
         switch (keycode) {
@@ -340,6 +386,20 @@ layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_
 
 void update_tri_layer(uint8_t layer1, uint8_t layer2, uint8_t layer3) { layer_state_set(update_tri_layer_state(layer_state, layer1, layer2, layer3)); }
 
+#ifdef AUDIO_ENABLE
+// There are some tasks that need to be run a little bit
+// after keyboard startup, or else they will not work correctly
+// because of interaction with the USB device state, which
+// may still be in flux...
+//
+// At the moment the only feature that needs this is the
+// startup song.
+static uint32_t delayed_audio_startup(uint32_t trigger_time, void *cb_arg) {
+    audio_startup();
+    return 0;
+}
+#endif
+
 void matrix_init_quantum() {
 #ifdef BOOTMAGIC_LITE
     bootmagic_lite();
@@ -360,6 +420,7 @@ void matrix_init_quantum() {
 #endif
 #ifdef AUDIO_ENABLE
     audio_init();
+    defer_exec(300, delayed_audio_startup, NULL);
 #endif
 #ifdef RGB_MATRIX_ENABLE
     rgb_matrix_init();
@@ -378,26 +439,6 @@ void matrix_init_quantum() {
 }
 
 void matrix_scan_quantum() {
-#if defined(AUDIO_ENABLE)
-    // There are some tasks that need to be run a little bit
-    // after keyboard startup, or else they will not work correctly
-    // because of interaction with the USB device state, which
-    // may still be in flux...
-    //
-    // At the moment the only feature that needs this is the
-    // startup song.
-    static bool     delayed_tasks_run  = false;
-    static uint16_t delayed_task_timer = 0;
-    if (!delayed_tasks_run) {
-        if (!delayed_task_timer) {
-            delayed_task_timer = timer_read();
-        } else if (timer_elapsed(delayed_task_timer) > 300) {
-            audio_startup();
-            delayed_tasks_run = true;
-        }
-    }
-#endif
-
 #if defined(AUDIO_ENABLE) && !defined(NO_MUSIC_MODE)
     matrix_scan_music();
 #endif
@@ -406,6 +447,7 @@ void matrix_scan_quantum() {
     matrix_scan_sequencer();
 #endif
 
+    // The timeouts are deferred callbacks, these only poll the ones that couldn't be scheduled
 #ifdef TAP_DANCE_ENABLE
     matrix_scan_tap_dance();
 #endif
@@ -414,6 +456,10 @@ void matrix_scan_quantum() {
     matrix_scan_combo();
 #endif
 
+#ifdef AUTO_SHIFT_ENABLE
+    matrix_scan_auto_shift();
+#endif
+
 #ifdef LED_MATRIX_ENABLE
     led_matrix_task();
 #endif
@@ -430,10 +476,6 @@ void matrix_scan_quantum() {
     dip_switch_read(false);
 #endif
 
-#ifdef AUTO_SHIFT_ENABLE
-    autoshift_matrix_scan();
-#endif
-
     matrix_scan_kb();
 }
 
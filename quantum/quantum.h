@@ -54,6 +54,7 @@
 #include "bootloader.h"
 #include "timer.h"
 #include "sync_timer.h"
+#include "deferred_exec.h"
 #include "config_common.h"
 #include "gpio.h"
 #include "atomic_util.h"
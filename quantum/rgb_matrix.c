@@ -25,17 +25,77 @@
 
 #include <lib/lib8tion/lib8tion.h>
 
-#ifndef RGB_MATRIX_CENTER
+// generated by `qmk generate-rgb-matrix-geometry` from the rgb_matrix layout of info.json, if there is one
+#ifdef RGB_MATRIX_GEOMETRY_H
+#    include RGB_MATRIX_GEOMETRY_H
+#endif
+
+#ifdef RGB_MATRIX_GEOMETRY_TABLES
+#    if RGB_MATRIX_GEOMETRY_LED_COUNT != DRIVER_LED_TOTAL
+#        error "The rgb_matrix layout in info.json must have DRIVER_LED_TOTAL LEDs"
+#    endif
+// the tables were computed around this center, the generated header fails the build when RGB_MATRIX_CENTER is set too
+const point_t k_rgb_matrix_center = {RGB_MATRIX_GEOMETRY_CENTER_X, RGB_MATRIX_GEOMETRY_CENTER_Y};
+#elif !defined(RGB_MATRIX_CENTER)
 const point_t k_rgb_matrix_center = {112, 32};
 #else
 const point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
+#ifndef RGB_MATRIX_GEOMETRY_TABLES
+// computed from g_led_config.point by rgb_matrix_init(), so effects don't do trigonometry every frame
+polar_t g_led_polar[DRIVER_LED_TOTAL];
+#endif
+
+static inline polar_t led_polar(uint8_t index) {
+#ifdef RGB_MATRIX_GEOMETRY_TABLES
+    return (polar_t){pgm_read_byte(&rgb_matrix_geometry_polar[index].angle), pgm_read_byte(&rgb_matrix_geometry_polar[index].dist)};
+#else
+    return g_led_polar[index];
+#endif
+}
+
 __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
 
+// used by the effect runners, goes through rgb_matrix_hsv_to_rgb() so that overriding it is enough
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+}
+
+#ifndef RGB_MATRIX_HSV_BATCH_SIZE
+#    define RGB_MATRIX_HSV_BATCH_SIZE 16
+#endif
+
+// the effect runners collect the colors of their LEDs and convert them a batch at a time
+typedef struct {
+    uint8_t count;
+    uint8_t index[RGB_MATRIX_HSV_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_HSV_BATCH_SIZE];
+} hsv_batch_t;
+
+static void hsv_batch_flush(hsv_batch_t *batch) {
+    RGB rgb[RGB_MATRIX_HSV_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_batch(batch->hsv, rgb, batch->count);
+    for (uint8_t j = 0; j < batch->count; j++) {
+        rgb_matrix_set_color(batch->index[j], rgb[j].r, rgb[j].g, rgb[j].b);
+    }
+    batch->count = 0;
+}
+
+static inline void hsv_batch_add(hsv_batch_t *batch, uint8_t i, HSV hsv) {
+    batch->index[batch->count] = i;
+    batch->hsv[batch->count]   = hsv;
+    if (++batch->count == RGB_MATRIX_HSV_BATCH_SIZE) {
+        hsv_batch_flush(batch);
+    }
+}
+
 // Generic effect runners
 #include "rgb_matrix_runners/effect_runner_dx_dy_dist.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy.h"
+#include "rgb_matrix_runners/effect_runner_polar.h"
 #include "rgb_matrix_runners/effect_runner_i.h"
 #include "rgb_matrix_runners/effect_runner_sin_cos_i.h"
 #include "rgb_matrix_runners/effect_runner_reactive.h"
@@ -122,11 +182,16 @@ bool         g_suspend_state = false;
 rgb_config_t rgb_matrix_config;  // TODO: would like to prefix this with g_ for global consistancy, do this in another pr
 uint32_t     g_rgb_timer;
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
-uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
+uint8_t             g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
+frame_buffer_cell_t g_rgb_frame_buffer_active[MATRIX_ROWS * MATRIX_COLS];
+uint16_t            g_rgb_frame_buffer_active_count = 0;
 #endif  // RGB_MATRIX_FRAMEBUFFER_EFFECTS
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_GOVERNED_PROCESS_LIMIT
+uint8_t g_rgb_led_process_count = RGB_MATRIX_LED_PROCESS_LIMIT;
+#endif  // RGB_MATRIX_GOVERNED_PROCESS_LIMIT
 
 // internals
 static uint8_t         rgb_last_enable   = UINT8_MAX;
@@ -143,9 +208,9 @@ static uint32_t rgb_timer_buffer;
 static last_hit_t last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
-void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_read_rgb_matrix(void) { eeconfig_read_deferred(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
-void eeconfig_update_rgb_matrix(void) { eeprom_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_update_rgb_matrix(void) { eeconfig_update_deferred(EECONFIG_RGB_MATRIX, &rgb_matrix_config, sizeof(rgb_matrix_config)); }
 
 void eeconfig_update_rgb_matrix_default(void) {
     dprintf("eeconfig_update_rgb_matrix_default\n");
@@ -178,6 +243,58 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+#ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
+void rgb_matrix_framebuffer_clear(void) {
+    memset(g_rgb_frame_buffer, 0, sizeof(g_rgb_frame_buffer));
+    g_rgb_frame_buffer_active_count = 0;
+}
+
+void rgb_matrix_framebuffer_set(uint8_t row, uint8_t col, uint8_t value) {
+    uint8_t old                  = g_rgb_frame_buffer[row][col];
+    g_rgb_frame_buffer[row][col] = value;
+
+    if (!old && value) {
+        g_rgb_frame_buffer_active[g_rgb_frame_buffer_active_count++] = (frame_buffer_cell_t){row, col};
+    } else if (old && !value) {
+        for (uint16_t i = 0; i < g_rgb_frame_buffer_active_count; i++) {
+            if (g_rgb_frame_buffer_active[i].row == row && g_rgb_frame_buffer_active[i].col == col) {
+                g_rgb_frame_buffer_active[i] = g_rgb_frame_buffer_active[--g_rgb_frame_buffer_active_count];
+                break;
+            }
+        }
+    }
+}
+
+void rgb_matrix_framebuffer_add(uint8_t row, uint8_t col, uint8_t amount) { rgb_matrix_framebuffer_set(row, col, qadd8(g_rgb_frame_buffer[row][col], amount)); }
+
+void rgb_matrix_framebuffer_splash(uint8_t row, uint8_t col, const frame_buffer_kernel_t *kernel) {
+    for (int16_t r = row - kernel->radius; r <= row + kernel->radius; r++) {
+        if (r < 0 || r >= MATRIX_ROWS) continue;
+        for (int16_t c = col - kernel->radius; c <= col + kernel->radius; c++) {
+            if (c < 0 || c >= MATRIX_COLS) continue;
+            uint8_t row_distance = abs(r - row);
+            uint8_t col_distance = abs(c - col);
+            rgb_matrix_framebuffer_add(r, c, kernel->amounts[row_distance * (kernel->radius + 1) + col_distance]);
+        }
+    }
+}
+
+void rgb_matrix_framebuffer_decay(uint8_t amount, bool hold_max) {
+    // walking backwards, a cell that reaches zero is replaced by one that was already decayed
+    for (uint16_t i = g_rgb_frame_buffer_active_count; i-- > 0;) {
+        frame_buffer_cell_t cell  = g_rgb_frame_buffer_active[i];
+        uint8_t             value = g_rgb_frame_buffer[cell.row][cell.col];
+        if (hold_max && value == UINT8_MAX) continue;
+
+        value                                  = qsub8(value, amount);
+        g_rgb_frame_buffer[cell.row][cell.col] = value;
+        if (!value) {
+            g_rgb_frame_buffer_active[i] = g_rgb_frame_buffer_active[--g_rgb_frame_buffer_active_count];
+        }
+    }
+}
+#endif  // RGB_MATRIX_FRAMEBUFFER_EFFECTS
+
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
@@ -295,12 +412,15 @@ static void rgb_task_timers(void) {
 
 static void rgb_task_sync(void) {
     // next task
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+    if (sync_timer_elapsed32(g_rgb_timer) >= led_governor_frame_interval(RGB_MATRIX_LED_FLUSH_LIMIT)) rgb_task_state = STARTING;
 }
 
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+#ifdef RGB_MATRIX_GOVERNED_PROCESS_LIMIT
+    g_rgb_led_process_count = led_governor_process_limit(RGB_MATRIX_LED_PROCESS_LIMIT);
+#endif
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
@@ -432,8 +552,8 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * rgb_task_render, right before the iter++ line.
      */
 #if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
-    uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
-    uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
+    uint8_t min = RGB_MATRIX_LED_PROCESS_COUNT * (params->iter - 1);
+    uint8_t max = min + RGB_MATRIX_LED_PROCESS_COUNT;
     if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
     uint8_t min = 0;
@@ -450,6 +570,15 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
 
+#ifndef RGB_MATRIX_GEOMETRY_TABLES
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx           = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy           = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        g_led_polar[i].angle = atan2_8(dy, dx);
+        g_led_polar[i].dist  = sqrt16(dx * dx + dy * dy);
+    }
+#endif
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
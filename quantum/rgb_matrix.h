@@ -24,6 +24,7 @@
 #include "color.h"
 #include "quantum.h"
 #include "rgblight_list.h"
+#include "led_governor.h"
 
 #ifdef IS31FL3731
 #    include "is31fl3731.h"
@@ -46,11 +47,20 @@
 #endif
 
 #if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+// The LED governor lowers the limit while the scan rate is too low, it only changes between frames
+#    ifdef LED_GOVERNOR_MIN_SCAN_RATE
+#        define RGB_MATRIX_GOVERNED_PROCESS_LIMIT
+extern uint8_t g_rgb_led_process_count;
+#        define RGB_MATRIX_LED_PROCESS_COUNT g_rgb_led_process_count
+#    else
+#        define RGB_MATRIX_LED_PROCESS_COUNT RGB_MATRIX_LED_PROCESS_LIMIT
+#    endif
 #    define RGB_MATRIX_USE_LIMITS(min, max)                        \
-        uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
-        uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;          \
+        uint8_t min = RGB_MATRIX_LED_PROCESS_COUNT * params->iter; \
+        uint8_t max = min + RGB_MATRIX_LED_PROCESS_COUNT;          \
         if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
+#    define RGB_MATRIX_LED_PROCESS_COUNT RGB_MATRIX_LED_PROCESS_LIMIT
 #    define RGB_MATRIX_USE_LIMITS(min, max) \
         uint8_t min = 0;                    \
         uint8_t max = DRIVER_LED_TOTAL;
@@ -95,6 +105,17 @@ void eeconfig_update_rgb_matrix(void);
 uint8_t rgb_matrix_map_row_column_to_led_kb(uint8_t row, uint8_t column, uint8_t *led_i);
 uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *led_i);
 
+#ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
+// g_rgb_frame_buffer_active lists the cells of g_rgb_frame_buffer that aren't zero, as long as they are only written through these
+void rgb_matrix_framebuffer_clear(void);
+void rgb_matrix_framebuffer_set(uint8_t row, uint8_t col, uint8_t value);
+void rgb_matrix_framebuffer_add(uint8_t row, uint8_t col, uint8_t amount);
+// adds the amounts of kernel to the cells within its radius of row and col
+void rgb_matrix_framebuffer_splash(uint8_t row, uint8_t col, const frame_buffer_kernel_t *kernel);
+// subtracts amount from every cell that isn't zero, and from the ones at UINT8_MAX unless hold_max
+void rgb_matrix_framebuffer_decay(uint8_t amount, bool hold_max);
+#endif
+
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
 
@@ -219,9 +240,13 @@ extern rgb_config_t rgb_matrix_config;
 extern bool         g_suspend_state;
 extern uint32_t     g_rgb_timer;
 extern led_config_t g_led_config;
+// not available when the geometry tables were generated from info.json
+extern polar_t      g_led_polar[DRIVER_LED_TOTAL];
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
 #endif
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
-extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
+extern uint8_t             g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
+extern frame_buffer_cell_t g_rgb_frame_buffer_active[MATRIX_ROWS * MATRIX_COLS];
+extern uint16_t            g_rgb_frame_buffer_active_count;
 #endif
@@ -2,12 +2,12 @@
 RGB_MATRIX_EFFECT(CYCLE_OUT_IN)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
-static HSV CYCLE_OUT_IN_math(HSV hsv, int16_t dx, int16_t dy, uint8_t dist, uint8_t time) {
+static HSV CYCLE_OUT_IN_math(HSV hsv, uint8_t angle, uint8_t dist, uint8_t time) {
     hsv.h = 3 * dist / 2 + time;
     return hsv;
 }
 
-bool CYCLE_OUT_IN(effect_params_t* params) { return effect_runner_dx_dy_dist(params, &CYCLE_OUT_IN_math); }
+bool CYCLE_OUT_IN(effect_params_t* params) { return effect_runner_polar(params, &CYCLE_OUT_IN_math); }
 
 #    endif  // RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 #endif      // DISABLE_RGB_MATRIX_CYCLE_OUT_IN
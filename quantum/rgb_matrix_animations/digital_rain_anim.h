@@ -18,33 +18,42 @@ bool DIGITAL_RAIN(effect_params_t* params) {
 
     if (params->init) {
         rgb_matrix_set_color_all(0, 0, 0);
-        memset(g_rgb_frame_buffer, 0, sizeof(g_rgb_frame_buffer));
+        rgb_matrix_framebuffer_clear();
         drop = 0;
     }
 
-    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
-            if (row == 0 && drop == 0 && rand() < RAND_MAX / RGB_DIGITAL_RAIN_DROPS) {
+    // neither fully bright nor dark, decay it
+    rgb_matrix_framebuffer_decay(1, true);
+
+    if (drop == 0) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (rand() < RAND_MAX / RGB_DIGITAL_RAIN_DROPS) {
                 // top row, pixels have just fallen and we're
                 // making a new rain drop in this column
-                g_rgb_frame_buffer[row][col] = max_intensity;
-            } else if (g_rgb_frame_buffer[row][col] > 0 && g_rgb_frame_buffer[row][col] < max_intensity) {
-                // neither fully bright nor dark, decay it
-                g_rgb_frame_buffer[row][col]--;
+                rgb_matrix_framebuffer_set(0, col, max_intensity);
             }
-            // set the pixel colour
-            uint8_t led[LED_HITS_TO_REMEMBER];
-            uint8_t led_count = rgb_matrix_map_row_column_to_led(row, col, led);
+        }
+    }
 
-            // TODO: multiple leds are supported mapped to the same row/column
-            if (led_count > 0) {
-                if (g_rgb_frame_buffer[row][col] > pure_green_intensity) {
-                    const uint8_t boost = (uint8_t)((uint16_t)max_brightness_boost * (g_rgb_frame_buffer[row][col] - pure_green_intensity) / (max_intensity - pure_green_intensity));
-                    rgb_matrix_set_color(led[0], boost, max_intensity, boost);
-                } else {
-                    const uint8_t green = (uint8_t)((uint16_t)max_intensity * g_rgb_frame_buffer[row][col] / pure_green_intensity);
-                    rgb_matrix_set_color(led[0], 0, green, 0);
-                }
+    // only the active cells are lit
+    rgb_matrix_set_color_all(0, 0, 0);
+    for (uint16_t i = 0; i < g_rgb_frame_buffer_active_count; i++) {
+        uint8_t row   = g_rgb_frame_buffer_active[i].row;
+        uint8_t col   = g_rgb_frame_buffer_active[i].col;
+        uint8_t value = g_rgb_frame_buffer[row][col];
+
+        // set the pixel colour
+        uint8_t led[LED_HITS_TO_REMEMBER];
+        uint8_t led_count = rgb_matrix_map_row_column_to_led(row, col, led);
+
+        // TODO: multiple leds are supported mapped to the same row/column
+        if (led_count > 0) {
+            if (value > pure_green_intensity) {
+                const uint8_t boost = (uint8_t)((uint16_t)max_brightness_boost * (value - pure_green_intensity) / (max_intensity - pure_green_intensity));
+                rgb_matrix_set_color(led[0], boost, max_intensity, boost);
+            } else {
+                const uint8_t green = (uint8_t)((uint16_t)max_intensity * value / pure_green_intensity);
+                rgb_matrix_set_color(led[0], 0, green, 0);
             }
         }
     }
@@ -52,18 +61,17 @@ bool DIGITAL_RAIN(effect_params_t* params) {
     if (++drop > drop_ticks) {
         // reset drop timer
         drop = 0;
-        for (uint8_t row = MATRIX_ROWS - 1; row > 0; row--) {
-            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-                // if ths is on the bottom row and bright allow decay
-                if (row == MATRIX_ROWS - 1 && g_rgb_frame_buffer[row][col] == max_intensity) {
-                    g_rgb_frame_buffer[row][col]--;
-                }
-                // check if the pixel above is bright
-                if (g_rgb_frame_buffer[row - 1][col] == max_intensity) {
-                    // allow old bright pixel to decay
-                    g_rgb_frame_buffer[row - 1][col]--;
-                    // make this pixel bright
-                    g_rgb_frame_buffer[row][col] = max_intensity;
+        // move the bright pixels down from the bottom row up, so each one only falls once
+        for (uint8_t row = MATRIX_ROWS; row-- > 0;) {
+            for (uint16_t i = 0; i < g_rgb_frame_buffer_active_count; i++) {
+                uint8_t col = g_rgb_frame_buffer_active[i].col;
+                if (g_rgb_frame_buffer_active[i].row != row || g_rgb_frame_buffer[row][col] != max_intensity) continue;
+
+                // allow old bright pixel to decay
+                rgb_matrix_framebuffer_set(row, col, max_intensity - 1);
+                // make the pixel below bright, the bottom row just decays
+                if (row < MATRIX_ROWS - 1) {
+                    rgb_matrix_framebuffer_set(row + 1, col, max_intensity);
                 }
             }
         }
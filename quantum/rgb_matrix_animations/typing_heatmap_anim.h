@@ -6,28 +6,21 @@ RGB_MATRIX_EFFECT(TYPING_HEATMAP)
 #            define RGB_MATRIX_TYPING_HEATMAP_DECREASE_DELAY_MS 25
 #        endif
 
-void process_rgb_matrix_typing_heatmap(uint8_t row, uint8_t col) {
-    uint8_t m_row = row - 1;
-    uint8_t p_row = row + 1;
-    uint8_t m_col = col - 1;
-    uint8_t p_col = col + 1;
-
-    if (m_col < col) g_rgb_frame_buffer[row][m_col] = qadd8(g_rgb_frame_buffer[row][m_col], 16);
-    g_rgb_frame_buffer[row][col] = qadd8(g_rgb_frame_buffer[row][col], 32);
-    if (p_col < MATRIX_COLS) g_rgb_frame_buffer[row][p_col] = qadd8(g_rgb_frame_buffer[row][p_col], 16);
-
-    if (p_row < MATRIX_ROWS) {
-        if (m_col < col) g_rgb_frame_buffer[p_row][m_col] = qadd8(g_rgb_frame_buffer[p_row][m_col], 13);
-        g_rgb_frame_buffer[p_row][col] = qadd8(g_rgb_frame_buffer[p_row][col], 16);
-        if (p_col < MATRIX_COLS) g_rgb_frame_buffer[p_row][p_col] = qadd8(g_rgb_frame_buffer[p_row][p_col], 13);
-    }
+#        ifndef RGB_MATRIX_TYPING_HEATMAP_SPREAD
+#            define RGB_MATRIX_TYPING_HEATMAP_SPREAD 1
+#        endif
 
-    if (m_row < row) {
-        if (m_col < col) g_rgb_frame_buffer[m_row][m_col] = qadd8(g_rgb_frame_buffer[m_row][m_col], 13);
-        g_rgb_frame_buffer[m_row][col] = qadd8(g_rgb_frame_buffer[m_row][col], 16);
-        if (p_col < MATRIX_COLS) g_rgb_frame_buffer[m_row][p_col] = qadd8(g_rgb_frame_buffer[m_row][p_col], 13);
-    }
-}
+// heat added to the pressed key and the keys around it, by row and column distance
+#        ifndef RGB_MATRIX_TYPING_HEATMAP_KERNEL
+#            define RGB_MATRIX_TYPING_HEATMAP_KERNEL \
+                { 32, 16, 16, 13 }
+#        endif
+
+static const uint8_t               heatmap_kernel_amounts[] = RGB_MATRIX_TYPING_HEATMAP_KERNEL;
+static const frame_buffer_kernel_t heatmap_kernel           = {RGB_MATRIX_TYPING_HEATMAP_SPREAD, heatmap_kernel_amounts};
+_Static_assert(sizeof(heatmap_kernel_amounts) == (RGB_MATRIX_TYPING_HEATMAP_SPREAD + 1) * (RGB_MATRIX_TYPING_HEATMAP_SPREAD + 1), "RGB_MATRIX_TYPING_HEATMAP_KERNEL needs (RGB_MATRIX_TYPING_HEATMAP_SPREAD + 1)^2 amounts");
+
+void process_rgb_matrix_typing_heatmap(uint8_t row, uint8_t col) { rgb_matrix_framebuffer_splash(row, col, &heatmap_kernel); }
 
 // A timer to track the last time we decremented all heatmap values.
 static uint16_t heatmap_decrease_timer;
@@ -35,14 +28,9 @@ static uint16_t heatmap_decrease_timer;
 static bool decrease_heatmap_values;
 
 bool TYPING_HEATMAP(effect_params_t* params) {
-    // Modified version of RGB_MATRIX_USE_LIMITS to work off of matrix row / col size
-    uint8_t led_min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;
-    uint8_t led_max = led_min + RGB_MATRIX_LED_PROCESS_LIMIT;
-    if (led_max > sizeof(g_rgb_frame_buffer)) led_max = sizeof(g_rgb_frame_buffer);
-
     if (params->init) {
-        rgb_matrix_set_color_all(0, 0, 0);
-        memset(g_rgb_frame_buffer, 0, sizeof g_rgb_frame_buffer);
+        rgb_matrix_framebuffer_clear();
+        heatmap_decrease_timer = timer_read();
     }
 
     // The heatmap animation might run in several iterations depending on
@@ -55,12 +43,24 @@ bool TYPING_HEATMAP(effect_params_t* params) {
         if (decrease_heatmap_values) {
             heatmap_decrease_timer = timer_read();
         }
+
+        // Keys with no heat are dark, only the active cells are rendered below
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            if (HAS_ANY_FLAGS(g_led_config.flags[i], params->flags)) {
+                rgb_matrix_set_color(i, 0, 0, 0);
+            }
+        }
     }
 
-    // Render heatmap & decrease
-    for (int i = led_min; i < led_max; i++) {
-        uint8_t row = i % MATRIX_ROWS;
-        uint8_t col = i / MATRIX_ROWS;
+    // Modified version of RGB_MATRIX_USE_LIMITS to work off of the active cells
+    uint16_t cell_min = RGB_MATRIX_LED_PROCESS_COUNT * params->iter;
+    uint16_t cell_max = cell_min + RGB_MATRIX_LED_PROCESS_COUNT;
+    if (cell_max > g_rgb_frame_buffer_active_count) cell_max = g_rgb_frame_buffer_active_count;
+
+    // Render heatmap
+    for (uint16_t i = cell_min; i < cell_max; i++) {
+        uint8_t row = g_rgb_frame_buffer_active[i].row;
+        uint8_t col = g_rgb_frame_buffer_active[i].col;
         uint8_t val = g_rgb_frame_buffer[row][col];
 
         // set the pixel colour
@@ -73,13 +73,17 @@ bool TYPING_HEATMAP(effect_params_t* params) {
             RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
             rgb_matrix_set_color(led[j], rgb.r, rgb.g, rgb.b);
         }
+    }
 
-        if (decrease_heatmap_values) {
-            g_rgb_frame_buffer[row][col] = qsub8(val, 1);
-        }
+    if (cell_max < g_rgb_frame_buffer_active_count) {
+        return true;
     }
 
-    return led_max < sizeof(g_rgb_frame_buffer);
+    // Decrease once every active cell was rendered
+    if (decrease_heatmap_values) {
+        rgb_matrix_framebuffer_decay(1, false);
+    }
+    return false;
 }
 
 #    endif  // RGB_MATRIX_CUSTOM_EFFECT_IMPLS
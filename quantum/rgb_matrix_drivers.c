@@ -142,22 +142,31 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 
 // LED color buffer
 LED_TYPE rgb_matrix_ws2812_array[DRIVER_LED_TOTAL];
+// The whole chain has to be sent again when any LED changed, so a single flag is enough
+static bool ws2812_update_required = true;
 
 static void init(void) {}
 
 static void flush(void) {
+    if (!ws2812_update_required) return;
+
     // Assumes use of RGB_DI_PIN
     ws2812_setleds(rgb_matrix_ws2812_array, DRIVER_LED_TOTAL);
+    ws2812_update_required = false;
 }
 
 // Set an led in the buffer to a color
 static inline void setled(int i, uint8_t r, uint8_t g, uint8_t b) {
-    rgb_matrix_ws2812_array[i].r = r;
-    rgb_matrix_ws2812_array[i].g = g;
-    rgb_matrix_ws2812_array[i].b = b;
+    LED_TYPE led = rgb_matrix_ws2812_array[i];
+    led.r        = r;
+    led.g        = g;
+    led.b        = b;
 #    ifdef RGBW
-    convert_rgb_to_rgbw(&rgb_matrix_ws2812_array[i]);
+    convert_rgb_to_rgbw(&led);
+    if (led.w != rgb_matrix_ws2812_array[i].w) ws2812_update_required = true;
 #    endif
+    if (led.r != rgb_matrix_ws2812_array[i].r || led.g != rgb_matrix_ws2812_array[i].g || led.b != rgb_matrix_ws2812_array[i].b) ws2812_update_required = true;
+    rgb_matrix_ws2812_array[i] = led;
 }
 
 static void setled_all(uint8_t r, uint8_t g, uint8_t b) {
@@ -0,0 +1,18 @@
+#pragma once
+
+typedef HSV (*polar_f)(HSV hsv, uint8_t angle, uint8_t dist, uint8_t time);
+
+bool effect_runner_polar(effect_params_t* params, polar_f effect_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    hsv_batch_t batch = {.count = 0};
+
+    uint8_t time = scale16by8(g_rgb_timer, rgb_matrix_config.speed / 2);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        polar_t polar = led_polar(i);
+        hsv_batch_add(&batch, i, effect_func(rgb_matrix_config.hsv, polar.angle, polar.dist, time));
+    }
+    hsv_batch_flush(&batch);
+    return led_max < DRIVER_LED_TOTAL;
+}
@@ -64,6 +64,24 @@ typedef struct PACKED {
     uint8_t y;
 } point_t;
 
+// position of a LED around k_rgb_matrix_center, angle as returned by atan2_8() and dist by sqrt16()
+typedef struct PACKED {
+    uint8_t angle;
+    uint8_t dist;
+} polar_t;
+
+// a cell of g_rgb_frame_buffer
+typedef struct PACKED {
+    uint8_t row;
+    uint8_t col;
+} frame_buffer_cell_t;
+
+// amounts added to the cells around a key, indexed by [row distance * (radius + 1) + column distance]
+typedef struct {
+    uint8_t        radius;
+    const uint8_t *amounts;
+} frame_buffer_kernel_t;
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 #define HAS_ANY_FLAGS(bits, flags) ((bits & flags) != 0x00)
 
@@ -31,8 +31,10 @@
 #include "progmem.h"
 #include "sync_timer.h"
 #include "rgblight.h"
+#include "led_governor.h"
 #include "color.h"
 #include "debug.h"
+#include "eeconfig.h"
 #include "led_tables.h"
 #include <lib/lib8tion/lib8tion.h>
 #ifdef VELOCIKEY_ENABLE
@@ -186,7 +188,9 @@ void rgblight_check_config(void) {
 
 uint32_t eeconfig_read_rgblight(void) {
 #ifdef EEPROM_ENABLE
-    return eeprom_read_dword(EECONFIG_RGBLIGHT);
+    uint32_t val;
+    eeconfig_read_deferred(&val, EECONFIG_RGBLIGHT, sizeof(val));
+    return val;
 #else
     return 0;
 #endif
@@ -195,7 +199,7 @@ uint32_t eeconfig_read_rgblight(void) {
 void eeconfig_update_rgblight(uint32_t val) {
 #ifdef EEPROM_ENABLE
     rgblight_check_config();
-    eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+    eeconfig_update_deferred(EECONFIG_RGBLIGHT, &val, sizeof(val));
 #endif
 }
 
@@ -1019,7 +1023,7 @@ void rgblight_task(void) {
             }
             oldpos16 = animation_status.pos16;
 #    endif
-            animation_status.last_timer += interval_time;
+            animation_status.last_timer += led_governor_frame_interval(interval_time);
             effect_func(&animation_status);
 #    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
             if (animation_status.pos16 == 0 && oldpos16 != 0) {
@@ -15,6 +15,7 @@
  */
 
 #include <ctype.h>
+#include <string.h>
 
 #include "quantum.h"
 
@@ -134,121 +135,365 @@ __attribute__((weak)) const uint8_t ascii_to_keycode_lut[128] PROGMEM = {
 // Note: we bit-pack in "reverse" order to optimize loading
 #define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
 
-void send_string(const char *str) { send_string_with_delay(str, 0); }
+#if SEND_STRING_QUEUE_SIZE > 255
+#    error SEND_STRING_QUEUE_SIZE must be 255 or less
+#endif
 
-void send_string_P(const char *str) { send_string_with_delay_P(str, 0); }
+/* Output
+ *
+ * Every string goes through the same decoder, which turns the next character or code into the
+ * changes of the keyboard report it takes. send_string_task() sends one of them every
+ * SEND_STRING_ASYNC_INTERVAL milliseconds, from the main loop, the blocking functions type what
+ * was queued, then their own string, right away.
+ *
+ * The queue holds what waits to be typed, each behind a header byte: a string of
+ * send_string_async() is copied in the queue with its terminating NUL, a string of
+ * send_string_async_P() is a pointer to the PROGMEM string, and a code point of
+ * send_unicode_async() takes four bytes, its whole input sequence is typed from them.
+ */
+enum { QUEUED_RAM_STRING, QUEUED_PROGMEM_STRING, QUEUED_UNICODE };
 
-void send_string_with_delay(const char *str, uint8_t interval) {
-    while (1) {
-        char ascii_code = *str;
-        if (!ascii_code) break;
-        if (ascii_code == SS_QMK_PREFIX) {
-            ascii_code = *(++str);
-            if (ascii_code == SS_TAP_CODE) {
-                // tap
-                uint8_t keycode = *(++str);
-                tap_code(keycode);
-            } else if (ascii_code == SS_DOWN_CODE) {
-                // down
-                uint8_t keycode = *(++str);
-                register_code(keycode);
-            } else if (ascii_code == SS_UP_CODE) {
-                // up
-                uint8_t keycode = *(++str);
-                unregister_code(keycode);
-            } else if (ascii_code == SS_DELAY_CODE) {
-                // delay
-                int     ms      = 0;
-                uint8_t keycode = *(++str);
-                while (isdigit(keycode)) {
-                    ms *= 10;
-                    ms += keycode - '0';
-                    keycode = *(++str);
-                }
-                while (ms--) wait_ms(1);
+static uint8_t queue[SEND_STRING_QUEUE_SIZE];
+static uint8_t queue_head  = 0;
+static uint8_t queue_count = 0;
+
+// where the string being typed is read from, STRING_NONE once its NUL was read
+enum { STRING_NONE, STRING_QUEUED, STRING_RAM, STRING_PROGMEM, STRING_UNICODE };
+
+static uint8_t     string_source  = STRING_NONE;
+static const char *string_pointer = NULL;
+
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+// the code point being typed and the next part of its input sequence
+static uint32_t unicode_code_point = 0;
+static uint8_t  unicode_part       = 0;
+#endif
+
+// the report changes of the character being typed
+typedef struct {
+    uint8_t type;
+    uint8_t code;
+} send_string_step_t;
+
+#define SEND_STRING_MAX_STEPS 12
+
+static send_string_step_t steps[SEND_STRING_MAX_STEPS];
+static uint8_t            step_count = 0;
+static uint8_t            step_index = 0;
+static uint16_t           step_timer = (uint16_t)-SEND_STRING_ASYNC_INTERVAL;  // so the first change is sent right after boot
+static uint16_t           step_delay = 0;
+static uint8_t            step_mods  = 0;  // the weak mods the steps hold, a key press of the user clears them
+
+static void queue_push(uint8_t byte) {
+    queue[(queue_head + queue_count) % SEND_STRING_QUEUE_SIZE] = byte;
+    queue_count++;
+}
+
+static uint8_t queue_pop(void) {
+    uint8_t byte = queue[queue_head];
+    queue_head   = (queue_head + 1) % SEND_STRING_QUEUE_SIZE;
+    queue_count--;
+    return byte;
+}
+
+static uint8_t peek_string_byte(void) {
+    switch (string_source) {
+        case STRING_QUEUED:
+            return queue[queue_head];
+        case STRING_RAM:
+            return *string_pointer;
+        case STRING_PROGMEM:
+            return pgm_read_byte(string_pointer);
+        default:
+            return 0;
+    }
+}
+
+static uint8_t next_string_byte(void) {
+    uint8_t byte = peek_string_byte();
+    if (string_source == STRING_QUEUED) {
+        queue_pop();
+    } else if (string_source == STRING_RAM || string_source == STRING_PROGMEM) {
+        string_pointer++;
+    }
+    if (!byte) string_source = STRING_NONE;
+    return byte;
+}
+
+static bool start_next_string(void) {
+    if (!queue_count) return false;
+
+    switch (queue_pop()) {
+        case QUEUED_PROGMEM_STRING: {
+            uint8_t *pointer = (uint8_t *)&string_pointer;
+            for (uint8_t i = 0; i < sizeof(string_pointer); i++) {
+                pointer[i] = queue_pop();
             }
-        } else {
-            send_char(ascii_code);
-        }
-        ++str;
-        // interval
-        {
-            uint8_t ms = interval;
-            while (ms--) wait_ms(1);
+            string_source = STRING_PROGMEM;
+            break;
         }
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+        case QUEUED_UNICODE:
+            unicode_code_point = 0;
+            for (uint8_t i = 0; i < sizeof(unicode_code_point); i++) {
+                unicode_code_point |= (uint32_t)queue_pop() << (i * 8);
+            }
+            unicode_part  = 0;
+            string_source = STRING_UNICODE;
+            break;
+#endif
+        default:
+            string_source = STRING_QUEUED;
     }
+    return true;
 }
 
-void send_string_with_delay_P(const char *str, uint8_t interval) {
-    while (1) {
-        char ascii_code = pgm_read_byte(str);
-        if (!ascii_code) break;
+/** \brief Adds a report change to the character being decoded
+ *
+ * For the modules which type more than characters, like the Unicode input sequences.
+ */
+void send_string_add_step(uint8_t type, uint8_t code) {
+    // the steps of the blocking functions start once the previous ones were sent
+    if (step_index == step_count) {
+        step_index = 0;
+        step_count = 0;
+    }
+    if (step_count < SEND_STRING_MAX_STEPS) {
+        steps[step_count].type = type;
+        steps[step_count].code = code;
+        step_count++;
+    }
+}
+
+/** \brief Waits the given milliseconds before the next report change
+ */
+void send_string_add_delay(uint16_t ms) {
+    step_timer = timer_read();
+    step_delay = ms;
+}
+
+/** \brief Adds the report changes a character is typed with
+ */
+void send_string_add_char_steps(char ascii_code) {
+#if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
+    if (ascii_code == '\a') {  // BEL
+        PLAY_SONG(bell_song);
+        return;
+    }
+#endif
+
+    uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
+    bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code);
+    bool    is_altgred = PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code);
+    bool    is_dead    = PGM_LOADBIT(ascii_to_dead_lut, (uint8_t)ascii_code);
+    uint8_t mods       = (is_shifted ? MOD_BIT(KC_LSFT) : 0) | (is_altgred ? MOD_BIT(KC_RALT) : 0);
+
+    if (mods) send_string_add_step(SEND_STRING_MODS_DOWN, mods);
+    send_string_add_step(SEND_STRING_KEY_DOWN, keycode);
+    send_string_add_step(SEND_STRING_KEY_UP, keycode);
+    if (mods) send_string_add_step(SEND_STRING_MODS_UP, mods);
+    if (is_dead) {
+        send_string_add_step(SEND_STRING_KEY_DOWN, KC_SPACE);
+        send_string_add_step(SEND_STRING_KEY_UP, KC_SPACE);
+    }
+}
+
+// Reads the string up to the next report changes or delay
+static void decode_next_steps(void) {
+    step_count = 0;
+    step_index = 0;
+
+    while (!step_count && !step_delay) {
+        if (string_source == STRING_NONE && !start_next_string()) return;
+
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+        if (string_source == STRING_UNICODE) {
+            if (!unicode_input_add_steps(unicode_code_point, unicode_part++)) string_source = STRING_NONE;
+            continue;
+        }
+#endif
+
+        uint8_t ascii_code = next_string_byte();
         if (ascii_code == SS_QMK_PREFIX) {
-            ascii_code = pgm_read_byte(++str);
+            ascii_code = next_string_byte();
             if (ascii_code == SS_TAP_CODE) {
-                // tap
-                uint8_t keycode = pgm_read_byte(++str);
-                tap_code(keycode);
+                uint8_t keycode = next_string_byte();
+                send_string_add_step(SEND_STRING_KEY_DOWN, keycode);
+                send_string_add_step(SEND_STRING_KEY_UP, keycode);
             } else if (ascii_code == SS_DOWN_CODE) {
-                // down
-                uint8_t keycode = pgm_read_byte(++str);
-                register_code(keycode);
+                send_string_add_step(SEND_STRING_KEY_DOWN, next_string_byte());
             } else if (ascii_code == SS_UP_CODE) {
-                // up
-                uint8_t keycode = pgm_read_byte(++str);
-                unregister_code(keycode);
+                send_string_add_step(SEND_STRING_KEY_UP, next_string_byte());
             } else if (ascii_code == SS_DELAY_CODE) {
-                // delay
-                int     ms      = 0;
-                uint8_t keycode = pgm_read_byte(++str);
+                uint16_t ms      = 0;
+                uint8_t  keycode = next_string_byte();
                 while (isdigit(keycode)) {
                     ms *= 10;
                     ms += keycode - '0';
-                    keycode = pgm_read_byte(++str);
+                    keycode = next_string_byte();
                 }
-                while (ms--) wait_ms(1);
+                send_string_add_delay(ms);
             }
-        } else {
-            send_char(ascii_code);
-        }
-        ++str;
-        // interval
-        {
-            uint8_t ms = interval;
-            while (ms--) wait_ms(1);
+        } else if (ascii_code) {
+            send_string_add_char_steps(ascii_code);
         }
+
+        // the string is done once its NUL is read, which leaves the next one free to start
+        if (!peek_string_byte()) next_string_byte();
     }
 }
 
-void send_char(char ascii_code) {
-#if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
-    if (ascii_code == '\a') {  // BEL
-        PLAY_SONG(bell_song);
-        return;
+static void send_next_step(void) {
+    send_string_step_t step = steps[step_index++];
+
+    add_weak_mods(step_mods);
+    switch (step.type) {
+        case SEND_STRING_KEY_DOWN:
+            register_code(step.code);
+            // like tap_code(), as macOS ignores short taps of Caps Lock
+            if (step.code == KC_CAPS) send_string_add_delay(TAP_HOLD_CAPS_DELAY);
+            break;
+        case SEND_STRING_KEY_UP:
+            unregister_code(step.code);
+            break;
+        case SEND_STRING_MODS_DOWN:
+            step_mods |= step.code;
+            add_weak_mods(step.code);
+            send_keyboard_report();
+            break;
+        case SEND_STRING_MODS_UP:
+            step_mods &= ~step.code;
+            del_weak_mods(step.code);
+            send_keyboard_report();
+            break;
+        case SEND_STRING_SUPPRESS_MODS:
+            set_suppressed_mods(step.code ? get_mods() : 0);
+            send_keyboard_report();
+            break;
     }
+    if (!step_delay) step_timer = timer_read();
+}
+
+// Types what is pending right away, waiting the interval after each character
+static void send_pending_steps(uint8_t interval) {
+    while (send_string_async_pending()) {
+        if (step_delay) {
+            uint16_t ms = timer_elapsed(step_timer);
+            ms          = ms < step_delay ? step_delay - ms : 0;
+            while (ms--) wait_ms(1);
+            step_delay = 0;
+        } else if (step_index == step_count) {
+            decode_next_steps();
+        } else {
+            send_next_step();
+#if TAP_CODE_DELAY > 0
+            wait_ms(TAP_CODE_DELAY);
 #endif
+            if (step_index == step_count) {
+                uint8_t ms = interval;
+                while (ms--) wait_ms(1);
+            }
+        }
+    }
+}
 
-    uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
-    bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code);
-    bool    is_altgred = PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code);
-    bool    is_dead    = PGM_LOADBIT(ascii_to_dead_lut, (uint8_t)ascii_code);
+/** \brief Queues a string to be typed from the main loop
+ *
+ * The string is copied. A string that does not fit in what is left of the queue is not queued
+ * and false is returned, the caller can type it with send_string() instead, or try again once
+ * send_string_async_pending() is false.
+ */
+bool send_string_async(const char *str) {
+    size_t length = strlen(str) + 1;
+    if (1 + length > SEND_STRING_QUEUE_SIZE - queue_count) return false;
 
-    if (is_shifted) {
-        register_code(KC_LSFT);
+    queue_push(QUEUED_RAM_STRING);
+    while (length--) {
+        queue_push(*str++);
     }
-    if (is_altgred) {
-        register_code(KC_RALT);
+    return true;
+}
+
+/** \brief Queues a PROGMEM string to be typed from the main loop
+ *
+ * Returns false when the queue is full, like send_string_async().
+ */
+bool send_string_async_P(const char *str) {
+    if (1 + sizeof(str) > SEND_STRING_QUEUE_SIZE - queue_count) return false;
+
+    queue_push(QUEUED_PROGMEM_STRING);
+    const uint8_t *pointer = (const uint8_t *)&str;
+    for (uint8_t i = 0; i < sizeof(str); i++) {
+        queue_push(pointer[i]);
     }
-    tap_code(keycode);
-    if (is_altgred) {
-        unregister_code(KC_RALT);
+    return true;
+}
+
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+/** \brief Queues the input sequence of a code point, see register_unicode()
+ *
+ * Returns false when the queue is full, like send_string_async().
+ */
+bool send_unicode_async(uint32_t code_point) {
+    if (1 + sizeof(code_point) > SEND_STRING_QUEUE_SIZE - queue_count) return false;
+
+    queue_push(QUEUED_UNICODE);
+    for (uint8_t i = 0; i < sizeof(code_point); i++) {
+        queue_push(code_point >> (i * 8));
     }
-    if (is_shifted) {
-        unregister_code(KC_LSFT);
+    return true;
+}
+#endif
+
+bool send_string_async_pending(void) { return step_index < step_count || step_delay || string_source != STRING_NONE || queue_count; }
+
+/** \brief Types what is left of the queue right away
+ */
+void send_string_flush(void) { send_pending_steps(0); }
+
+/** \brief Sends the next report change of the queue, called from keyboard_task()
+ */
+void send_string_task(void) {
+    if (!send_string_async_pending()) return;
+
+    uint16_t elapsed = timer_elapsed(step_timer);
+    if (step_delay) {
+        if (elapsed < step_delay) return;
+        step_delay = 0;
+    } else if (elapsed < SEND_STRING_ASYNC_INTERVAL) {
+        return;
     }
-    if (is_dead) {
-        tap_code(KC_SPACE);
+    if (step_index == step_count) {
+        decode_next_steps();
+        if (step_index == step_count) return;
     }
+
+    send_next_step();
+}
+
+void send_string(const char *str) { send_string_with_delay(str, 0); }
+
+void send_string_P(const char *str) { send_string_with_delay_P(str, 0); }
+
+void send_string_with_delay(const char *str, uint8_t interval) {
+    // what was queued before is typed first
+    send_string_flush();
+    string_source  = STRING_RAM;
+    string_pointer = str;
+    send_pending_steps(interval);
+}
+
+void send_string_with_delay_P(const char *str, uint8_t interval) {
+    send_string_flush();
+    string_source  = STRING_PROGMEM;
+    string_pointer = str;
+    send_pending_steps(interval);
+}
+
+void send_char(char ascii_code) {
+    send_string_flush();
+    send_string_add_char_steps(ascii_code);
+    send_string_flush();
 }
 
 void send_dword(uint32_t number) {
@@ -14,6 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "progmem.h"
@@ -21,6 +24,21 @@
 
 #define SEND_STRING(string) send_string_P(PSTR(string))
 #define SEND_STRING_DELAY(string, interval) send_string_with_delay_P(PSTR(string), interval)
+#define SEND_STRING_ASYNC(string) send_string_async_P(PSTR(string))
+
+/* Bytes of the queue of send_string_async(), a string queued with send_string_async_P()
+ * only takes a reference to it */
+#ifndef SEND_STRING_QUEUE_SIZE
+#    define SEND_STRING_QUEUE_SIZE 64
+#endif
+
+/* Milliseconds between two changes of the keyboard report while the queue is sent. The default
+ * is the default polling interval of LUFA and ChibiOS, and the shortest one of low speed V-USB,
+ * so a report is never waiting for the previous one. It can be lowered along with
+ * USB_POLLING_INTERVAL_MS. */
+#ifndef SEND_STRING_ASYNC_INTERVAL
+#    define SEND_STRING_ASYNC_INTERVAL 10
+#endif
 
 // Look-Up Tables (LUTs) to convert ASCII character to keycode sequence.
 extern const uint8_t ascii_to_shift_lut[16];
@@ -46,6 +64,29 @@ void send_string_P(const char *str);
 void send_string_with_delay_P(const char *str, uint8_t interval);
 void send_char(char ascii_code);
 
+bool send_string_async(const char *str);
+bool send_string_async_P(const char *str);
+bool send_string_async_pending(void);
+void send_string_flush(void);
+void send_string_task(void);
+
+/* The changes of the keyboard report a character or a sequence is typed as. The mods of
+ * SEND_STRING_MODS_DOWN are weak mods, which leave the mods the user holds alone, and
+ * SEND_STRING_SUPPRESS_MODS leaves the mods the user holds at that point out of the reports,
+ * until one with a code of 0. */
+enum send_string_step_type {
+    SEND_STRING_KEY_DOWN,
+    SEND_STRING_KEY_UP,
+    SEND_STRING_MODS_DOWN,
+    SEND_STRING_MODS_UP,
+    SEND_STRING_SUPPRESS_MODS,
+};
+
+void send_string_add_step(uint8_t type, uint8_t code);
+void send_string_add_char_steps(char ascii_code);
+void send_string_add_delay(uint16_t ms);
+bool send_unicode_async(uint32_t code_point);
+
 void send_dword(uint32_t number);
 void send_word(uint16_t number);
 void send_byte(uint8_t number);
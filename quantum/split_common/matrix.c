@@ -280,6 +280,8 @@ bool matrix_post_scan(void) {
             }
         }
 
+        matrix_update_dirty_rows(thatHand, ROWS_PER_HAND, changed);
+
         matrix_scan_quantum();
     } else {
         transport_slave(matrix + thatHand, matrix + thisHand);
@@ -306,6 +308,7 @@ uint8_t matrix_scan(void) {
 #endif
 
     debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, local_changed);
+    matrix_update_dirty_rows(thisHand, ROWS_PER_HAND, local_changed);
 
     bool remote_changed = matrix_post_scan();
     return (uint8_t)(local_changed || remote_changed);
@@ -16,4 +16,12 @@
 // When using serial and RGBLIGHT_SPLIT need separate transaction
 #        define SERIAL_USE_MULTI_TRANSACTION
 #    endif
+#    if defined(SPLIT_TRANSPORT_DELTA)
+// The delta transport sends the master state in a separate transaction
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+#    if defined(SPLIT_TRANSACTIONS_MAX) && SPLIT_TRANSACTIONS_MAX > 0
+// Every registered transaction is a separate transaction
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
 #endif
@@ -0,0 +1,28 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// The keyboard of the split_transport test, its halves are linked by serial
+
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 8
+
+#define SPLIT_TRANSPORT_DELTA
+#define SPLIT_TRANSPORT_MIRROR
+#define SPLIT_TRANSPORT_RESYNC_INTERVAL 500
+#define SERIAL_USE_MULTI_TRANSACTION
+#define DISABLE_SYNC_TIMER
@@ -0,0 +1,111 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "led_governor.h"
+#include "transactions.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+namespace {
+
+// The fake transport, the master and the slave are the same process.
+bool                 is_master = true;
+bool                 slave_pending;
+uint8_t              slave_level;
+std::vector<uint8_t> sent;
+
+}  // namespace
+
+extern "C" {
+
+bool is_keyboard_master(void) { return is_master; }
+
+bool transport_register_transaction(split_transaction_id_t id, const split_transaction_t* transaction) { return true; }
+
+bool transport_exchange_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {
+    slave_level   = *(uint8_t*)transaction->m2s_buffer;
+    slave_pending = true;
+    sent.push_back(slave_level);
+    return true;
+}
+
+bool transport_receive_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {
+    if (!slave_pending) return false;
+    slave_pending                      = false;
+    *(uint8_t*)transaction->m2s_buffer = slave_level;
+    return true;
+}
+
+void transport_publish_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {}
+}
+
+class SplitLedGovernor : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        is_master     = true;
+        slave_pending = false;
+        // starts a new measurement
+        advance_time(LED_GOVERNOR_INTERVAL);
+        led_governor_task();
+        led_governor_set_level(0);
+        split_transactions_init();
+        split_transactions_master();
+        sent.clear();
+    }
+
+    // Scans for one interval of the governor at the given rate
+    void scan_at(uint32_t scans_per_second) {
+        for (uint32_t scans = scans_per_second * LED_GOVERNOR_INTERVAL / 1000; scans > 1; scans--) {
+            led_governor_task();
+        }
+        advance_time(LED_GOVERNOR_INTERVAL);
+        led_governor_task();
+    }
+};
+
+TEST_F(SplitLedGovernor, MasterSendsItsLevel) {
+    scan_at(LED_GOVERNOR_MIN_SCAN_RATE / 2);
+    ASSERT_EQ(led_governor_get_level(), 1);
+    split_transactions_master();
+    EXPECT_EQ(sent, std::vector<uint8_t>({1}));
+
+    // unchanged levels are only sent again once in a while
+    split_transactions_master();
+    EXPECT_EQ(sent, std::vector<uint8_t>({1}));
+}
+
+TEST_F(SplitLedGovernor, SlaveUsesTheLevelOfTheMaster) {
+    is_master = false;
+
+    // the slave doesn't measure its own scan rate
+    scan_at(LED_GOVERNOR_MIN_SCAN_RATE / 2);
+    EXPECT_EQ(led_governor_get_level(), 0);
+
+    slave_level   = 3;
+    slave_pending = true;
+    split_transactions_slave();
+    EXPECT_EQ(led_governor_get_level(), 3);
+
+    scan_at(LED_GOVERNOR_MIN_SCAN_RATE * 2);
+    EXPECT_EQ(led_governor_get_level(), 3);
+}
@@ -0,0 +1,136 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+
+extern matrix_row_t matrix[MATRIX_ROWS];
+
+// What the debouncer of the keyboard would report
+static bool debouncing = false;
+bool        debounce_active(void) { return debouncing; }
+
+// matrix_common.c is linked on its own, without the rest of quantum
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {}
+void debounce_init(uint8_t num_rows) {}
+void matrix_init_quantum(void) {}
+void matrix_scan_quantum(void) {}
+}
+
+// Each half publishes its own rows, like split_common/matrix.c does
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+class SplitMatrix : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(1000);
+        debouncing = false;
+        memset(matrix, 0, sizeof(matrix));
+        matrix_update_dirty_rows(0, MATRIX_ROWS, true);
+        dirty_rows();
+    }
+
+    std::vector<uint8_t> dirty_rows() {
+        uint8_t rows[MATRIX_DIRTY_ROWS_SIZE];
+        EXPECT_TRUE(matrix_get_dirty_rows(rows));
+        std::vector<uint8_t> dirty;
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            if (rows[row / 8] & (1 << (row % 8))) dirty.push_back(row);
+        }
+        return dirty;
+    }
+};
+
+TEST_F(SplitMatrix, EachHandMarksOnlyItsRows) {
+    matrix[1]                 = 0x01;
+    matrix[ROWS_PER_HAND + 4] = 0x80;
+
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>({1}));
+
+    matrix_update_dirty_rows(ROWS_PER_HAND, ROWS_PER_HAND, true);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>({ROWS_PER_HAND + 4}));
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>());
+}
+
+TEST_F(SplitMatrix, RowsStayDirtyUntilRead) {
+    matrix[0] = 0x01;
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+    matrix[ROWS_PER_HAND + 1] = 0x02;
+    matrix_update_dirty_rows(ROWS_PER_HAND, ROWS_PER_HAND, true);
+
+    // both halves were scanned before keyboard_task() picked them up
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>({0, ROWS_PER_HAND + 1}));
+}
+
+TEST_F(SplitMatrix, RowsThatDidntChangeAreNotDirty) {
+    matrix[2] = 0x04;
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>({2}));
+
+    // scanned again with the same rows
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>());
+}
+
+TEST_F(SplitMatrix, UnchangedScansAreSkipped) {
+    // the raw matrix didn't change and nothing is being debounced, so the rows aren't compared
+    matrix[1] = 0x01;
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, false);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>());
+
+    // the change is picked up with the next one
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>({1}));
+}
+
+TEST_F(SplitMatrix, DebouncedChangesArePickedUp) {
+    // the raw change is still being debounced
+    debouncing = true;
+    matrix_update_dirty_rows(ROWS_PER_HAND, ROWS_PER_HAND, true);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>());
+
+    // the debouncer lets it through on a scan where the raw matrix is unchanged
+    debouncing                = false;
+    matrix[ROWS_PER_HAND + 2] = 0x10;
+    matrix_update_dirty_rows(ROWS_PER_HAND, ROWS_PER_HAND, false);
+    EXPECT_EQ(dirty_rows(), std::vector<uint8_t>({ROWS_PER_HAND + 2}));
+}
+
+TEST_F(SplitMatrix, RowsKeepTheTimeTheyChanged) {
+    advance_time(10);
+    matrix[0] = 0x01;
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+    uint16_t pressed = timer_read() | 1;
+
+    advance_time(10);
+    matrix[ROWS_PER_HAND] = 0x01;
+    matrix_update_dirty_rows(ROWS_PER_HAND, ROWS_PER_HAND, true);
+    matrix_update_dirty_rows(0, ROWS_PER_HAND, true);
+
+    EXPECT_EQ(matrix_get_row_change_time(0), pressed);
+    EXPECT_EQ(matrix_get_row_change_time(ROWS_PER_HAND), timer_read() | 1);
+    EXPECT_NE(matrix_get_row_change_time(0), matrix_get_row_change_time(ROWS_PER_HAND));
+}
@@ -0,0 +1,45 @@
+# The transactions are scheduled against a fake transport, see transactions_tests.cpp
+
+split_transactions_DEFS := -DNO_DEBUG -DSPLIT_TRANSACTIONS_MAX=4 -DSPLIT_TRANSACTIONS_PER_SCAN=1
+
+split_transactions_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/transactions_tests.cpp \
+	$(QUANTUM_PATH)/split_common/transactions.c \
+	$(TMK_PATH)/common/test/timer.c
+
+split_transactions_INC := $(QUANTUM_PATH)/split_common
+
+# The serial transport with SPLIT_TRANSPORT_DELTA, over a fake serial link, see transport_tests.cpp and config.h
+
+split_transport_DEFS := -DNO_DEBUG
+
+split_transport_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/transport_tests.cpp \
+	$(QUANTUM_PATH)/split_common/transport.c \
+	$(QUANTUM_PATH)/split_common/transactions.c \
+	$(TMK_PATH)/common/test/timer.c
+
+split_transport_INC := $(QUANTUM_PATH)/split_common/tests $(QUANTUM_PATH)/split_common $(DRIVER_PATH)/avr
+
+# The dirty rows of matrix_common.c, as each half of split_common/matrix.c publishes them, see matrix_tests.cpp
+
+split_matrix_DEFS := -DNO_DEBUG -DNO_PRINT
+split_matrix_CONFIG := $(QUANTUM_PATH)/split_common/tests/matrix_config.h
+
+split_matrix_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/matrix_tests.cpp \
+	$(QUANTUM_PATH)/matrix_common.c \
+	$(QUANTUM_PATH)/bitwise.c \
+	$(TMK_PATH)/common/test/timer.c
+
+# The level of the LED governor, sent from the master to the slave, see led_governor_tests.cpp
+
+split_led_governor_DEFS := -DNO_DEBUG -DRGB_MATRIX_ENABLE -DSPLIT_KEYBOARD -DSPLIT_TRANSACTIONS_MAX=1 -DLED_GOVERNOR_MIN_SCAN_RATE=1000
+
+split_led_governor_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/led_governor_tests.cpp \
+	$(QUANTUM_PATH)/led_governor.c \
+	$(QUANTUM_PATH)/split_common/transactions.c \
+	$(TMK_PATH)/common/test/timer.c
+
+split_led_governor_INC := $(QUANTUM_PATH)/split_common
@@ -0,0 +1 @@
+TEST_LIST += split_transactions split_transport split_matrix split_led_governor
@@ -0,0 +1,249 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "transactions.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+namespace {
+
+// The transactions registered by split_transactions_init_user(), and what each one saw.
+struct TestTransaction {
+    split_transaction_t transaction = {};
+    uint8_t             m2s         = 0;
+    uint8_t             s2m         = 0;
+    bool                changed     = false;
+    int                 done        = 0;
+    int                 received    = 0;
+};
+
+std::vector<TestTransaction*> registering;
+std::vector<TestTransaction*> registered;
+
+// The fake transport, the master and the slave are the same process.
+std::vector<int> exchanged;
+bool             transport_fails = false;
+int              transport_room  = 255;
+uint8_t          slave_m2s[SPLIT_TRANSACTIONS_MAX];
+uint8_t          slave_s2m[SPLIT_TRANSACTIONS_MAX];
+bool             slave_pending[SPLIT_TRANSACTIONS_MAX];
+
+TestTransaction* find(const split_transaction_t* transaction) {
+    for (TestTransaction* test : registered) {
+        if (&test->transaction == transaction) return test;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+extern "C" {
+
+void split_transactions_init_user(void) {
+    registered.clear();
+    for (TestTransaction* test : registering) {
+        if (split_transaction_register(&test->transaction) != INVALID_SPLIT_TRANSACTION) {
+            registered.push_back(test);
+        }
+    }
+}
+
+bool transport_register_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {
+    int size = transaction->m2s_size + transaction->s2m_size;
+    if (size > transport_room) return false;
+    transport_room -= size;
+    return true;
+}
+
+bool transport_exchange_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {
+    if (transport_fails) return false;
+    exchanged.push_back(id);
+    if (transaction->m2s_size) {
+        slave_m2s[id]     = *(uint8_t*)transaction->m2s_buffer;
+        slave_pending[id] = true;
+    }
+    if (transaction->s2m_size) {
+        *(uint8_t*)transaction->s2m_buffer = slave_s2m[id];
+    }
+    return true;
+}
+
+bool transport_receive_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {
+    if (!slave_pending[id]) return false;
+    slave_pending[id]                  = false;
+    *(uint8_t*)transaction->m2s_buffer = slave_m2s[id];
+    return true;
+}
+
+void transport_publish_transaction(split_transaction_id_t id, const split_transaction_t* transaction) {
+    if (transaction->s2m_size) {
+        slave_s2m[id] = *(uint8_t*)transaction->s2m_buffer;
+    }
+}
+}
+
+namespace {
+
+bool prepare(TestTransaction* test) {
+    bool changed  = test->changed;
+    test->changed = false;
+    return changed;
+}
+
+// Master callbacks can't carry a context, so every test transaction gets its own trampolines.
+template <int N>
+struct Callbacks {
+    static TestTransaction* test;
+    static bool             prepare_cb(void) { return prepare(test); }
+    static void             done_cb(void) { test->done++; }
+    static void             update_cb(bool received) {
+        if (received) test->received++;
+    }
+};
+template <int N>
+TestTransaction* Callbacks<N>::test;
+
+template <int N>
+void setup(TestTransaction& test, uint16_t interval, uint8_t priority) {
+    Callbacks<N>::test              = &test;
+    test.transaction.m2s_buffer     = &test.m2s;
+    test.transaction.m2s_size       = 1;
+    test.transaction.s2m_buffer     = &test.s2m;
+    test.transaction.s2m_size       = 1;
+    test.transaction.interval       = interval;
+    test.transaction.priority       = priority;
+    test.transaction.prepare        = Callbacks<N>::prepare_cb;
+    test.transaction.done           = Callbacks<N>::done_cb;
+    test.transaction.update         = Callbacks<N>::update_cb;
+}
+
+}  // namespace
+
+class SplitTransactions : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(0);
+        exchanged.clear();
+        transport_fails = false;
+        transport_room  = 255;
+        for (int i = 0; i < SPLIT_TRANSACTIONS_MAX; i++) {
+            slave_m2s[i]     = 0;
+            slave_s2m[i]     = 0;
+            slave_pending[i] = false;
+        }
+        setup<0>(lighting, 0, 10);
+        setup<1>(display, 100, 20);
+        setup<2>(user, 0, 0);
+        registering = {&lighting, &display, &user};
+    }
+
+    // initializes both halves, and lets the transactions registered as pending go through
+    void init() {
+        split_transactions_init();
+        scan(4);
+        exchanged.clear();
+    }
+
+    void scan(int count = 1) {
+        for (int i = 0; i < count; i++) {
+            split_transactions_master();
+            split_transactions_slave();
+            advance_time(1);
+        }
+    }
+
+    TestTransaction lighting, display, user;
+};
+
+TEST_F(SplitTransactions, EveryTransactionIsSentOnceAfterInit) {
+    split_transactions_init();
+    ASSERT_EQ(registered.size(), 3u);
+    scan(3);
+    EXPECT_EQ(exchanged, (std::vector<int>{2, 0, 1}));
+    scan(10);
+    EXPECT_EQ(exchanged.size(), 3u);
+}
+
+TEST_F(SplitTransactions, OnlyChangedTransactionsAreSent) {
+    init();
+    lighting.changed = true;
+    lighting.m2s     = 42;
+    scan();
+    EXPECT_EQ(exchanged, (std::vector<int>{0}));
+    EXPECT_EQ(lighting.done, 2);
+    EXPECT_EQ(lighting.received, 2);
+    EXPECT_EQ(slave_m2s[0], 42);
+    scan(10);
+    EXPECT_EQ(exchanged.size(), 1u);
+}
+
+TEST_F(SplitTransactions, IntervalTransactionsArePolled) {
+    init();
+    scan(250);
+    EXPECT_EQ(std::count(exchanged.begin(), exchanged.end(), 1), 2);
+    EXPECT_EQ(std::count(exchanged.begin(), exchanged.end(), 2), 0);
+}
+
+TEST_F(SplitTransactions, HigherPriorityGoesFirstOnePerScan) {
+    init();
+    lighting.changed = true;
+    display.changed  = true;
+    user.changed     = true;
+    scan();
+    EXPECT_EQ(exchanged, (std::vector<int>{2}));
+    scan();
+    EXPECT_EQ(exchanged, (std::vector<int>{2, 0}));
+    scan();
+    EXPECT_EQ(exchanged, (std::vector<int>{2, 0, 1}));
+}
+
+TEST_F(SplitTransactions, FailedExchangeIsRetried) {
+    init();
+    lighting.changed = true;
+    transport_fails  = true;
+    scan(5);
+    EXPECT_EQ(lighting.done, 1);
+    transport_fails = false;
+    scan();
+    EXPECT_EQ(exchanged, (std::vector<int>{0}));
+    EXPECT_EQ(lighting.done, 2);
+}
+
+TEST_F(SplitTransactions, RegistrationFailsWithoutRoom) {
+    transport_room = 3;
+    split_transactions_init();
+    EXPECT_EQ(registered.size(), 1u);
+
+    TestTransaction extra[SPLIT_TRANSACTIONS_MAX];
+    registering.clear();
+    for (auto& test : extra) {
+        setup<3>(test, 0, 0);
+        registering.push_back(&test);
+    }
+    registering.push_back(&user);
+    transport_room = 255;
+    split_transactions_init();
+    EXPECT_EQ(registered.size(), (size_t)SPLIT_TRANSACTIONS_MAX);
+}
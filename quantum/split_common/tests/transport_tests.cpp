@@ -0,0 +1,141 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "config.h"
+#include "transport.h"
+#include "serial.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+namespace {
+
+// What went over the fake serial link in each transaction, the master and the slave are the same process and share its buffers.
+struct Transfer {
+    int  m2s;
+    int  s2m;
+    bool operator==(const Transfer& other) const { return m2s == other.m2s && s2m == other.s2m; }
+};
+
+SSTD_t*               sstd_table;
+std::vector<Transfer> transfers;
+
+const Transfer slave_seq    = {0, 1};
+const Transfer slave_state  = {0, ROWS_PER_HAND * sizeof(matrix_row_t)};
+const Transfer master_state = {ROWS_PER_HAND * sizeof(matrix_row_t), 0};
+
+int count(const Transfer& transfer) { return std::count(transfers.begin(), transfers.end(), transfer); }
+
+int payload() {
+    int bytes = 0;
+    for (auto& transfer : transfers) {
+        bytes += transfer.m2s + transfer.s2m;
+    }
+    return bytes;
+}
+
+}  // namespace
+
+extern "C" {
+
+void soft_serial_initiator_init(SSTD_t* table, int size) { sstd_table = table; }
+
+void soft_serial_target_init(SSTD_t* table, int size) { sstd_table = table; }
+
+int soft_serial_transaction(int index) {
+    SSTD_t* sstd = &sstd_table[index];
+    transfers.push_back({sstd->initiator2target_buffer_size, sstd->target2initiator_buffer_size});
+    if (sstd->initiator2target_buffer_size) {
+        *sstd->status = TRANSACTION_ACCEPTED;
+    }
+    return TRANSACTION_END;
+}
+}
+
+class SplitTransport : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(0);
+        transport_master_init();
+        transport_slave_init();
+        memset(master_rows, 0, sizeof(master_rows));
+        memset(slave_rows, 0, sizeof(slave_rows));
+        // the first scan sends everything
+        scan();
+        transfers.clear();
+    }
+
+    void scan(int count = 1) {
+        for (int i = 0; i < count; i++) {
+            transport_slave(mirrored_rows, slave_rows);
+            ASSERT_TRUE(transport_master(master_rows, received_rows));
+            advance_time(1);
+        }
+    }
+
+    // what each half scanned, and what it got from the other half
+    matrix_row_t master_rows[ROWS_PER_HAND];
+    matrix_row_t slave_rows[ROWS_PER_HAND];
+    matrix_row_t received_rows[ROWS_PER_HAND];
+    matrix_row_t mirrored_rows[ROWS_PER_HAND];
+};
+
+TEST_F(SplitTransport, UnchangedStateSendsNoPayload) {
+    scan(100);
+    EXPECT_EQ(count(slave_seq), 100);
+    EXPECT_EQ(count(slave_state), 0);
+    EXPECT_EQ(count(master_state), 0);
+    // the sequence number of the slave is all that goes over
+    EXPECT_EQ(payload(), 100);
+}
+
+TEST_F(SplitTransport, SlaveChangesAreSentOnce) {
+    slave_rows[1] = 0x12;
+    scan(10);
+    EXPECT_EQ(count(slave_state), 1);
+    EXPECT_EQ(received_rows[1], 0x12);
+
+    slave_rows[1] = 0;
+    scan(10);
+    EXPECT_EQ(count(slave_state), 2);
+    EXPECT_EQ(received_rows[1], 0);
+    EXPECT_EQ(count(master_state), 0);
+}
+
+TEST_F(SplitTransport, MasterChangesAreSentOnce) {
+    master_rows[0] = 0x34;
+    scan(10);
+    EXPECT_EQ(count(master_state), 1);
+    scan();
+    EXPECT_EQ(mirrored_rows[0], 0x34);
+    EXPECT_EQ(count(slave_state), 0);
+}
+
+TEST_F(SplitTransport, EverythingIsSentAgainAtTheResyncInterval) {
+    scan(SPLIT_TRANSPORT_RESYNC_INTERVAL + 1);
+    EXPECT_EQ(count(slave_state), 1);
+    EXPECT_EQ(count(master_state), 1);
+}
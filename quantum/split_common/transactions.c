@@ -0,0 +1,143 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Registered split transactions.
+Every matrix scan, once the matrix itself went through, the master asks each registered transaction
+whether it has changed data to send, or whether its interval elapsed, and exchanges the due ones with
+the slave in priority order, at most SPLIT_TRANSACTIONS_PER_SCAN of them. Those left over stay due and
+go first on the next scans, so that slow state such as lighting never delays the matrix.
+*/
+
+#include <stddef.h>
+#include "transactions.h"
+#include "timer.h"
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+#    include "led_governor.h"
+#endif
+
+#if SPLIT_TRANSACTIONS_MAX > 0
+
+typedef struct {
+    const split_transaction_t *transaction;
+    uint16_t                   last_exchange;
+    bool                       pending;
+} split_transaction_state_t;
+
+static split_transaction_state_t transactions[SPLIT_TRANSACTIONS_MAX];
+static uint8_t                   transaction_count = 0;
+
+split_transaction_id_t split_transaction_register(const split_transaction_t *transaction) {
+    if (transaction_count >= SPLIT_TRANSACTIONS_MAX) {
+        return INVALID_SPLIT_TRANSACTION;
+    }
+
+    split_transaction_id_t id = transaction_count;
+    if (!transport_register_transaction(id, transaction)) {
+        return INVALID_SPLIT_TRANSACTION;
+    }
+    transactions[id].transaction   = transaction;
+    transactions[id].last_exchange = timer_read();
+    transactions[id].pending       = true;  // sent once right away
+    transaction_count++;
+    return id;
+}
+
+void split_transaction_request(split_transaction_id_t id) {
+    if (id >= 0 && id < transaction_count) {
+        transactions[id].pending = true;
+    }
+}
+
+// highest priority first, then the one that waited the longest
+static bool goes_before(split_transaction_state_t *a, split_transaction_state_t *b) {
+    if (a->transaction->priority != b->transaction->priority) {
+        return a->transaction->priority < b->transaction->priority;
+    }
+    return timer_elapsed(a->last_exchange) > timer_elapsed(b->last_exchange);
+}
+
+void split_transactions_master(void) {
+    for (uint8_t i = 0; i < transaction_count; i++) {
+        split_transaction_state_t *state       = &transactions[i];
+        const split_transaction_t *transaction = state->transaction;
+
+        if (transaction->prepare && transaction->prepare()) {
+            state->pending = true;
+        }
+        if (transaction->interval && timer_elapsed(state->last_exchange) >= transaction->interval) {
+            state->pending = true;
+        }
+    }
+
+    for (uint8_t exchanged = 0; exchanged < SPLIT_TRANSACTIONS_PER_SCAN; exchanged++) {
+        split_transaction_state_t *next = NULL;
+        for (uint8_t i = 0; i < transaction_count; i++) {
+            split_transaction_state_t *state = &transactions[i];
+            if (!state->pending) continue;
+            if (!next || goes_before(state, next)) {
+                next = state;
+            }
+        }
+        if (!next) break;
+
+        // a failed exchange stays pending, and is retried on the next scan
+        if (!transport_exchange_transaction(next - transactions, next->transaction)) break;
+        next->last_exchange = timer_read();
+        next->pending       = false;
+        if (next->transaction->done) {
+            next->transaction->done();
+        }
+    }
+}
+
+void split_transactions_slave(void) {
+    for (uint8_t i = 0; i < transaction_count; i++) {
+        const split_transaction_t *transaction = transactions[i].transaction;
+        bool                       received    = transport_receive_transaction(i, transaction);
+        if (transaction->update) {
+            transaction->update(received);
+        }
+        transport_publish_transaction(i, transaction);
+    }
+}
+
+#else
+
+split_transaction_id_t split_transaction_register(const split_transaction_t *transaction) { return INVALID_SPLIT_TRANSACTION; }
+
+void split_transaction_request(split_transaction_id_t id) {}
+
+void split_transactions_master(void) {}
+
+void split_transactions_slave(void) {}
+
+#endif
+
+__attribute__((weak)) void split_transactions_init_user(void) {}
+
+__attribute__((weak)) void split_transactions_init_kb(void) { split_transactions_init_user(); }
+
+void split_transactions_init(void) {
+#if SPLIT_TRANSACTIONS_MAX > 0
+    transaction_count = 0;
+#endif
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+    // ahead of the transactions of the keyboard, in the same order on both halves
+    led_governor_split_init();
+#endif
+    split_transactions_init_kb();
+}
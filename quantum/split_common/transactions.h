@@ -0,0 +1,82 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* number of transactions that can be registered, 0 disables registered transactions */
+#ifndef SPLIT_TRANSACTIONS_MAX
+#    define SPLIT_TRANSACTIONS_MAX 0
+#endif
+
+/* number of registered transactions exchanged at most per matrix scan, after the matrix itself */
+#ifndef SPLIT_TRANSACTIONS_PER_SCAN
+#    define SPLIT_TRANSACTIONS_PER_SCAN 1
+#endif
+
+typedef int8_t split_transaction_id_t;
+#define INVALID_SPLIT_TRANSACTION -1
+
+/** \brief Registered transaction
+ *
+ * State kept in sync between both halves, on top of what the split transport always exchanges. Both
+ * halves must register the same transactions, in the same order, from split_transactions_init_kb()
+ * or split_transactions_init_user().
+ */
+typedef struct {
+    void *   m2s_buffer;  // sent from the master to the slave, or NULL
+    uint8_t  m2s_size;
+    void *   s2m_buffer;  // sent back from the slave to the master, or NULL
+    uint8_t  s2m_size;
+    uint16_t interval;  // milliseconds between exchanges, or 0 to only exchange when prepare() asks for it
+    uint8_t  priority;  // when more transactions are due than SPLIT_TRANSACTIONS_PER_SCAN, lower goes first
+    // master, every scan: updates m2s_buffer, returns true if it changed and must be sent, may be NULL
+    bool (*prepare)(void);
+    // master: called once the exchange went through, s2m_buffer holds what the slave sent, may be NULL
+    void (*done)(void);
+    // slave, every scan: received is true when m2s_buffer was just updated, may update s2m_buffer, may be NULL
+    void (*update)(bool received);
+} split_transaction_t;
+
+/** \brief Registers a transaction
+ *
+ * The transaction must stay valid for as long as the keyboard runs. Returns INVALID_SPLIT_TRANSACTION
+ * if SPLIT_TRANSACTIONS_MAX transactions are already registered, or if the transport has no room left.
+ *
+ * With I2C, every transaction takes m2s_size + 1 + s2m_size slave registers after the built-in state,
+ * which already fills most of the default I2C_SLAVE_REG_COUNT of 30 on AVR. Raise it by the sum of
+ * these sizes in config.h, up to 256, or the registration fails.
+ */
+split_transaction_id_t split_transaction_register(const split_transaction_t *transaction);
+
+/** \brief Asks for a transaction to be exchanged on the next scan, whether its data changed or not */
+void split_transaction_request(split_transaction_id_t id);
+
+void split_transactions_init(void);
+void split_transactions_init_kb(void);
+void split_transactions_init_user(void);
+
+/* called by the transport after the matrix was exchanged */
+void split_transactions_master(void);
+void split_transactions_slave(void);
+
+/* implemented by the transport */
+bool transport_register_transaction(split_transaction_id_t id, const split_transaction_t *transaction);
+bool transport_exchange_transaction(split_transaction_id_t id, const split_transaction_t *transaction);
+bool transport_receive_transaction(split_transaction_id_t id, const split_transaction_t *transaction);
+void transport_publish_transaction(split_transaction_id_t id, const split_transaction_t *transaction);
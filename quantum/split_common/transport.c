@@ -4,10 +4,15 @@
 #include "config.h"
 #include "matrix.h"
 #include "quantum.h"
+#include "transactions.h"
 
 #define ROWS_PER_HAND (MATRIX_ROWS / 2)
 #define SYNC_TIMER_OFFSET 2
 
+#ifndef SPLIT_TRANSPORT_RESYNC_INTERVAL
+#    define SPLIT_TRANSPORT_RESYNC_INTERVAL 500
+#endif
+
 #ifdef RGBLIGHT_ENABLE
 #    include "rgblight.h"
 #endif
@@ -22,6 +27,23 @@ static pin_t encoders_pad[] = ENCODERS_PAD_A;
 #    define NUMBER_OF_ENCODERS (sizeof(encoders_pad) / sizeof(pin_t))
 #endif
 
+#ifdef SPLIT_TRANSPORT_DELTA
+// With the delta transport, only what changed is sent over. Everything is still sent every
+// SPLIT_TRANSPORT_RESYNC_INTERVAL milliseconds, to recover from a lost update or a reset of the other half.
+static uint32_t last_full_sync = 0;
+static bool     synced         = false;
+
+static bool full_sync_due(void) { return !synced || timer_elapsed32(last_full_sync) >= SPLIT_TRANSPORT_RESYNC_INTERVAL; }
+
+static void full_sync_done(void) {
+    synced         = true;
+    last_full_sync = timer_read32();
+}
+#else
+#    define full_sync_due() false
+#    define full_sync_done()
+#endif
+
 #if defined(USE_I2C)
 
 #    include "i2c_master.h"
@@ -34,7 +56,14 @@ typedef struct _I2C_slave_buffer_t {
 #    ifdef SPLIT_TRANSPORT_MIRROR
     matrix_row_t mmatrix[ROWS_PER_HAND];
 #    endif
+#    ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t s2m_seq;  // bumped by the slave whenever smatrix or encoder_state change
+#    endif
+    // smatrix and encoder_state are kept together so that they can be read at once
     matrix_row_t smatrix[ROWS_PER_HAND];
+#    ifdef ENCODER_ENABLE
+    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+#    endif
 #    ifdef SPLIT_MODS_ENABLE
     uint8_t real_mods;
     uint8_t weak_mods;
@@ -48,9 +77,6 @@ typedef struct _I2C_slave_buffer_t {
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     rgblight_syncinfo_t rgblight_sync;
 #    endif
-#    ifdef ENCODER_ENABLE
-    uint8_t encoder_state[NUMBER_OF_ENCODERS];
-#    endif
 #    ifdef WPM_ENABLE
     uint8_t current_wpm;
 #    endif
@@ -68,6 +94,13 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #    define I2C_RGB_START offsetof(I2C_slave_buffer_t, rgblight_sync)
 #    define I2C_ENCODER_START offsetof(I2C_slave_buffer_t, encoder_state)
 #    define I2C_WPM_START offsetof(I2C_slave_buffer_t, current_wpm)
+#    define I2C_S2M_SEQ_START offsetof(I2C_slave_buffer_t, s2m_seq)
+
+#    ifdef ENCODER_ENABLE
+#        define I2C_SLAVE_STATE_SIZE (I2C_ENCODER_START + sizeof(i2c_buffer->encoder_state) - I2C_KEYMAP_SLAVE_START)
+#    else
+#        define I2C_SLAVE_STATE_SIZE sizeof(i2c_buffer->smatrix)
+#    endif
 
 #    define TIMEOUT 100
 
@@ -75,18 +108,98 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #        define SLAVE_I2C_ADDRESS 0x32
 #    endif
 
+#    if SPLIT_TRANSACTIONS_MAX > 0
+// Registered transactions live in the slave registers after I2C_slave_buffer_t, each one as its
+// master to slave data, a sequence number bumped by every write of the master, and its slave to
+// master data.
+static uint8_t transaction_offset[SPLIT_TRANSACTIONS_MAX];
+static uint8_t transaction_seq[SPLIT_TRANSACTIONS_MAX];
+static uint8_t transactions_end = sizeof(I2C_slave_buffer_t);
+
+bool transport_register_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {
+    uint16_t size = transaction->m2s_size + 1 + transaction->s2m_size;
+    if (transactions_end + size > I2C_SLAVE_REG_COUNT) {
+        return false;
+    }
+    transaction_offset[id] = transactions_end;
+    transactions_end += size;
+    return true;
+}
+
+bool transport_exchange_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {
+    // the registers aren't used by the master, so the data is put together there
+    uint8_t *region = (uint8_t *)i2c_slave_reg + transaction_offset[id];
+    if (transaction->m2s_size) {
+        memcpy(region, transaction->m2s_buffer, transaction->m2s_size);
+        region[transaction->m2s_size]++;
+        if (i2c_writeReg(SLAVE_I2C_ADDRESS, transaction_offset[id], region, transaction->m2s_size + 1, TIMEOUT) < 0) {
+            return false;
+        }
+    }
+    if (transaction->s2m_size) {
+        if (i2c_readReg(SLAVE_I2C_ADDRESS, transaction_offset[id] + transaction->m2s_size + 1, transaction->s2m_buffer, transaction->s2m_size, TIMEOUT) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool transport_receive_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {
+    uint8_t *region = (uint8_t *)i2c_slave_reg + transaction_offset[id];
+    if (!transaction->m2s_size || region[transaction->m2s_size] == transaction_seq[id]) {
+        return false;
+    }
+    transaction_seq[id] = region[transaction->m2s_size];
+    memcpy(transaction->m2s_buffer, region, transaction->m2s_size);
+    return true;
+}
+
+void transport_publish_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {
+    uint8_t *region = (uint8_t *)i2c_slave_reg + transaction_offset[id];
+    if (transaction->s2m_size) {
+        memcpy(region + transaction->m2s_size + 1, transaction->s2m_buffer, transaction->s2m_size);
+    }
+}
+#    endif
+
 // Get rows from other half over i2c
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    // the writes are queued, so a failure of the previous ones only shows up now, and everything is sent again
+    bool full_sync = i2c_async_flush(TIMEOUT) < 0 || full_sync_due();
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // only read the slave state when the slave says it changed
+    uint8_t s2m_seq;
+    if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_S2M_SEQ_START, (void *)&s2m_seq, sizeof(s2m_seq), TIMEOUT) < 0) {
+        return false;
+    }
+    if (full_sync || s2m_seq != i2c_buffer->s2m_seq) {
+        if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_SLAVE_START, (void *)i2c_buffer->smatrix, I2C_SLAVE_STATE_SIZE, TIMEOUT) < 0) {
+            return false;
+        }
+        i2c_buffer->s2m_seq = s2m_seq;
+    }
+    memcpy((void *)slave_matrix, (void *)i2c_buffer->smatrix, sizeof(i2c_buffer->smatrix));
+#    else
     i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_SLAVE_START, (void *)slave_matrix, sizeof(i2c_buffer->smatrix), TIMEOUT);
+#    endif
 #    ifdef SPLIT_TRANSPORT_MIRROR
-    i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_MASTER_START, (void *)master_matrix, sizeof(i2c_buffer->mmatrix), TIMEOUT);
+#        ifdef SPLIT_TRANSPORT_DELTA
+    if (full_sync || memcmp((void *)master_matrix, (void *)i2c_buffer->mmatrix, sizeof(i2c_buffer->mmatrix)) != 0) {
+        if (i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_KEYMAP_MASTER_START, (void *)master_matrix, sizeof(i2c_buffer->mmatrix), TIMEOUT) >= 0) {
+            memcpy((void *)i2c_buffer->mmatrix, (void *)master_matrix, sizeof(i2c_buffer->mmatrix));
+        }
+    }
+#        else
+    i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_KEYMAP_MASTER_START, (void *)master_matrix, sizeof(i2c_buffer->mmatrix), TIMEOUT);
+#        endif
 #    endif
 
     // write backlight info
 #    ifdef BACKLIGHT_ENABLE
     uint8_t level = is_backlight_enabled() ? get_backlight_level() : 0;
-    if (level != i2c_buffer->backlight_level) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_BACKLIGHT_START, (void *)&level, sizeof(level), TIMEOUT) >= 0) {
+    if (full_sync || level != i2c_buffer->backlight_level) {
+        if (i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_BACKLIGHT_START, (void *)&level, sizeof(level), TIMEOUT) >= 0) {
             i2c_buffer->backlight_level = level;
         }
     }
@@ -96,6 +209,7 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
     if (rgblight_get_change_flags()) {
         rgblight_syncinfo_t rgblight_sync;
         rgblight_get_syncinfo(&rgblight_sync);
+        // synchronous, the change flags can't be set again if a queued write failed
         if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_RGB_START, (void *)&rgblight_sync, sizeof(rgblight_sync), TIMEOUT) >= 0) {
             rgblight_clear_change_flags();
         }
@@ -103,14 +217,16 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifndef SPLIT_TRANSPORT_DELTA
     i2c_readReg(SLAVE_I2C_ADDRESS, I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state), TIMEOUT);
+#        endif
     encoder_update_raw(i2c_buffer->encoder_state);
 #    endif
 
 #    ifdef WPM_ENABLE
     uint8_t current_wpm = get_current_wpm();
-    if (current_wpm != i2c_buffer->current_wpm) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_WPM_START, (void *)&current_wpm, sizeof(current_wpm), TIMEOUT) >= 0) {
+    if (full_sync || current_wpm != i2c_buffer->current_wpm) {
+        if (i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_WPM_START, (void *)&current_wpm, sizeof(current_wpm), TIMEOUT) >= 0) {
             i2c_buffer->current_wpm = current_wpm;
         }
     }
@@ -118,23 +234,23 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 
 #    ifdef SPLIT_MODS_ENABLE
     uint8_t real_mods = get_mods();
-    if (real_mods != i2c_buffer->real_mods) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_REAL_MODS_START, (void *)&real_mods, sizeof(real_mods), TIMEOUT) >= 0) {
+    if (full_sync || real_mods != i2c_buffer->real_mods) {
+        if (i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_REAL_MODS_START, (void *)&real_mods, sizeof(real_mods), TIMEOUT) >= 0) {
             i2c_buffer->real_mods = real_mods;
         }
     }
 
     uint8_t weak_mods = get_weak_mods();
-    if (weak_mods != i2c_buffer->weak_mods) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_WEAK_MODS_START, (void *)&weak_mods, sizeof(weak_mods), TIMEOUT) >= 0) {
+    if (full_sync || weak_mods != i2c_buffer->weak_mods) {
+        if (i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_WEAK_MODS_START, (void *)&weak_mods, sizeof(weak_mods), TIMEOUT) >= 0) {
             i2c_buffer->weak_mods = weak_mods;
         }
     }
 
 #        ifndef NO_ACTION_ONESHOT
     uint8_t oneshot_mods = get_oneshot_mods();
-    if (oneshot_mods != i2c_buffer->oneshot_mods) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_ONESHOT_MODS_START, (void *)&oneshot_mods, sizeof(oneshot_mods), TIMEOUT) >= 0) {
+    if (full_sync || oneshot_mods != i2c_buffer->oneshot_mods) {
+        if (i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_ONESHOT_MODS_START, (void *)&oneshot_mods, sizeof(oneshot_mods), TIMEOUT) >= 0) {
             i2c_buffer->oneshot_mods = oneshot_mods;
         }
     }
@@ -142,15 +258,38 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 #    endif
 
 #    ifndef DISABLE_SYNC_TIMER
-    i2c_buffer->sync_timer = sync_timer_read32() + SYNC_TIMER_OFFSET;
-    i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_SYNC_TIME_START, (void *)&i2c_buffer->sync_timer, sizeof(i2c_buffer->sync_timer), TIMEOUT);
+#        ifdef SPLIT_TRANSPORT_DELTA
+    // the timers drift slowly enough for the periodic resync to keep them close
+    if (full_sync)
+#        endif
+    {
+        i2c_buffer->sync_timer = sync_timer_read32() + SYNC_TIMER_OFFSET;
+        i2c_writeReg_async(SLAVE_I2C_ADDRESS, I2C_SYNC_TIME_START, (void *)&i2c_buffer->sync_timer, sizeof(i2c_buffer->sync_timer), TIMEOUT);
+    }
 #    endif
+
+    if (full_sync) {
+        full_sync_done();
+    }
+
+    split_transactions_master();
     return true;
 }
 
 void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_transactions_slave();
+
 #    ifndef DISABLE_SYNC_TIMER
+#        ifdef SPLIT_TRANSPORT_DELTA
+    // the master only sends the time now and then, and it's never the same twice
+    static uint32_t last_sync_timer = 0;
+    if (i2c_buffer->sync_timer != last_sync_timer) {
+        last_sync_timer = i2c_buffer->sync_timer;
+        sync_timer_update(last_sync_timer);
+    }
+#        else
     sync_timer_update(i2c_buffer->sync_timer);
+#        endif
 #    endif
     // Copy matrix to I2C buffer
     memcpy((void *)i2c_buffer->smatrix, (void *)slave_matrix, sizeof(i2c_buffer->smatrix));
@@ -175,6 +314,15 @@ void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
     encoder_state_raw(i2c_buffer->encoder_state);
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // bumped after the state is in place, so the master never skips a change
+    static uint8_t published_state[I2C_SLAVE_STATE_SIZE];
+    if (memcmp(published_state, (void *)i2c_buffer->smatrix, I2C_SLAVE_STATE_SIZE) != 0) {
+        memcpy(published_state, (void *)i2c_buffer->smatrix, I2C_SLAVE_STATE_SIZE);
+        i2c_buffer->s2m_seq++;
+    }
+#    endif
+
 #    ifdef WPM_ENABLE
     set_current_wpm(i2c_buffer->current_wpm);
 #    endif
@@ -188,9 +336,15 @@ void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 #    endif
 }
 
-void transport_master_init(void) { i2c_init(); }
+void transport_master_init(void) {
+    split_transactions_init();
+    i2c_init();
+}
 
-void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
+void transport_slave_init(void) {
+    split_transactions_init();
+    i2c_slave_init(SLAVE_I2C_ADDRESS);
+}
 
 #else  // USE_SERIAL
 
@@ -248,15 +402,41 @@ uint8_t volatile status_rgblight           = 0;
 volatile Serial_s2m_buffer_t serial_s2m_buffer = {};
 volatile Serial_m2s_buffer_t serial_m2s_buffer = {};
 uint8_t volatile status0                       = 0;
+#    ifdef SPLIT_TRANSPORT_DELTA
+// bumped by the slave whenever serial_s2m_buffer changes, the master reads the buffer only then
+uint8_t volatile serial_s2m_seq      = 0;
+uint8_t volatile status_slave_seq    = 0;
+uint8_t volatile status_master_state = 0;
+#    endif
+#    if SPLIT_TRANSACTIONS_MAX > 0
+uint8_t volatile status_transactions[SPLIT_TRANSACTIONS_MAX] = {};
+#    endif
 
 enum serial_transaction_id {
     GET_SLAVE_MATRIX = 0,
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     PUT_RGBLIGHT,
 #    endif
+#    ifdef SPLIT_TRANSPORT_DELTA
+    GET_SLAVE_SEQ,
+    PUT_MASTER_STATE,
+#    endif
+    FIRST_REGISTERED_TRANSACTION,
 };
 
-SSTD_t transactions[] = {
+// the transaction id is sent as 4 bits
+#    if SPLIT_TRANSACTIONS_MAX > 16 - 4
+#        error SPLIT_TRANSACTIONS_MAX must be 12 or less with the serial transport
+#    endif
+
+SSTD_t transactions[FIRST_REGISTERED_TRANSACTION + SPLIT_TRANSACTIONS_MAX] = {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // the master state is only sent when it changes, see PUT_MASTER_STATE, and the slave state when GET_SLAVE_SEQ moved
+    [GET_SLAVE_MATRIX] =
+        {
+            (uint8_t *)&status0, 0, NULL, sizeof(serial_s2m_buffer), (uint8_t *)&serial_s2m_buffer  // no master to slave transfer
+        },
+#    else
     [GET_SLAVE_MATRIX] =
         {
             (uint8_t *)&status0,
@@ -265,17 +445,63 @@ SSTD_t transactions[] = {
             sizeof(serial_s2m_buffer),
             (uint8_t *)&serial_s2m_buffer,
         },
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     [PUT_RGBLIGHT] =
         {
             (uint8_t *)&status_rgblight, sizeof(serial_rgblight), (uint8_t *)&serial_rgblight, 0, NULL  // no slave to master transfer
         },
 #    endif
+#    ifdef SPLIT_TRANSPORT_DELTA
+    [GET_SLAVE_SEQ] =
+        {
+            (uint8_t *)&status_slave_seq, 0, NULL, sizeof(serial_s2m_seq), (uint8_t *)&serial_s2m_seq  // no master to slave transfer
+        },
+    [PUT_MASTER_STATE] =
+        {
+            (uint8_t *)&status_master_state, sizeof(serial_m2s_buffer), (uint8_t *)&serial_m2s_buffer, 0, NULL  // no slave to master transfer
+        },
+#    endif
 };
 
-void transport_master_init(void) { soft_serial_initiator_init(transactions, TID_LIMIT(transactions)); }
+static uint8_t transaction_count = FIRST_REGISTERED_TRANSACTION;
+
+#    if SPLIT_TRANSACTIONS_MAX > 0
+// Registered transactions are exchanged straight from and to their buffers.
+
+bool transport_register_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {
+    SSTD_t *sstd                       = &transactions[FIRST_REGISTERED_TRANSACTION + id];
+    sstd->status                       = (uint8_t *)&status_transactions[id];
+    sstd->initiator2target_buffer_size = transaction->m2s_size;
+    sstd->initiator2target_buffer      = transaction->m2s_buffer;
+    sstd->target2initiator_buffer_size = transaction->s2m_size;
+    sstd->target2initiator_buffer      = transaction->s2m_buffer;
+    transaction_count                  = FIRST_REGISTERED_TRANSACTION + id + 1;
+    return true;
+}
+
+bool transport_exchange_transaction(split_transaction_id_t id, const split_transaction_t *transaction) { return soft_serial_transaction(FIRST_REGISTERED_TRANSACTION + id) == TRANSACTION_END; }
+
+bool transport_receive_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {
+    if (status_transactions[id] != TRANSACTION_ACCEPTED) {
+        return false;
+    }
+    status_transactions[id] = TRANSACTION_END;
+    return true;
+}
+
+void transport_publish_transaction(split_transaction_id_t id, const split_transaction_t *transaction) {}
+#    endif
+
+void transport_master_init(void) {
+    split_transactions_init();
+    soft_serial_initiator_init(transactions, transaction_count);
+}
 
-void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMIT(transactions)); }
+void transport_slave_init(void) {
+    split_transactions_init();
+    soft_serial_target_init(transactions, transaction_count);
+}
 
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 
@@ -302,6 +528,41 @@ void transport_rgblight_slave(void) {
 #        define transport_rgblight_slave()
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+
+// Master state communication, only when it changed since it was last acknowledged by the slave.
+
+static void transport_master_state_master(void) {
+    static Serial_m2s_buffer_t acknowledged = {};
+    bool                       full_sync    = full_sync_due();
+
+    // the sync timer moves on every scan, so only the other fields decide whether to send
+    if (!full_sync && memcmp(&acknowledged, (void *)&serial_m2s_buffer, sizeof(acknowledged)) == 0) {
+        return;
+    }
+#        ifndef DISABLE_SYNC_TIMER
+    serial_m2s_buffer.sync_timer = sync_timer_read32() + SYNC_TIMER_OFFSET;
+#        endif
+    // if the slave didn't get it, it is sent again on the next scan
+    if (soft_serial_transaction(PUT_MASTER_STATE) != TRANSACTION_END) {
+        return;
+    }
+    memcpy(&acknowledged, (void *)&serial_m2s_buffer, sizeof(acknowledged));
+    if (full_sync) {
+        full_sync_done();
+    }
+}
+
+static bool transport_master_state_slave(void) {
+    if (status_master_state != TRANSACTION_ACCEPTED) {
+        return false;
+    }
+    status_master_state = TRANSACTION_END;
+    return true;
+}
+
+#    endif
+
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
 #    ifndef SERIAL_USE_MULTI_TRANSACTION
     if (soft_serial_transaction() != TRANSACTION_END) {
@@ -309,9 +570,24 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
     }
 #    else
     transport_rgblight_master();
+#        ifdef SPLIT_TRANSPORT_DELTA
+    // only get the slave state when the slave says it changed
+    static uint8_t last_seq = 0;
+    if (soft_serial_transaction(GET_SLAVE_SEQ) != TRANSACTION_END) {
+        return false;
+    }
+    bool slave_changed = serial_s2m_seq != last_seq || full_sync_due();
+    if (slave_changed) {
+        if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
+            return false;
+        }
+        last_seq = serial_s2m_seq;
+    }
+#        else
     if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
         return false;
     }
+#        endif
 #    endif
 
     // TODO:  if MATRIX_COLS > 8 change to unpack()
@@ -328,7 +604,14 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifdef SPLIT_TRANSPORT_DELTA
+    // the encoder state can only have changed along with the sequence number
+    if (slave_changed) {
+        encoder_update_raw((uint8_t *)serial_s2m_buffer.encoder_state);
+    }
+#        else
     encoder_update_raw((uint8_t *)serial_s2m_buffer.encoder_state);
+#        endif
 #    endif
 
 #    ifdef WPM_ENABLE
@@ -343,33 +626,59 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
     serial_m2s_buffer.oneshot_mods = get_oneshot_mods();
 #        endif
 #    endif
-#    ifndef DISABLE_SYNC_TIMER
+#    ifdef SPLIT_TRANSPORT_DELTA
+    transport_master_state_master();
+#    elif !defined(DISABLE_SYNC_TIMER)
     serial_m2s_buffer.sync_timer   = sync_timer_read32() + SYNC_TIMER_OFFSET;
 #    endif
+
+    split_transactions_master();
     return true;
 }
 
 void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     transport_rgblight_slave();
-#    ifndef DISABLE_SYNC_TIMER
-    sync_timer_update(serial_m2s_buffer.sync_timer);
+    split_transactions_slave();
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+    Serial_s2m_buffer_t previous;
+    memcpy(&previous, (void *)&serial_s2m_buffer, sizeof(previous));
 #    endif
 
     // TODO: if MATRIX_COLS > 8 change to pack()
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_s2m_buffer.smatrix[i] = slave_matrix[i];
-#    ifdef SPLIT_TRANSPORT_MIRROR
-        master_matrix[i]             = serial_m2s_buffer.mmatrix[i];
-#    endif
     }
-#    ifdef BACKLIGHT_ENABLE
-    backlight_set(serial_m2s_buffer.backlight_level);
-#    endif
 
 #    ifdef ENCODER_ENABLE
     encoder_state_raw((uint8_t *)serial_s2m_buffer.encoder_state);
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+    if (memcmp(&previous, (void *)&serial_s2m_buffer, sizeof(previous)) != 0) {
+        serial_s2m_seq++;
+    }
+
+    // the rest only changes when the master sent its state
+    if (!transport_master_state_slave()) {
+        return;
+    }
+#    endif
+
+#    ifndef DISABLE_SYNC_TIMER
+    sync_timer_update(serial_m2s_buffer.sync_timer);
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_MIRROR
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        master_matrix[i] = serial_m2s_buffer.mmatrix[i];
+    }
+#    endif
+
+#    ifdef BACKLIGHT_ENABLE
+    backlight_set(serial_m2s_buffer.backlight_level);
+#    endif
+
 #    ifdef WPM_ENABLE
     set_current_wpm(serial_m2s_buffer.current_wpm);
 #    endif
@@ -1,8 +1,13 @@
 TEST_LIST = $(notdir $(patsubst %/rules.mk,%,$(wildcard $(ROOT_DIR)/tests/*/rules.mk)))
 FULL_TESTS := $(TEST_LIST)
 
+include $(ROOT_DIR)/drivers/avr/tests/testlist.mk
+include $(ROOT_DIR)/drivers/oled/tests/testlist.mk
+include $(ROOT_DIR)/quantum/debounce/tests/testlist.mk
 include $(ROOT_DIR)/quantum/sequencer/tests/testlist.mk
 include $(ROOT_DIR)/quantum/serial_link/tests/testlist.mk
+include $(ROOT_DIR)/quantum/split_common/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/common/chibios/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
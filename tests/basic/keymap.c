@@ -29,8 +29,8 @@ const uint16_t PROGMEM
                     // 0    1      2      3        4        5        6       7            8      9
                     {KC_A, KC_B, KC_NO, KC_LSFT, KC_RSFT, KC_LCTL, COMBO1, SFT_T(KC_P), M(0), KC_NO},
                     {KC_EQL, KC_PLUS, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
-                    {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
-                    {KC_C, KC_D, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+                    {KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_NO, KC_NO, KC_NO, KC_NO},
+                    {KC_C, KC_D, SFT_T(KC_K), KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
                 },
 };
 
@@ -42,17 +42,11 @@ TEST_F(KeyPress, CorrectKeysAreReportedWhenTwoKeysArePressed) {
     TestDriver driver;
     press_key(1, 0);
     press_key(0, 3);
-    // Note that QMK only processes one key at a time
-    // See issue #1476 for more information
-    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
-    keyboard_task();
+    // Both keys changed in the same scan, so they are reported together
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_C)));
     keyboard_task();
     release_key(1, 0);
     release_key(0, 3);
-    // Note that the first key released is the first one in the matrix order
-    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
     keyboard_task();
 }
@@ -69,10 +63,6 @@ TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
     TestDriver driver;
     press_key(3, 0);
     press_key(0, 0);
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
-    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_LSFT)));
     keyboard_task();
     release_key(0, 0);
@@ -87,10 +77,6 @@ TEST_F(KeyPress, PressLeftShiftAndControl) {
     TestDriver driver;
     press_key(3, 0);
     press_key(5, 0);
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
-    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_LCTRL)));
     keyboard_task();
 }
@@ -99,14 +85,35 @@ TEST_F(KeyPress, LeftAndRightShiftCanBePressedAtTheSameTime) {
     TestDriver driver;
     press_key(3, 0);
     press_key(4, 0);
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
-    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_RSFT)));
     keyboard_task();
 }
 
+TEST_F(KeyPress, SixKeyChordIsReportedAfterOneScan) {
+    TestDriver driver;
+    InSequence s;
+    unsigned   scans    = 0;
+    bool       reported = false;
+
+    ON_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E, KC_F, KC_G, KC_H, KC_I, KC_J))).WillByDefault([&reported](report_keyboard_t&) { reported = true; });
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E, KC_F, KC_G, KC_H, KC_I, KC_J)));
+    for (uint8_t col = 0; col < 6; col++) {
+        press_key(col, 2);
+    }
+    while (!reported && scans < 6) {
+        run_one_scan_loop();
+        scans++;
+    }
+    EXPECT_EQ(scans, 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    for (uint8_t col = 0; col < 6; col++) {
+        release_key(col, 2);
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
 TEST_F(KeyPress, RightShiftLeftControlAndCharWithTheSameKey) {
     TestDriver driver;
     press_key(6, 0);
@@ -18,8 +18,11 @@
 #include "action_tapping.h"
 
 using testing::_;
+using testing::AnyNumber;
 using testing::InSequence;
 
+extern "C" void advance_time(uint32_t ms);
+
 class Tapping : public TestFixture {};
 
 TEST_F(Tapping, TapA_SHFT_T_KeyReportsKey) {
@@ -95,3 +98,81 @@ TEST_F(Tapping, ANewTapWithinTappingTermIsBuggy) {
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).Times(1);
     idle_for(TAPPING_TERM);
 }
+
+TEST_F(Tapping, SHFT_T_KeyIsStampedWhenTheMatrixChanged) {
+    TestDriver driver;
+
+    press_key(7, 0);
+    // Something slow ran between the matrix scan and the dispatch of the key event
+    advance_time(TAPPING_TERM + 1);
+    // The key has been held for longer than the tapping term since the matrix saw it
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Tapping, QueuedSHFT_T_KeyKeepsItsDetectionTime) {
+    TestDriver driver;
+
+    // Fill a whole batch so that the mod tap key has to wait in the queue
+    for (uint8_t col = 0; col < QMK_KEYS_PER_SCAN; col++) {
+        press_key(col, 2);
+    }
+    press_key(2, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    keyboard_task();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // A slow main loop iteration, the mod tap key is dispatched long after it was pressed
+    advance_time(TAPPING_TERM + 50);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The key has been held for longer than the tapping term since it was detected
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_LSFT)));
+    run_one_scan_loop();
+}
+
+TEST_F(Tapping, PendingRowsAreQueuedBeforeLaterChanges) {
+    TestDriver    driver;
+    const uint8_t keys[][2] = {{0, 0}, {1, 0}, {3, 0}, {4, 0}, {5, 0}, {0, 1}, {1, 1}, {0, 2}, {1, 2}, {2, 2}, {3, 2}, {4, 2}, {5, 2}};
+
+    // Leaves five presses of row 2 in the queue
+    for (auto &key : keys) {
+        press_key(key[0], key[1]);
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    run_one_scan_loop();
+
+    // The releases fill the queue, the release of KC_J and the press of KC_C stay pending
+    for (auto &key : keys) {
+        release_key(key[0], key[1]);
+    }
+    press_key(0, 3);
+    run_one_scan_loop();
+
+    // Rows 0 and 1 change after them, their events come last
+    for (uint8_t i = 0; i < 7; i++) {
+        press_key(keys[i][0], keys[i][1]);
+    }
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The release of KC_I that was still queued, then KC_J, KC_C and row 0 make up the next batch
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_B, KC_C, KC_LSFT, KC_RSFT, KC_LCTL)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    for (uint8_t i = 0; i < 7; i++) {
+        release_key(keys[i][0], keys[i][1]);
+    }
+    release_key(0, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    idle_for(3);
+}
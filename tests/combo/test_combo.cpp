@@ -0,0 +1,183 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "process_combo.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+extern "C" combo_t key_combos[];
+extern "C" int     COMBO_LEN;
+
+namespace {
+
+enum { AB_ESC, LONG_ENTER, FIRST_FILLER };
+
+const uint16_t ab_combo[]   = {KC_A, KC_B, COMBO_END};
+const uint16_t long_combo[] = {KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, COMBO_END};
+uint16_t       filler_combos[500][3];
+
+// The two combos used by the tests, followed by combos on the function keys that are never pressed
+// by the tests and only make the list longer.
+void use_combos(int count) {
+    key_combos[AB_ESC]     = COMBO(ab_combo, KC_ESC);
+    key_combos[LONG_ENTER] = COMBO(long_combo, KC_ENTER);
+    for (int i = FIRST_FILLER; i < count; i++) {
+        filler_combos[i][0] = KC_F1 + (i % 12);
+        filler_combos[i][1] = KC_F13 + (i / 12 % 12);
+        filler_combos[i][2] = COMBO_END;
+        key_combos[i]       = COMBO_ACTION(filler_combos[i]);
+    }
+    COMBO_LEN = count;
+    combo_rebuild_index();
+}
+
+keyrecord_t make_record(bool pressed) {
+    keyrecord_t record = {};
+    record.event.pressed = pressed;
+    record.event.time    = timer_read() | 1;
+    return record;
+}
+
+// Nanoseconds per process_combo() call for a sequence of key events, repeated.
+double measure(const std::vector<std::pair<uint16_t, bool>>& events, int repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+        for (const auto& event : events) {
+            keyrecord_t record = make_record(event.second);
+            process_combo(event.first, &record);
+        }
+    }
+    auto total = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(total).count() / (events.size() * repeat);
+}
+
+}  // namespace
+
+class Combo : public TestFixture {
+   protected:
+    void SetUp() override {
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        use_combos(100);
+        // combos only start matching once a key outside of any combo was seen with no combo keys down
+        press_key(2, 0);
+        run_one_scan_loop();
+        release_key(2, 0);
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+};
+
+TEST_F(Combo, ComboKeysPressedTogetherSendTheCombo) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    press_key(0, 0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AtLeast(1));
+    release_key(0, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, ComboKeyAloneIsSentWhenTheComboTermExpires) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(testing::AtLeast(1));
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, KeyOutsideOfAnyComboIsSentRightAway) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    press_key(2, 0);
+    run_one_scan_loop();
+    release_key(2, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, ComboOfMoreThanEightKeys) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ENTER)));
+    for (uint8_t col = 3; col < 12; col++) {
+        press_key(col, 0);
+        run_one_scan_loop();
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AtLeast(1));
+    for (uint8_t col = 3; col < 12; col++) {
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, Benchmark) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // a key in no combo, and a chord of two keys that completes the filler combos they are part of
+    std::vector<std::pair<uint16_t, bool>> plain = {{KC_C, true}, {KC_C, false}};
+    std::vector<std::pair<uint16_t, bool>> chord = {{KC_F3, true}, {KC_F13, true}, {KC_F13, false}, {KC_F3, false}};
+
+    for (int count : {10, 100, 500}) {
+        use_combos(count);
+        double plain_ns = measure(plain, 20000);
+        double chord_ns = measure(chord, 20000);
+
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(1) << plain_ns << " ns/event outside of combos, " << chord_ns << " ns/event in combos";
+        std::cout << "[ COMBO ] " << count << " combos: " << report.str() << std::endl;
+        RecordProperty("combos_" + std::to_string(count), report.str());
+    }
+    use_combos(100);
+}
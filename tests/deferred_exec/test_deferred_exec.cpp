@@ -0,0 +1,343 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "deferred_exec.h"
+#include "timer.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+extern "C" void advance_time(uint32_t ms);
+
+namespace {
+
+struct CallbackLog {
+    int            calls        = 0;
+    uint32_t       trigger_time = 0;
+    uint32_t       repeat       = 0;
+    int            repeats      = 0;
+    deferred_token cancel       = INVALID_DEFERRED_TOKEN;
+    deferred_token extend       = INVALID_DEFERRED_TOKEN;
+};
+
+uint32_t log_callback(uint32_t trigger_time, void *cb_arg) {
+    CallbackLog *log  = static_cast<CallbackLog *>(cb_arg);
+    log->trigger_time = trigger_time;
+    log->calls++;
+    if (log->cancel != INVALID_DEFERRED_TOKEN) {
+        cancel_deferred_exec(log->cancel);
+    }
+    if (log->extend != INVALID_DEFERRED_TOKEN) {
+        extend_deferred_exec(log->extend, 10);
+    }
+    return log->calls <= log->repeats ? log->repeat : 0;
+}
+
+// Takes every free executor, until the returned tokens are cancelled
+std::vector<deferred_token> exhaust_executors(CallbackLog *log) {
+    std::vector<deferred_token> tokens;
+    for (deferred_token token; (token = defer_exec(60000, log_callback, log)) != INVALID_DEFERRED_TOKEN;) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+void release_executors(const std::vector<deferred_token> &tokens) {
+    for (deferred_token token : tokens) {
+        cancel_deferred_exec(token);
+    }
+}
+
+}  // namespace
+
+class DeferredExec : public TestFixture {};
+
+TEST_F(DeferredExec, CallbackRunsOnceWhenDue) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog log;
+    uint32_t    start = timer_read32();
+
+    EXPECT_NE(defer_exec(10, log_callback, &log), INVALID_DEFERRED_TOKEN);
+    idle_for(10);
+    EXPECT_EQ(log.calls, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log.calls, 1);
+    EXPECT_EQ(log.trigger_time, start + 10);
+    idle_for(50);
+    EXPECT_EQ(log.calls, 1);
+}
+
+TEST_F(DeferredExec, CallbackIsRescheduledByItsReturnValue) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog log;
+    log.repeat  = 5;
+    log.repeats = 2;
+    uint32_t start = timer_read32();
+
+    defer_exec(3, log_callback, &log);
+    idle_for(4);
+    EXPECT_EQ(log.calls, 1);
+    idle_for(5);
+    EXPECT_EQ(log.calls, 2);
+    idle_for(5);
+    EXPECT_EQ(log.calls, 3);
+    EXPECT_EQ(log.trigger_time, start + 13);
+    idle_for(50);
+    EXPECT_EQ(log.calls, 3);
+}
+
+TEST_F(DeferredExec, CallbackDueAfterSeveralWheelTurnsRunsOnTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog log;
+
+    defer_exec(5 * DEFERRED_EXEC_WHEEL_SIZE + 3, log_callback, &log);
+    idle_for(5 * DEFERRED_EXEC_WHEEL_SIZE + 3);
+    EXPECT_EQ(log.calls, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log.calls, 1);
+}
+
+TEST_F(DeferredExec, CallbackRunsWhenTheMainLoopWasLate) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog log;
+    uint32_t    start = timer_read32();
+
+    defer_exec(5, log_callback, &log);
+    advance_time(3 * DEFERRED_EXEC_WHEEL_SIZE);
+    run_one_scan_loop();
+    EXPECT_EQ(log.calls, 1);
+    EXPECT_EQ(log.trigger_time, start + 5);
+}
+
+TEST_F(DeferredExec, CancelledCallbackNeverRuns) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog    log;
+    deferred_token token = defer_exec(10, log_callback, &log);
+
+    idle_for(5);
+    EXPECT_TRUE(cancel_deferred_exec(token));
+    EXPECT_FALSE(cancel_deferred_exec(token));
+    idle_for(50);
+    EXPECT_EQ(log.calls, 0);
+}
+
+TEST_F(DeferredExec, ExtendPostponesTheCallback) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog    log;
+    deferred_token token = defer_exec(10, log_callback, &log);
+
+    idle_for(8);
+    EXPECT_TRUE(extend_deferred_exec(token, 10));
+    idle_for(10);
+    EXPECT_EQ(log.calls, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(log.calls, 1);
+    EXPECT_FALSE(extend_deferred_exec(token, 10));
+}
+
+TEST_F(DeferredExec, StaleTokenDoesNotAffectANewCallback) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog    first, second;
+    deferred_token token = defer_exec(1, log_callback, &first);
+
+    idle_for(2);
+    EXPECT_EQ(first.calls, 1);
+    // the same executor is most likely reused, but the old token must not match it
+    deferred_token other = defer_exec(10, log_callback, &second);
+    EXPECT_NE(token, other);
+    EXPECT_FALSE(cancel_deferred_exec(token));
+    idle_for(11);
+    EXPECT_EQ(second.calls, 1);
+}
+
+TEST_F(DeferredExec, CallbackCanCancelAnotherOneDueAtTheSameTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog first, second;
+
+    deferred_token token = defer_exec(5, log_callback, &first);
+    second.cancel        = token;
+    first.cancel         = defer_exec(5, log_callback, &second);
+    idle_for(10);
+    EXPECT_EQ(first.calls + second.calls, 1);
+}
+
+TEST_F(DeferredExec, CallbackCanExtendAnotherOneDueAtTheSameTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog first, second;
+
+    deferred_token token = defer_exec(5, log_callback, &first);
+    second.extend        = token;
+    first.extend         = defer_exec(5, log_callback, &second);
+    idle_for(6);
+    EXPECT_EQ(first.calls + second.calls, 1);
+
+    // the other one runs once its extension expires
+    first.extend  = INVALID_DEFERRED_TOKEN;
+    second.extend = INVALID_DEFERRED_TOKEN;
+    idle_for(8);
+    EXPECT_EQ(first.calls + second.calls, 1);
+    idle_for(4);
+    EXPECT_EQ(first.calls, 1);
+    EXPECT_EQ(second.calls, 1);
+}
+
+TEST_F(DeferredExec, SchedulingFailsWhenAllExecutorsAreInUse) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    CallbackLog    log;
+    deferred_token tokens[MAX_DEFERRED_EXECUTORS];
+
+    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        tokens[i] = defer_exec(10, log_callback, &log);
+        EXPECT_NE(tokens[i], INVALID_DEFERRED_TOKEN);
+    }
+    EXPECT_EQ(defer_exec(10, log_callback, &log), INVALID_DEFERRED_TOKEN);
+    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        EXPECT_TRUE(cancel_deferred_exec(tokens[i]));
+    }
+    EXPECT_NE(defer_exec(1, log_callback, &log), INVALID_DEFERRED_TOKEN);
+    idle_for(2);
+    EXPECT_EQ(log.calls, 1);
+}
+
+TEST_F(DeferredExec, TapDanceFinishesWhenTheTappingTermExpires) {
+    TestDriver driver;
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    idle_for(TAPPING_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DeferredExec, TapDanceHeldPastTheTappingTermFinishesWhileHeld) {
+    TestDriver driver;
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    idle_for(TAPPING_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AtLeast(1));
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DeferredExec, TapDanceIsInterruptedByAnotherKey) {
+    TestDriver driver;
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    // the timeout was cancelled with the dance, so nothing else is sent
+    idle_for(TAPPING_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DeferredExec, TapDanceFinishesWhenNoExecutorIsFree) {
+    TestDriver  driver;
+    CallbackLog log;
+    auto        tokens = exhaust_executors(&log);
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    idle_for(TAPPING_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release_executors(tokens);
+    EXPECT_EQ(log.calls, 0);
+}
+
+TEST_F(DeferredExec, ComboTimesOutWhenNoExecutorIsFree) {
+    TestDriver  driver;
+    CallbackLog log;
+    auto        tokens = exhaust_executors(&log);
+
+    // combos become active once a key that isn't part of any is released
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    press_key(2, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D))).Times(testing::AtLeast(1));
+    idle_for(COMBO_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(2, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release_executors(tokens);
+}
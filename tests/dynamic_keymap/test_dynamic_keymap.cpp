@@ -0,0 +1,140 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "tmk_core/common/eeprom.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+namespace {
+
+// Writes a keycode behind the back of the dynamic keymap, as a host tool writing the EEPROM would
+void write_eeprom_keycode(uint8_t layer, uint8_t column, uint16_t keycode) {
+    uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(layer, 0, column);
+    eeprom_update_byte(address, keycode >> 8);
+    eeprom_update_byte(address + 1, keycode & 0xFF);
+}
+
+}  // namespace
+
+class DynamicKeymap : public TestFixture {
+   protected:
+    void SetUp() override {
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        dynamic_keymap_reset();
+        layer_clear();
+    }
+};
+
+TEST_F(DynamicKeymap, ResetLoadsTheKeymapFromFlash) {
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    dynamic_keymap_set_keycode(3, 0, 1, KC_Z);
+    dynamic_keymap_reset();
+
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_A);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 1), KC_B);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 1), KC_C);
+    EXPECT_EQ(dynamic_keymap_get_keycode(2, 0, 0), KC_D);
+    EXPECT_EQ(dynamic_keymap_get_keycode(3, 0, 1), KC_E);
+}
+
+TEST_F(DynamicKeymap, OnlyTheLowestLayersAreCached) {
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_A);
+
+    for (uint8_t layer = 0; layer < 4; layer++) {
+        write_eeprom_keycode(layer, 0, KC_F1 + layer);
+    }
+
+    // Looking up the upper layers many times reads them from the EEPROM, and doesn't evict the lower ones
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(dynamic_keymap_get_keycode(2, 0, 0), KC_F3);
+        EXPECT_EQ(dynamic_keymap_get_keycode(3, 0, 0), KC_F4);
+    }
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_A);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 0), KC_TRNS);
+
+    dynamic_keymap_clear_cache();
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_F1);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 0), KC_F2);
+}
+
+TEST_F(DynamicKeymap, SetKeycodeIsSeenOnEveryLayer) {
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_A);
+
+    for (uint8_t layer = 0; layer < 4; layer++) {
+        dynamic_keymap_set_keycode(layer, 0, 1, KC_F1 + layer);
+    }
+    for (uint8_t layer = 0; layer < 4; layer++) {
+        EXPECT_EQ(dynamic_keymap_get_keycode(layer, 0, 1), KC_F1 + layer);
+        EXPECT_EQ(dynamic_keymap_get_keycode(layer, 0, 0), layer == 0 ? KC_A : layer == 2 ? KC_D : KC_TRNS);
+    }
+}
+
+TEST_F(DynamicKeymap, SetBufferAcrossTheEndOfTheCache) {
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_A);
+
+    // the last keycode of layer 1 and the first of layer 2
+    uint8_t data[] = {0, KC_F1, 0, KC_F2};
+    dynamic_keymap_set_buffer(2 * MATRIX_COLS * 2 - 2, sizeof(data), data);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 0), KC_TRNS);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 1), KC_F1);
+    EXPECT_EQ(dynamic_keymap_get_keycode(2, 0, 0), KC_F2);
+
+    uint8_t read[sizeof(data)];
+    dynamic_keymap_get_buffer(2 * MATRIX_COLS * 2 - 2, sizeof(read), read);
+    EXPECT_EQ(memcmp(read, data, sizeof(data)), 0);
+}
+
+TEST_F(DynamicKeymap, KeyPressFallsThroughTheLayers) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(3);
+    layer_on(1);
+    layer_on(2);
+    layer_on(3);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+
+    dynamic_keymap_set_keycode(2, 0, 0, KC_TRNS);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+}
@@ -0,0 +1,75 @@
+/* Copyright 2017 Fred Sundvik
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+#include <iostream>
+
+using testing::_;
+
+namespace {
+const unsigned NUM_SCANS = 100000;
+
+double measure_idle_scan_ns(void) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < NUM_SCANS; i++) {
+        keyboard_task();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / NUM_SCANS;
+}
+}  // namespace
+
+class IdleScan : public TestFixture {
+public:
+    ~IdleScan() { set_dirty_rows_tracked(true); }
+};
+
+TEST_F(IdleScan, KeyInLastRowAndColumnIsReported) {
+    TestDriver driver;
+    set_dirty_rows_tracked(true);
+    press_key(21, 5);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F)));
+    run_one_scan_loop();
+    release_key(21, 5);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(IdleScan, KeyIsReportedWhenRowsAreNotTracked) {
+    TestDriver driver;
+    set_dirty_rows_tracked(false);
+    press_key(21, 5);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F)));
+    run_one_scan_loop();
+    release_key(21, 5);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(IdleScan, CostPerIdleScan) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+
+    set_dirty_rows_tracked(false);
+    double full_walk_ns = measure_idle_scan_ns();
+    set_dirty_rows_tracked(true);
+    double dirty_rows_ns = measure_idle_scan_ns();
+
+    std::cout << "Idle scan on a " << MATRIX_ROWS << "x" << MATRIX_COLS << " matrix: " << full_walk_ns << " ns with a full walk, " << dirty_rows_ns << " ns with dirty rows" << std::endl;
+    RecordProperty("full_walk_ns", std::to_string(full_walk_ns));
+    RecordProperty("dirty_rows_ns", std::to_string(dirty_rows_ns));
+}
@@ -0,0 +1,40 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// Mostly transparent layers, in RAM so that the tests can change them
+uint16_t test_keymap[8][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {{KC_A, KC_B}},
+    [1] = {{KC_TRNS, KC_TRNS}},
+    [2] = {{KC_TRNS, KC_TRNS}},
+    [3] = {{KC_TRNS, KC_C}},
+    [4] = {{KC_TRNS, KC_TRNS}},
+    [5] = {{KC_TRNS, KC_TRNS}},
+    [6] = {{KC_TRNS, KC_TRNS}},
+    [7] = {{KC_D, KC_TRNS}},
+};
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {{KC_A, KC_B}},
+};
+
+uint16_t keymap_lookups = 0;
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    keymap_lookups++;
+    return layer < 8 ? test_keymap[layer][key.row][key.col] : KC_NO;
+}
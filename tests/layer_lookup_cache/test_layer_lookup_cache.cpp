@@ -0,0 +1,134 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "action_layer.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+extern "C" uint16_t test_keymap[8][MATRIX_ROWS][MATRIX_COLS];
+extern "C" uint16_t keymap_lookups;
+
+namespace {
+
+const keypos_t left  = {.col = 0, .row = 0};
+const keypos_t right = {.col = 1, .row = 0};
+
+}  // namespace
+
+class LayerLookupCache : public TestFixture {
+   protected:
+    void SetUp() override {
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        layer_state_set(0xFE);
+    }
+    void TearDown() override {
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        test_keymap[5][0][0] = KC_TRNS;
+        default_layer_set(0);
+    }
+};
+
+TEST_F(LayerLookupCache, RepeatedLookupsDontReadTheKeymap) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    EXPECT_EQ(layer_switch_get_layer(left), 7);
+    EXPECT_EQ(layer_switch_get_layer(right), 3);
+
+    keymap_lookups = 0;
+    EXPECT_EQ(layer_switch_get_layer(left), 7);
+    EXPECT_EQ(layer_switch_get_layer(right), 3);
+    EXPECT_EQ(keymap_lookups, 0);
+
+    // the action itself is still read from the keymap, once
+    EXPECT_EQ(layer_switch_get_action(right).code, ACTION_KEY(KC_C));
+    EXPECT_EQ(keymap_lookups, 1);
+}
+
+TEST_F(LayerLookupCache, LayerChangesAreSeen) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    EXPECT_EQ(layer_switch_get_layer(left), 7);
+    EXPECT_EQ(layer_switch_get_layer(right), 3);
+
+    layer_off(7);
+    EXPECT_EQ(layer_switch_get_layer(left), 0);
+    layer_off(3);
+    EXPECT_EQ(layer_switch_get_layer(right), 0);
+    layer_on(3);
+    EXPECT_EQ(layer_switch_get_layer(right), 3);
+    layer_clear();
+    EXPECT_EQ(layer_switch_get_layer(right), 0);
+}
+
+TEST_F(LayerLookupCache, DefaultLayerChangesAreSeen) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    layer_clear();
+    EXPECT_EQ(layer_switch_get_layer(right), 0);
+
+    default_layer_set(1UL << 3);
+    EXPECT_EQ(layer_switch_get_layer(right), 3);
+    // layer 3 is transparent on the left, and layer 0 is not active
+    EXPECT_EQ(layer_switch_get_layer(left), 0);
+}
+
+TEST_F(LayerLookupCache, KeymapChangesAreSeenOnceTheCacheIsCleared) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    layer_off(7);
+    EXPECT_EQ(layer_switch_get_layer(left), 0);
+
+    test_keymap[5][0][0] = KC_E;
+    clear_layer_lookup_cache();
+    EXPECT_EQ(layer_switch_get_layer(left), 5);
+}
+
+TEST_F(LayerLookupCache, KeyPressUsesTheCachedLayer) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    layer_off(7);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,45 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {{KC_A, KC_B, GRAVE_ESC, UC_M_LN, SQ_TOG, RGB_TOG, LSFT_T(KC_G), KC_RIGHT, KC_I, TD(0), KC_K, KC_L}},
+};
+
+const uint16_t PROGMEM test_combo[] = {KC_K, KC_L, COMBO_END};
+combo_t                key_combos[COMBO_COUNT] = {COMBO(test_combo, KC_ESC)};
+
+qk_tap_dance_action_t tap_dance_actions[] = {ACTION_TAP_DANCE_DOUBLE(KC_J, KC_ESC)};
+
+// a single row of keys with one LED each
+led_config_t g_led_config = {
+    {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    {{0, 0}, {20, 0}, {40, 0}, {61, 0}, {81, 0}, {101, 0}, {122, 0}, {142, 0}, {162, 0}, {183, 0}, {203, 0}, {224, 0}},
+    {4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4},
+};
+
+static void mock_init(void) {}
+static void mock_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {}
+static void mock_set_color_all(uint8_t r, uint8_t g, uint8_t b) {}
+static void mock_flush(void) {}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = mock_init,
+    .set_color     = mock_set_color,
+    .set_color_all = mock_set_color_all,
+    .flush         = mock_flush,
+};
@@ -0,0 +1,27 @@
+# Copyright 2021 QMK
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+CUSTOM_MATRIX=yes
+AUTO_SHIFT_ENABLE=yes
+COMBO_ENABLE=yes
+DYNAMIC_MACRO_ENABLE=yes
+KEY_LOCK_ENABLE=yes
+LEADER_ENABLE=yes
+RGB_MATRIX_ENABLE=yes
+RGB_MATRIX_DRIVER=custom
+SEQUENCER_ENABLE=yes
+TAP_DANCE_ENABLE=yes
+UNICODE_ENABLE=yes
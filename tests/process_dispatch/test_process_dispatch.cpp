@@ -0,0 +1,103 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "quantum.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+namespace {
+
+// Columns of the keymap
+enum { COL_A, COL_B, COL_GRAVE_ESC, COL_UNICODE_MODE, COL_SEQUENCER, COL_RGB, COL_MOD_TAP, COL_RIGHT };
+
+keyrecord_t make_record(uint8_t col, bool pressed) {
+    keyrecord_t record   = {};
+    record.event.key     = (keypos_t){.col = col, .row = 0};
+    record.event.pressed = pressed;
+    record.event.time    = timer_read() | 1;
+    return record;
+}
+
+bool tap(uint8_t col) {
+    keyrecord_t press   = make_record(col, true);
+    bool        handled = !process_record_quantum(&press);
+    keyrecord_t release = make_record(col, false);
+    process_record_quantum(&release);
+    return handled;
+}
+
+}  // namespace
+
+class ProcessDispatch : public TestFixture {};
+
+TEST_F(ProcessDispatch, FeatureKeycodesReachTheirHandlers) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    EXPECT_TRUE(tap(COL_GRAVE_ESC));
+
+    set_unicode_input_mode(UC_MAC);
+    tap(COL_UNICODE_MODE);
+    EXPECT_EQ(get_unicode_input_mode(), UC_LNX);
+
+    bool sequencer_on = is_sequencer_on();
+    EXPECT_TRUE(tap(COL_SEQUENCER));
+    EXPECT_NE(is_sequencer_on(), sequencer_on);
+
+    bool rgb_enabled = rgb_matrix_is_enabled();
+    EXPECT_TRUE(tap(COL_RGB));
+    EXPECT_NE(rgb_matrix_is_enabled(), rgb_enabled);
+}
+
+TEST_F(ProcessDispatch, BasicKeycodesAreSent) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+
+    press_key(COL_B, 0);
+    run_one_scan_loop();
+    release_key(COL_B, 0);
+    idle_for(AUTO_SHIFT_TIMEOUT);
+}
+
+TEST_F(ProcessDispatch, Benchmark) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // a key that auto shift leaves alone, so no report is sent and only the dispatch is measured
+    const int taps  = 100000;
+    auto      start = std::chrono::steady_clock::now();
+    for (int i = 0; i < taps; i++) {
+        tap(COL_RIGHT);
+    }
+    auto   elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(0) << 2 * taps / seconds << " events/s, " << std::setprecision(1) << seconds * 1e9 / (2 * taps) << " ns/event";
+    std::cout << "[ DISPATCH   ] basic keycode: " << report.str() << std::endl;
+    RecordProperty("basic keycode", report.str());
+}
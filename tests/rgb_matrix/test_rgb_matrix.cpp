@@ -0,0 +1,473 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "led_governor.h"
+#include "eeconfig.h"
+#include "eeprom.h"
+#include "led_tables.h"
+#include "progmem.h"
+#include "timer.h"
+#include "lib/lib8tion/lib8tion.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+
+extern const point_t k_rgb_matrix_center;
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+namespace {
+
+// What the mock driver was last told to display.
+uint8_t frame[DRIVER_LED_TOTAL][3];
+int     flushes = 0;
+
+void mock_init(void) {}
+
+void mock_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    if (index < 0 || index >= DRIVER_LED_TOTAL) {
+        ADD_FAILURE() << "LED " << index << " is out of range";
+        return;
+    }
+    frame[index][0] = r;
+    frame[index][1] = g;
+    frame[index][2] = b;
+}
+
+void mock_set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        mock_set_color(i, r, g, b);
+    }
+}
+
+void mock_flush(void) { flushes++; }
+
+// Turns off the blue channel, like a keyboard correcting the color balance of its LEDs would
+bool drop_blue = false;
+
+}  // namespace
+
+extern "C" RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+    RGB rgb = hsv_to_rgb(hsv);
+    if (drop_blue) {
+        rgb.b = 0;
+    }
+    return rgb;
+}
+
+extern "C" const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = mock_init,
+    .set_color     = mock_set_color,
+    .set_color_all = mock_set_color_all,
+    .flush         = mock_flush,
+};
+
+namespace {
+
+struct Effect {
+    uint8_t     mode;
+    const char *name;
+};
+
+const Effect effects[] = {
+#define RGB_MATRIX_EFFECT(name, ...) {RGB_MATRIX_##name, #name},
+#include "rgb_matrix_animations/rgb_matrix_effects.inc"
+#undef RGB_MATRIX_EFFECT
+};
+
+const int GOLDEN_FRAMES = 64;
+
+// FNV-1a of the GOLDEN_FRAMES first frames of every effect, rendered by render_golden_frames().
+// When an effect is meant to look different, the failure message gives the line to replace.
+// The raindrops and digital rain effects use rand(), so their hashes are only valid with glibc.
+const std::map<std::string, uint32_t> golden = {
+    {"SOLID_COLOR", 0x3475ae45},
+    {"ALPHAS_MODS", 0x675eaa45},
+    {"GRADIENT_UP_DOWN", 0x6ffaf7c5},
+    {"GRADIENT_LEFT_RIGHT", 0x4645c245},
+    {"BREATHING", 0xd6990501},
+    {"BAND_SAT", 0x511fcb93},
+    {"BAND_VAL", 0x918917dd},
+    {"BAND_PINWHEEL_SAT", 0xd9895bd7},
+    {"BAND_PINWHEEL_VAL", 0xd5e629b3},
+    {"BAND_SPIRAL_SAT", 0xbc3407ae},
+    {"BAND_SPIRAL_VAL", 0x06006aa4},
+    {"CYCLE_ALL", 0xb02305c1},
+    {"CYCLE_LEFT_RIGHT", 0x6c0d1675},
+    {"CYCLE_UP_DOWN", 0x043b17ad},
+    {"RAINBOW_MOVING_CHEVRON", 0x7b2b5785},
+    {"CYCLE_OUT_IN", 0x9c7c8bf7},
+    {"CYCLE_OUT_IN_DUAL", 0x82e17bd3},
+    {"CYCLE_PINWHEEL", 0x8041cfb1},
+    {"CYCLE_SPIRAL", 0xf3a0c9c7},
+    {"DUAL_BEACON", 0xe6d546d9},
+    {"RAINBOW_BEACON", 0xe6f084af},
+    {"RAINBOW_PINWHEELS", 0x9b7812bf},
+    {"RAINDROPS", 0xf20be72b},
+    {"JELLYBEAN_RAINDROPS", 0xae09e52f},
+    {"HUE_BREATHING", 0x17240a1d},
+    {"HUE_PENDULUM", 0xa2d81ead},
+    {"HUE_WAVE", 0x0fef585d},
+    {"TYPING_HEATMAP", 0xba7cf368},
+    {"DIGITAL_RAIN", 0xe137ba48},
+    {"SOLID_REACTIVE_SIMPLE", 0x301f1a9e},
+    {"SOLID_REACTIVE", 0xac0779d1},
+    {"SOLID_REACTIVE_WIDE", 0x5d9ca7c6},
+    {"SOLID_REACTIVE_MULTIWIDE", 0xa22874a2},
+    {"SOLID_REACTIVE_CROSS", 0x583f434a},
+    {"SOLID_REACTIVE_MULTICROSS", 0xa7c7ed3b},
+    {"SOLID_REACTIVE_NEXUS", 0xdb27acf8},
+    {"SOLID_REACTIVE_MULTINEXUS", 0x233bd515},
+    {"SPLASH", 0x3ffa7a43},
+    {"MULTISPLASH", 0x5adf33eb},
+    {"SOLID_SPLASH", 0x2aea766b},
+    {"SOLID_MULTISPLASH", 0x8f3dbb75},
+};
+
+// Runs the RGB matrix task until the next frame was flushed, and leaves the time at the start of the next one.
+void render_frame() {
+    int flushed = flushes;
+    while (flushes == flushed) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    advance_time(RGB_MATRIX_LED_FLUSH_LIMIT);
+}
+
+// Makes the next frames of an effect only depend on the time since this call and the keys pressed since.
+void start_effect(uint8_t mode) {
+    rgb_matrix_init();
+    // the scan loops of the fixture drive the LED governor, render at full quality
+    led_governor_set_level(0);
+    rgb_matrix_sethsv_noeeprom(HSV_RED);
+    rgb_matrix_set_speed_noeeprom(UINT8_MAX / 2);
+    // flush once with no effect, so the effect is initialized on its first frame
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_NONE);
+    render_frame();
+    memset(g_rgb_frame_buffer, 0, sizeof(g_rgb_frame_buffer));
+    srand(1);
+    set_time(0);
+    rgb_matrix_mode_noeeprom(mode);
+}
+
+// A few keys pressed at fixed frames, for the reactive effects.
+void press_keys_for_frame(int index) {
+    static const struct {
+        int     frame;
+        uint8_t row, col;
+    } presses[] = {{2, 1, 4}, {3, 1, 5}, {10, 2, 9}, {11, 0, 0}, {12, 3, 11}, {30, 1, 4}, {31, 1, 4}};
+
+    for (auto &press : presses) {
+        if (press.frame == (index & 63)) {
+            process_rgb_matrix(press.row, press.col, true);
+            process_rgb_matrix(press.row, press.col, false);
+        }
+    }
+}
+
+uint32_t render_golden_frames(uint8_t mode) {
+    uint32_t hash = 2166136261u;
+
+    start_effect(mode);
+    for (int i = 0; i < GOLDEN_FRAMES; i++) {
+        press_keys_for_frame(i);
+        render_frame();
+        for (auto &led : frame) {
+            for (uint8_t channel : led) {
+                hash = (hash ^ channel) * 16777619u;
+            }
+        }
+    }
+    return hash;
+}
+
+}  // namespace
+
+class RgbMatrix : public TestFixture {};
+
+TEST_F(RgbMatrix, EveryEffectIsCompiled) {
+    EXPECT_EQ(sizeof(effects) / sizeof(effects[0]), RGB_MATRIX_EFFECT_MAX - 1);
+}
+
+TEST_F(RgbMatrix, RenderingIsRepeatable) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    for (auto &effect : effects) {
+        EXPECT_EQ(render_golden_frames(effect.mode), render_golden_frames(effect.mode)) << effect.name;
+    }
+}
+
+TEST_F(RgbMatrix, GoldenFrames) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    for (auto &effect : effects) {
+        uint32_t hash  = render_golden_frames(effect.mode);
+        auto     found = golden.find(effect.name);
+        if (found == golden.end() || found->second != hash) {
+            std::ostringstream line;
+            line << "{\"" << effect.name << "\", 0x" << std::hex << std::setw(8) << std::setfill('0') << hash << "},";
+            ADD_FAILURE() << effect.name << " doesn't render its golden frames anymore, got: " << line.str();
+        }
+    }
+}
+
+// built with EXTRAFLAGS=-DRGB_MATRIX_GEOMETRY_H=..., the effects read a generated table instead, which the golden frames check
+#ifndef RGB_MATRIX_GEOMETRY_H
+TEST_F(RgbMatrix, PolarCoordinatesMatchThePoints) {
+    rgb_matrix_init();
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        EXPECT_EQ(g_led_polar[i].angle, atan2_8(dy, dx)) << "LED " << i;
+        EXPECT_EQ(g_led_polar[i].dist, sqrt16(dx * dx + dy * dy)) << "LED " << i;
+    }
+}
+#endif
+
+// hsv_to_rgb() as it was before the region lookup lost its division, v is the value after the CIE curve
+static RGB reference_hsv_to_rgb(uint16_t h, uint16_t s, uint16_t v) {
+    RGB rgb;
+    if (s == 0) {
+        rgb.r = rgb.g = rgb.b = v;
+        return rgb;
+    }
+
+    uint8_t region    = h * 6 / 255;
+    uint8_t remainder = (h * 2 - region * 85) * 3;
+    uint8_t p         = (v * (255 - s)) >> 8;
+    uint8_t q         = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    uint8_t t         = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 6:
+        case 0:
+            rgb.r = v, rgb.g = t, rgb.b = p;
+            break;
+        case 1:
+            rgb.r = q, rgb.g = v, rgb.b = p;
+            break;
+        case 2:
+            rgb.r = p, rgb.g = v, rgb.b = t;
+            break;
+        case 3:
+            rgb.r = p, rgb.g = q, rgb.b = v;
+            break;
+        case 4:
+            rgb.r = t, rgb.g = p, rgb.b = v;
+            break;
+        default:
+            rgb.r = v, rgb.g = p, rgb.b = q;
+            break;
+    }
+    return rgb;
+}
+
+TEST_F(RgbMatrix, ConversionMatchesTheDivisionReference) {
+    static const uint8_t edges[] = {0, 1, 2, 127, 128, 254, 255};
+
+    for (uint8_t s : edges) {
+        for (uint8_t v : edges) {
+            HSV hsv[256];
+            RGB rgb[256];
+            for (int h = 0; h < 256; h++) {
+                hsv[h] = {(uint8_t)h, s, v};
+            }
+            // the count is a uint8_t, so the 256 hues take two batches
+            hsv_to_rgb_batch(hsv, rgb, 128);
+            hsv_to_rgb_batch(hsv + 128, rgb + 128, 128);
+
+#ifdef USE_CIE1931_CURVE
+            uint8_t curved = pgm_read_byte(&CIE1931_CURVE[v]);
+#else
+            uint8_t curved = v;
+#endif
+            for (int h = 0; h < 256; h++) {
+                RGB expected = reference_hsv_to_rgb(h, s, curved);
+                RGB single   = hsv_to_rgb(hsv[h]);
+                RGB nocie    = hsv_to_rgb_nocie(hsv[h]);
+                RGB plain    = reference_hsv_to_rgb(h, s, v);
+                ASSERT_EQ(memcmp(&single, &expected, sizeof(RGB)), 0) << "hue " << h << ", sat " << (int)s << ", val " << (int)v;
+                ASSERT_EQ(memcmp(&rgb[h], &expected, sizeof(RGB)), 0) << "batch, hue " << h << ", sat " << (int)s << ", val " << (int)v;
+                ASSERT_EQ(memcmp(&nocie, &plain, sizeof(RGB)), 0) << "no CIE, hue " << h << ", sat " << (int)s << ", val " << (int)v;
+            }
+        }
+    }
+}
+
+TEST_F(RgbMatrix, EffectsGoThroughTheConversionHook) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    drop_blue = true;
+    for (auto &effect : effects) {
+        start_effect(effect.mode);
+        rgb_matrix_sethsv_noeeprom(HSV_PURPLE);
+        for (int i = 0; i < 16; i++) {
+            press_keys_for_frame(i);
+            render_frame();
+            for (int led = 0; led < DRIVER_LED_TOTAL; led++) {
+                EXPECT_EQ(frame[led][2], 0) << effect.name << ", frame " << i << ", LED " << led;
+            }
+        }
+    }
+    drop_blue = false;
+}
+
+TEST_F(RgbMatrix, FramebufferListsTheActiveCells) {
+    static const uint8_t               amounts[] = {200, 90, 60, 40, 30, 20, 10, 5, 1};
+    static const frame_buffer_kernel_t kernel    = {2, amounts};
+
+    srand(1);
+    rgb_matrix_framebuffer_clear();
+    for (int step = 0; step < 2000; step++) {
+        if (rand() % 3) {
+            rgb_matrix_framebuffer_decay(rand() % 40, rand() % 2);
+        } else {
+            rgb_matrix_framebuffer_splash(rand() % MATRIX_ROWS, rand() % MATRIX_COLS, &kernel);
+        }
+
+        bool listed[MATRIX_ROWS][MATRIX_COLS] = {};
+        for (uint16_t i = 0; i < g_rgb_frame_buffer_active_count; i++) {
+            frame_buffer_cell_t cell = g_rgb_frame_buffer_active[i];
+            EXPECT_FALSE(listed[cell.row][cell.col]) << "step " << step;
+            listed[cell.row][cell.col] = true;
+        }
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                ASSERT_EQ(listed[row][col], g_rgb_frame_buffer[row][col] != 0) << "step " << step << ", row " << (int)row << ", col " << (int)col;
+            }
+        }
+    }
+}
+
+TEST_F(RgbMatrix, GovernorTradesFramesForScanRate) {
+    start_effect(RGB_MATRIX_SOLID_COLOR);
+
+    // 200 scans per second, each adjustment raises the level until it is maxed out
+    for (int ms = 0; ms < LED_GOVERNOR_INTERVAL * (LED_GOVERNOR_MAX_LEVEL + 2); ms += 5) {
+        led_governor_task();
+        advance_time(5);
+    }
+    EXPECT_EQ(led_governor_get_level(), LED_GOVERNOR_MAX_LEVEL);
+    EXPECT_EQ(led_governor_frame_interval(RGB_MATRIX_LED_FLUSH_LIMIT), RGB_MATRIX_LED_FLUSH_LIMIT << (LED_GOVERNOR_MAX_LEVEL / 2));
+    EXPECT_LT(led_governor_process_limit(RGB_MATRIX_LED_PROCESS_LIMIT), RGB_MATRIX_LED_PROCESS_LIMIT);
+
+    // Frames are split in more task runs, but every LED is still rendered
+    render_frame();
+    memset(frame, 0, sizeof(frame));
+    int runs    = 0;
+    int flushed = flushes;
+    while (flushes == flushed) {
+        rgb_matrix_task();
+        advance_time(1);
+        runs++;
+    }
+    EXPECT_GE(runs, DRIVER_LED_TOTAL / led_governor_process_limit(RGB_MATRIX_LED_PROCESS_LIMIT));
+    for (auto &led : frame) {
+        EXPECT_NE(led[0], 0);
+    }
+
+    // 4000 scans per second, the governor relaxes back to full quality
+    for (int ms = 0; ms < LED_GOVERNOR_INTERVAL * (LED_GOVERNOR_MAX_LEVEL + 2); ms++) {
+        for (int scan = 0; scan < 4; scan++) {
+            led_governor_task();
+        }
+        advance_time(1);
+    }
+    EXPECT_EQ(led_governor_get_level(), 0);
+}
+
+TEST_F(RgbMatrix, SettingsAreWrittenOnceTheyStopChanging) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    start_effect(RGB_MATRIX_SOLID_COLOR);
+    eeconfig_update_rgb_matrix();
+    eeconfig_flush();
+    uint32_t stored;
+    eeprom_read_block(&stored, EECONFIG_RGB_MATRIX, sizeof(stored));
+
+    // Holding the hue key, every update waits in RAM
+    for (int i = 0; i < 20; i++) {
+        rgb_matrix_increase_hue();
+        idle_for(EECONFIG_WRITE_DELAY / 4);
+    }
+    uint32_t written;
+    eeprom_read_block(&written, EECONFIG_RGB_MATRIX, sizeof(written));
+    EXPECT_EQ(written, stored);
+
+    // The pending update is what the configuration reads back
+    rgb_config_t config;
+    eeconfig_read_deferred(&config, EECONFIG_RGB_MATRIX, sizeof(config));
+    EXPECT_EQ(config.raw, rgb_matrix_config.raw);
+    EXPECT_NE(config.raw, stored);
+
+    // Released, only the last hue is written
+    idle_for(EECONFIG_WRITE_DELAY);
+    eeprom_read_block(&written, EECONFIG_RGB_MATRIX, sizeof(written));
+    EXPECT_EQ(written, config.raw);
+}
+
+TEST_F(RgbMatrix, Benchmark) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    const int frames = 2000;
+    for (auto &effect : effects) {
+        start_effect(effect.mode);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            press_keys_for_frame(i);
+            render_frame();
+        }
+        auto   elapsed  = std::chrono::steady_clock::now() - start;
+        double frame_ns = std::chrono::duration<double, std::nano>(elapsed).count() / frames;
+
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(1) << frame_ns << " ns/frame, " << frame_ns / DRIVER_LED_TOTAL << " ns/LED";
+        std::cout << "[ RGB MATRIX ] " << std::left << std::setw(28) << effect.name << report.str() << std::endl;
+        RecordProperty(effect.name, report.str());
+    }
+
+    // what the LED geometry costs at boot, unless it was generated from info.json
+    const int inits = 2000;
+    auto      start = std::chrono::steady_clock::now();
+    for (int i = 0; i < inits; i++) {
+        rgb_matrix_init();
+    }
+    auto   elapsed = std::chrono::steady_clock::now() - start;
+    double init_ns = std::chrono::duration<double, std::nano>(elapsed).count() / inits;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1) << init_ns << " ns/init";
+    std::cout << "[ RGB MATRIX ] " << std::left << std::setw(28) << "rgb_matrix_init()" << report.str() << std::endl;
+    RecordProperty("rgb_matrix_init()", report.str());
+}
@@ -0,0 +1,211 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "quantum.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+class SendString : public TestFixture {};
+
+TEST_F(SendString, AsyncStringIsTypedFromTheMainLoop) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    SEND_STRING_ASYNC("aB");
+    EXPECT_TRUE(send_string_async_pending());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // one report change every SEND_STRING_ASYNC_INTERVAL
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(SEND_STRING_ASYNC_INTERVAL - 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(5 * SEND_STRING_ASYNC_INTERVAL);
+    EXPECT_FALSE(send_string_async_pending());
+}
+
+TEST_F(SendString, KeysAreScannedWhileTyping) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_X)));
+
+    SEND_STRING_ASYNC("aaaa");
+    run_one_scan_loop();
+    press_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_TRUE(send_string_async_pending());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    release_key(0, 0);
+    send_string_flush();
+}
+
+TEST_F(SendString, QueuedStringsAreCopied) {
+    TestDriver driver;
+    InSequence s;
+    char       str[] = "ab";
+
+    send_string_async(str);
+    str[0] = 'c';
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(4 * SEND_STRING_ASYNC_INTERVAL);
+}
+
+TEST_F(SendString, DelaysAreKept) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    SEND_STRING_ASYNC("a" SS_DELAY(100) "b");
+    idle_for(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(100);
+}
+
+TEST_F(SendString, BlockingStringsWaitForTheQueue) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    SEND_STRING_ASYNC("a");
+    SEND_STRING("b");
+    EXPECT_FALSE(send_string_async_pending());
+}
+
+TEST_F(SendString, TappedKeysWaitForTheQueue) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ENT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    SEND_STRING_ASYNC("a");
+    tap_code(KC_ENT);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    SEND_STRING_ASYNC("b");
+    tap_code16(C(KC_C));
+    EXPECT_FALSE(send_string_async_pending());
+}
+
+TEST_F(SendString, StringsThatDontFitAreRejected) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+
+    // nothing is typed, the caller is told instead
+    EXPECT_TRUE(send_string_async("aaaaaaa"));
+    EXPECT_FALSE(send_string_async("bbbbbbb"));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(7);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(7);
+    send_string_flush();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // even into an empty queue
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    char str[SEND_STRING_QUEUE_SIZE + 2] = {};
+    memset(str, 'c', SEND_STRING_QUEUE_SIZE + 1);
+    EXPECT_FALSE(send_string_async(str));
+    EXPECT_FALSE(send_string_async_pending());
+}
+
+TEST_F(SendString, HeldShiftIsLeftAlone) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(0);
+
+    press_key(3, 0);
+    run_one_scan_loop();
+    SEND_STRING_ASYNC("B");
+    idle_for(10 * SEND_STRING_ASYNC_INTERVAL);
+    EXPECT_FALSE(send_string_async_pending());
+    EXPECT_EQ(get_mods(), MOD_BIT(KC_LSFT));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(3, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(SendString, UnicodeIsQueuedAsAWhole) {
+    TestDriver driver;
+    InSequence s;
+
+    set_unicode_input_mode(UC_LNX);
+    press_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // the held Shift is left out until the sequence is done, after the string queued before it
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT, KC_U)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    for (auto digit : {KC_0, KC_0, KC_E, KC_9, KC_SPC}) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(digit)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    SEND_STRING_ASYNC("a");
+    register_unicode(0x00E9);
+    EXPECT_TRUE(send_string_async_pending());
+    idle_for(40 * SEND_STRING_ASYNC_INTERVAL);
+    EXPECT_FALSE(send_string_async_pending());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(3, 0);
+    run_one_scan_loop();
+}
@@ -16,9 +16,18 @@
 
 #include "matrix.h"
 #include "test_matrix.h"
+#include "timer.h"
 #include <string.h>
 
-static matrix_row_t matrix[MATRIX_ROWS] = {};
+static matrix_row_t matrix[MATRIX_ROWS]                = {};
+static uint8_t      dirty_rows[MATRIX_DIRTY_ROWS_SIZE] = {};
+static uint16_t     row_change_time[MATRIX_ROWS]       = {};
+static bool         dirty_rows_tracked                 = true;
+
+static void mark_row_dirty(uint8_t row) {
+    dirty_rows[row / 8] |= 1 << (row % 8);
+    row_change_time[row] = timer_read() | 1;
+}
 
 void matrix_init(void) {
     clear_all_keys();
@@ -32,16 +41,38 @@ uint8_t matrix_scan(void) {
 
 matrix_row_t matrix_get_row(uint8_t row) { return matrix[row]; }
 
+bool matrix_get_dirty_rows(uint8_t rows[]) {
+    if (!dirty_rows_tracked) return false;
+    memcpy(rows, dirty_rows, sizeof(dirty_rows));
+    memset(dirty_rows, 0, sizeof(dirty_rows));
+    return true;
+}
+
+uint16_t matrix_get_row_change_time(uint8_t row) { return row_change_time[row]; }
+
+void set_dirty_rows_tracked(bool tracked) { dirty_rows_tracked = tracked; }
+
 void matrix_print(void) {}
 
 void matrix_init_kb(void) {}
 
 void matrix_scan_kb(void) {}
 
-void press_key(uint8_t col, uint8_t row) { matrix[row] |= 1 << col; }
+void press_key(uint8_t col, uint8_t row) {
+    matrix[row] |= (matrix_row_t)1 << col;
+    mark_row_dirty(row);
+}
 
-void release_key(uint8_t col, uint8_t row) { matrix[row] &= ~(1 << col); }
+void release_key(uint8_t col, uint8_t row) {
+    matrix[row] &= ~((matrix_row_t)1 << col);
+    mark_row_dirty(row);
+}
 
-void clear_all_keys(void) { memset(matrix, 0, sizeof(matrix)); }
+void clear_all_keys(void) {
+    memset(matrix, 0, sizeof(matrix));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        mark_row_dirty(row);
+    }
+}
 
 void led_set(uint8_t usb_led) {}
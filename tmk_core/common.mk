@@ -15,6 +15,7 @@ TMK_COMMON_SRC +=	$(COMMON_DIR)/host.c \
 	$(PLATFORM_COMMON_DIR)/suspend.c \
 	$(PLATFORM_COMMON_DIR)/timer.c \
 	$(COMMON_DIR)/sync_timer.c \
+	$(COMMON_DIR)/deferred_exec.c \
 	$(PLATFORM_COMMON_DIR)/bootloader.c \
 
 # Use platform provided print - fall back to lib/printf
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action.h"
 #include "wait.h"
+#include "send_string.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -55,12 +56,6 @@ __attribute__((weak)) bool get_ignore_mod_tap_interrupt(uint16_t keycode, keyrec
 __attribute__((weak)) bool get_retro_tapping(uint16_t keycode, keyrecord_t *record) { return false; }
 #endif
 
-#ifndef TAP_CODE_DELAY
-#    define TAP_CODE_DELAY 0
-#endif
-#ifndef TAP_HOLD_CAPS_DELAY
-#    define TAP_HOLD_CAPS_DELAY 80
-#endif
 /** \brief Called to execute an action.
  *
  * FIXME: Needs documentation.
@@ -894,6 +889,8 @@ void unregister_code(uint8_t code) {
  * \param delay The amount of time in milliseconds to leave the keycode registered, before unregistering it.
  */
 void tap_code_delay(uint8_t code, uint16_t delay) {
+    // what send_string_async() queued is typed first
+    send_string_flush();
     register_code(code);
     for (uint16_t i = delay; i > 0; i--) {
         wait_ms(1);
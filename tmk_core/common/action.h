@@ -38,6 +38,14 @@ extern "C" {
 #    endif
 #endif
 
+/* Milliseconds a tapped key is held, KC_CAPS gets longer as macOS ignores short taps of it */
+#ifndef TAP_CODE_DELAY
+#    define TAP_CODE_DELAY 0
+#endif
+#ifndef TAP_HOLD_CAPS_DELAY
+#    define TAP_HOLD_CAPS_DELAY 80
+#endif
+
 /* tapping count and state */
 typedef struct {
     bool    interrupted : 1;
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
@@ -35,6 +36,9 @@ static void default_layer_state_set(layer_state_t state) {
     debug("default_layer_state: ");
     default_layer_debug();
     debug(" to ");
+    if (state != default_layer_state) {
+        clear_layer_lookup_cache();
+    }
     default_layer_state = state;
     default_layer_debug();
     debug("\n");
@@ -101,6 +105,9 @@ void layer_state_set(layer_state_t state) {
     dprint("layer_state: ");
     layer_debug();
     dprint(" to ");
+    if (state != layer_state) {
+        clear_layer_lookup_cache();
+    }
     layer_state = state;
     layer_debug();
     dprintln();
@@ -219,6 +226,21 @@ uint8_t read_source_layers_cache(keypos_t key) {
 }
 #endif
 
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+/** \brief layer lookup cache
+ *
+ * Topmost non-transparent layer of every key for the current layer state, plus one, or 0 when it
+ * hasn't been looked up yet.
+ */
+static uint8_t layer_lookup_cache[MATRIX_ROWS][MATRIX_COLS];
+
+/** \brief clear layer lookup cache
+ *
+ * Forgets the looked up layers, when the layer state or the keymap changed
+ */
+void clear_layer_lookup_cache(void) { memset(layer_lookup_cache, 0, sizeof(layer_lookup_cache)); }
+#endif
+
 /** \brief Store or get action (FIXME: Needs better summary)
  *
  * Make sure the action triggered when the key is released is the same
@@ -254,6 +276,17 @@ uint8_t layer_switch_get_layer(keypos_t key) {
 #ifndef NO_ACTION_LAYER
     action_t action;
     action.code = ACTION_TRANSPARENT;
+    uint8_t layer = 0;
+
+#    ifdef LAYER_LOOKUP_CACHE
+    uint8_t *cached = NULL;
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        cached = &layer_lookup_cache[key.row][key.col];
+        if (*cached) {
+            return *cached - 1;
+        }
+    }
+#    endif
 
     layer_state_t layers = layer_state | default_layer_state;
     /* check top layer first */
@@ -261,12 +294,19 @@ uint8_t layer_switch_get_layer(keypos_t key) {
         if (layers & (1UL << i)) {
             action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
-                return i;
+                layer = i;
+                break;
             }
         }
     }
-    /* fall back to layer 0 */
-    return 0;
+    /* falls back to layer 0 */
+
+#    ifdef LAYER_LOOKUP_CACHE
+    if (cached) {
+        *cached = layer + 1;
+    }
+#    endif
+    return layer;
 #else
     return get_highest_layer(default_layer_state);
 #endif
@@ -115,6 +115,13 @@ uint8_t read_source_layers_cache(keypos_t key);
 #endif
 action_t store_or_get_action(bool pressed, keypos_t key);
 
+/* layer lookup cache, to be cleared when the keymap changes */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+void clear_layer_lookup_cache(void);
+#else
+#    define clear_layer_lookup_cache()
+#endif
+
 /* return the topmost non-transparent layer currently associated with key */
 uint8_t layer_switch_get_layer(keypos_t key);
 
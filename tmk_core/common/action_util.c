@@ -27,6 +27,8 @@ extern keymap_config_t keymap_config;
 static uint8_t real_mods  = 0;
 static uint8_t weak_mods  = 0;
 static uint8_t macro_mods = 0;
+// real mods left out of the reports, while Unicode input runs
+static uint8_t suppressed_mods = 0;
 
 #ifdef USB_6KRO_ENABLE
 #    define RO_ADD(a, b) ((a + b) % KEYBOARD_REPORT_KEYS)
@@ -189,7 +191,7 @@ bool is_oneshot_layer_active(void) { return get_oneshot_layer_state(); }
  * FIXME: needs doc
  */
 void send_keyboard_report(void) {
-    keyboard_report->mods = real_mods;
+    keyboard_report->mods = real_mods & ~suppressed_mods;
     keyboard_report->mods |= weak_mods;
     keyboard_report->mods |= macro_mods;
 #ifndef NO_ACTION_ONESHOT
@@ -262,6 +264,18 @@ void set_weak_mods(uint8_t mods) { weak_mods = mods; }
  */
 void clear_weak_mods(void) { weak_mods = 0; }
 
+/** \brief get suppressed mods
+ *
+ * The real mods left out of the keyboard reports.
+ */
+uint8_t get_suppressed_mods(void) { return suppressed_mods; }
+/** \brief set suppressed mods
+ *
+ * Leaves the given real mods out of the keyboard reports, without releasing them. Unlike
+ * clearing and restoring the mods, a mod released in the meantime is not held again.
+ */
+void set_suppressed_mods(uint8_t mods) { suppressed_mods = mods; }
+
 /* macro modifier */
 /** \brief get macro mods
  *
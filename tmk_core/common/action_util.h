@@ -49,6 +49,10 @@ void    del_weak_mods(uint8_t mods);
 void    set_weak_mods(uint8_t mods);
 void    clear_weak_mods(void);
 
+/* suppressed modifier */
+uint8_t get_suppressed_mods(void);
+void    set_suppressed_mods(uint8_t mods);
+
 /* macro modifier */
 uint8_t get_macro_mods(void);
 void    add_macro_mods(uint8_t mods);
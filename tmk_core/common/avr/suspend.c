@@ -8,6 +8,7 @@
 #include "timer.h"
 #include "led.h"
 #include "host.h"
+#include "eeconfig.h"
 
 #ifdef PROTOCOL_LUFA
 #    include "lufa.h"
@@ -128,6 +129,9 @@ void suspend_power_down(void) {
     if (!vusb_suspended) return;
 #endif
 
+    // Write back the configuration the host may never give us the chance to save
+    eeconfig_flush();
+
     suspend_power_down_kb();
 
 #ifndef NO_SUSPEND_POWER_DOWN
@@ -16,6 +16,7 @@
  * Modifications for QMK and STM32F303 by Yiancar
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include "eeprom_stm32.h"
@@ -24,16 +25,130 @@
  * the functionality use the EEPROM_Init() function. Be sure that by reprogramming
  * of the controller just affected pages will be deleted. In other case the non
  * volatile data will be lost.
+ *
+ * Writes are appended to a journal after the snapshot of the EEPROM, so a page
+ * is only erased once the journal is full and gets compacted into a new
+ * snapshot, instead of on every overwritten byte. The new snapshot goes to the
+ * other bank of pages, so a power loss while compacting keeps the old one.
  ******************************************************************************/
 
 /* Private macro -------------------------------------------------------------*/
+_Static_assert(FEE_DENSITY_PAGES % 2 == 0, "FEE_DENSITY_PAGES must be even, the pages are split into two banks");
+_Static_assert(FEE_DENSITY_BYTES % 2 == 0 && FEE_LOG_OFFSET < FEE_BANK_SIZE && FEE_DENSITY_BYTES <= 0x8000, "FEE_DENSITY_BYTES must be even, at most 32KB, and leave room for the journal in a bank");
 /* Private variables ---------------------------------------------------------*/
+static uint8_t  DataBuf[FEE_DENSITY_BYTES];  // RAM copy of the EEPROM contents
+static uint32_t BankAddress;                 // start of the bank in use
+static uint16_t BankSequence;                // sequence number of the bank in use
+static uint32_t LogAddress;                  // where the next journal entry goes
 /* Functions -----------------------------------------------------------------*/
 
-uint8_t DataBuf[FEE_PAGE_SIZE];
+static uint32_t EEPROM_OtherBank(uint32_t Bank) { return Bank == FEE_PAGE_BASE_ADDRESS ? FEE_PAGE_BASE_ADDRESS + FEE_BANK_SIZE : FEE_PAGE_BASE_ADDRESS; }
+
+static uint16_t EEPROM_NextSequence(uint16_t Sequence) { return Sequence + 1 == FEE_EMPTY_WORD ? 0 : Sequence + 1; }
+
+static bool EEPROM_IsBankValid(uint32_t Bank) { return FLASH_ReadHalfWord(Bank) != FEE_EMPTY_WORD && FLASH_ReadHalfWord(Bank + FEE_FORMAT_OFFSET) == FEE_FORMAT_MAGIC; }
+/*****************************************************************************
+ *  Erase the pages of a bank that aren't erased yet, starting with the page
+ *  holding the sequence number so that the bank is invalidated first
+ ******************************************************************************/
+static FLASH_Status EEPROM_EraseBank(uint32_t Bank) {
+    FLASH_Status FlashStatus = FLASH_COMPLETE;
+
+    for (int page_num = 0; page_num < FEE_BANK_PAGES && FlashStatus == FLASH_COMPLETE; page_num++) {
+        uint32_t page = Bank + (page_num * FEE_PAGE_SIZE);
+        for (uint32_t address = page; address < page + FEE_PAGE_SIZE; address += 2) {
+            if (FLASH_ReadHalfWord(address) != FEE_EMPTY_WORD) {
+                FlashStatus = FLASH_ErasePage(page);
+                break;
+            }
+        }
+    }
+    return FlashStatus;
+}
+/*****************************************************************************
+ *  Write the RAM copy as the snapshot of a bank, with an empty journal, and
+ *  switch to it. The sequence number is written last, so the bank is only
+ *  picked up at boot once the snapshot is complete.
+ ******************************************************************************/
+static FLASH_Status EEPROM_WriteBank(uint32_t Bank, uint16_t Sequence) {
+    FLASH_Status FlashStatus = EEPROM_EraseBank(Bank);
+
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = FLASH_ProgramHalfWord(Bank + FEE_FORMAT_OFFSET, FEE_FORMAT_MAGIC);
+    }
+
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES && FlashStatus == FLASH_COMPLETE; i += 2) {
+        uint16_t word = DataBuf[i] | (DataBuf[i + 1] << 8);
+        if (word != FEE_EMPTY_WORD) {
+            FlashStatus = FLASH_ProgramHalfWord(Bank + FEE_SNAPSHOT_OFFSET + i, word);
+        }
+    }
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = FLASH_ProgramHalfWord(Bank, Sequence);
+    }
+    if (FlashStatus != FLASH_COMPLETE) {
+        return FlashStatus;
+    }
+
+    BankAddress  = Bank;
+    BankSequence = Sequence;
+    LogAddress   = Bank + FEE_LOG_OFFSET;
+    return FLASH_COMPLETE;
+}
+/*****************************************************************************
+ *  Pick the newest valid bank, load its snapshot into RAM and replay the
+ *  journal on top of it. Returns false if neither bank is valid, which is
+ *  also the case of the pages written by the layout of an older firmware.
+ ******************************************************************************/
+static bool EEPROM_Load(void) {
+    uint32_t other       = FEE_PAGE_BASE_ADDRESS + FEE_BANK_SIZE;
+    bool     valid       = EEPROM_IsBankValid(FEE_PAGE_BASE_ADDRESS);
+    bool     other_valid = EEPROM_IsBankValid(other);
+
+    BankAddress  = FEE_PAGE_BASE_ADDRESS;
+    BankSequence = FLASH_ReadHalfWord(BankAddress);
+    // both banks are valid if the power was lost before the old one was erased
+    if (other_valid && (!valid || FLASH_ReadHalfWord(other) == EEPROM_NextSequence(BankSequence))) {
+        BankAddress  = other;
+        BankSequence = FLASH_ReadHalfWord(other);
+    } else if (!valid) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i += 2) {
+        uint16_t word  = FLASH_ReadHalfWord(BankAddress + FEE_SNAPSHOT_OFFSET + i);
+        DataBuf[i]     = (uint8_t)word;
+        DataBuf[i + 1] = (uint8_t)(word >> 8);
+    }
+
+    uint32_t bank_end = BankAddress + FEE_BANK_SIZE;
+    LogAddress        = BankAddress + FEE_LOG_OFFSET;
+    while (LogAddress < bank_end) {
+        uint16_t entry = FLASH_ReadHalfWord(LogAddress);
+        if (entry == FEE_EMPTY_WORD) {
+            break;
+        }
+
+        if (entry & FEE_LOG_LONG_ENTRY) {
+            // a long entry missing its value was interrupted, it is skipped along with the empty value
+            uint16_t value = LogAddress + 2 < bank_end ? FLASH_ReadHalfWord(LogAddress + 2) : FEE_EMPTY_WORD;
+            uint16_t addr  = entry & ~FEE_LOG_LONG_ENTRY;
+            if (value != FEE_EMPTY_WORD && addr < FEE_DENSITY_BYTES) {
+                DataBuf[addr] = (uint8_t)value;
+            }
+            LogAddress += 4;
+        } else {
+            if ((entry >> 8) < FEE_DENSITY_BYTES) {
+                DataBuf[entry >> 8] = (uint8_t)entry;
+            }
+            LogAddress += 2;
+        }
+    }
+    return true;
+}
 /*****************************************************************************
- *  Delete Flash Space used for user Data, deletes the whole space between
- *  RW_PAGE_BASE_ADDRESS and the last uC Flash Page
+ *  Unlock the flash and load the EEPROM contents, must be called before
+ *  anything else
  ******************************************************************************/
 uint16_t EEPROM_Init(void) {
     // unlock flash
@@ -42,63 +157,68 @@ uint16_t EEPROM_Init(void) {
     // Clear Flags
     // FLASH_ClearFlag(FLASH_SR_EOP|FLASH_SR_PGERR|FLASH_SR_WRPERR);
 
+    if (!EEPROM_Load()) {
+        EEPROM_Erase();
+    }
+
     return FEE_DENSITY_BYTES;
 }
 /*****************************************************************************
- *  Erase the whole reserved Flash Space used for user Data
+ *  Erase the whole reserved Flash Space used for user Data, and start over
+ *  with an empty first bank
  ******************************************************************************/
 void EEPROM_Erase(void) {
-    int page_num = 0;
+    memset(DataBuf, 0xFF, sizeof(DataBuf));
+    EEPROM_EraseBank(FEE_PAGE_BASE_ADDRESS + FEE_BANK_SIZE);
+    EEPROM_WriteBank(FEE_PAGE_BASE_ADDRESS, 0);
+}
+/*****************************************************************************
+ *  Write the RAM copy as the snapshot of the other bank, then erase the old
+ *  one. Called when the journal is full.
+ ******************************************************************************/
+uint16_t EEPROM_Compact(void) {
+    uint32_t     old_bank    = BankAddress;
+    FLASH_Status FlashStatus = EEPROM_WriteBank(EEPROM_OtherBank(old_bank), EEPROM_NextSequence(BankSequence));
 
-    // delete all pages from specified start page to the last page
-    do {
-        FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
-        page_num++;
-    } while (page_num < FEE_DENSITY_PAGES);
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = EEPROM_EraseBank(old_bank);
+    }
+    return FlashStatus;
 }
 /*****************************************************************************
- *  Writes once data byte to flash on specified address. If a byte is already
- *  written, the whole page must be copied to a buffer, the byte changed and
- *  the manipulated buffer written after PageErase.
+ *  Writes once data byte to flash on specified address. Unchanged bytes are
+ *  skipped, changed ones are appended to the journal, which is compacted into
+ *  a new snapshot once it is full.
  *******************************************************************************/
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     FLASH_Status FlashStatus = FLASH_COMPLETE;
 
-    uint32_t page;
-    int      i;
-
     // exit if desired address is above the limit (e.G. under 2048 Bytes for 4 pages)
-    if (Address > FEE_DENSITY_BYTES) {
+    if (Address >= FEE_DENSITY_BYTES) {
         return 0;
     }
 
-    // calculate which page is affected (Pagenum1/Pagenum2...PagenumN)
-    page = FEE_ADDR_OFFSET(Address) / FEE_PAGE_SIZE;
+    // check if new data is differ to current data, return if not, proceed if yes
+    if (DataBuf[Address] == DataByte) {
+        return 0;
+    }
+    DataBuf[Address] = DataByte;
 
-    // if current data is 0xFF, the byte is empty, just overwrite with the new one
-    if ((*(__IO uint16_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) == FEE_EMPTY_WORD) {
-        FlashStatus = FLASH_ProgramHalfWord(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address), (uint16_t)(0x00FF & DataByte));
+    if (Address < FEE_LOG_SHORT_ADDRESS_LIMIT) {
+        if (LogAddress + 2 > BankAddress + FEE_BANK_SIZE) {
+            return EEPROM_Compact();
+        }
+        FlashStatus = FLASH_ProgramHalfWord(LogAddress, (Address << 8) | DataByte);
+        LogAddress += 2;
     } else {
-        // Copy Page to a buffer
-        memcpy(DataBuf, (uint8_t *)FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE), FEE_PAGE_SIZE);  // !!! Calculate base address for the desired page
-
-        // check if new data is differ to current data, return if not, proceed if yes
-        if (DataByte == *(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) {
-            return 0;
+        if (LogAddress + 4 > BankAddress + FEE_BANK_SIZE) {
+            return EEPROM_Compact();
         }
-
-        // manipulate desired data byte in temp data array if new byte is differ to the current
-        DataBuf[FEE_ADDR_OFFSET(Address) % FEE_PAGE_SIZE] = DataByte;
-
-        // Erase Page
-        FlashStatus = FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE));
-
-        // Write new data (whole page) to flash if data has been changed
-        for (i = 0; i < (FEE_PAGE_SIZE / 2); i++) {
-            if ((__IO uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]) != 0xFFFF) {
-                FlashStatus = FLASH_ProgramHalfWord((FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE)) + (i * 2), (uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]));
-            }
+        FlashStatus = FLASH_ProgramHalfWord(LogAddress, FEE_LOG_LONG_ENTRY | Address);
+        if (FlashStatus == FLASH_COMPLETE) {
+            FlashStatus = FLASH_ProgramHalfWord(LogAddress + 2, DataByte);
         }
+        LogAddress += 4;
     }
     return FlashStatus;
 }
@@ -108,8 +228,10 @@ uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
 uint8_t EEPROM_ReadDataByte(uint16_t Address) {
     uint8_t DataByte = 0xFF;
 
-    // Get Byte from specified address
-    DataByte = (*(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address)));
+    // Get Byte from the RAM copy
+    if (Address < FEE_DENSITY_BYTES) {
+        DataByte = DataBuf[Address];
+    }
 
     return DataByte;
 }
@@ -118,44 +240,44 @@ uint8_t EEPROM_ReadDataByte(uint16_t Address) {
  *  Wrap library in AVR style functions.
  *******************************************************************************/
 uint8_t eeprom_read_byte(const uint8_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p);
 }
 
 void eeprom_write_byte(uint8_t *Address, uint8_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, Value);
 }
 
 void eeprom_update_byte(uint8_t *Address, uint8_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, Value);
 }
 
 uint16_t eeprom_read_word(const uint16_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8);
 }
 
 void eeprom_write_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
 }
 
 void eeprom_update_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
 }
 
 uint32_t eeprom_read_dword(const uint32_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
 }
 
 void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p = (const uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
     EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
@@ -163,7 +285,7 @@ void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
 }
 
 void eeprom_update_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p             = (const uint32_t)Address;
+    uint16_t p             = (uintptr_t)Address;
     uint32_t existingValue = EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
     if (Value != existingValue) {
         EEPROM_WriteDataByte(p, (uint8_t)Value);
@@ -17,14 +17,13 @@
  *
  * This library assumes 8-bit data locations. To add a new MCU, please provide the flash
  * page size and the total flash size in Kb. The number of available pages must be a multiple
- * of 2. Only half of the pages account for the total EEPROM size.
+ * of 2. Only part of each half of the pages account for the total EEPROM size.
  * This library also assumes that the pages are not used by the firmware.
  */
 
 #pragma once
 
-#include <ch.h>
-#include <hal.h>
+#include <stdint.h>
 #include "flash_stm32.h"
 
 // HACK ALERT. This definition may not match your processor
@@ -43,11 +42,11 @@
 
 #ifndef EEPROM_PAGE_SIZE
 #    if defined(MCU_STM32F103RB) || defined(MCU_STM32F042K6)
-#        define FEE_PAGE_SIZE (uint16_t)0x400  // Page size = 1KByte
-#        define FEE_DENSITY_PAGES 2            // How many pages are used
+#        define FEE_PAGE_SIZE 0x400  // Page size = 1KByte
+#        define FEE_DENSITY_PAGES 4  // How many pages are used
 #    elif defined(MCU_STM32F103ZE) || defined(MCU_STM32F103RE) || defined(MCU_STM32F103RD) || defined(MCU_STM32F303CC) || defined(MCU_STM32F072CB)
-#        define FEE_PAGE_SIZE (uint16_t)0x800  // Page size = 2KByte
-#        define FEE_DENSITY_PAGES 4            // How many pages are used
+#        define FEE_PAGE_SIZE 0x800  // Page size = 2KByte
+#        define FEE_DENSITY_PAGES 6  // How many pages are used
 #    else
 #        error "No MCU type specified. Add something like -DMCU_STM32F103RB to your compiler arguments (probably in a Makefile)."
 #    endif
@@ -71,14 +70,37 @@
 
 // DONT CHANGE
 // Choose location for the first EEPROM Page address on the top of flash
-#define FEE_PAGE_BASE_ADDRESS ((uint32_t)(0x8000000 + FEE_MCU_FLASH_SIZE * 1024 - FEE_DENSITY_PAGES * FEE_PAGE_SIZE))
-#define FEE_DENSITY_BYTES ((FEE_PAGE_SIZE / 2) * FEE_DENSITY_PAGES - 1)
+#ifndef FEE_PAGE_BASE_ADDRESS
+#    define FEE_PAGE_BASE_ADDRESS ((uint32_t)(0x8000000 + FEE_MCU_FLASH_SIZE * 1024 - FEE_DENSITY_PAGES * FEE_PAGE_SIZE))
+#endif
 #define FEE_LAST_PAGE_ADDRESS (FEE_PAGE_BASE_ADDRESS + (FEE_PAGE_SIZE * FEE_DENSITY_PAGES))
 #define FEE_EMPTY_WORD ((uint16_t)0xFFFF)
-#define FEE_ADDR_OFFSET(Address) (Address * 2)  // 1Byte per Word will be saved to preserve Flash
+
+// The pages are split into two banks, only one of them is in use. A bank starts with its sequence
+// number and the format magic, then a snapshot of the emulated EEPROM, two bytes per half-word, and
+// the rest is a journal of the bytes written since. Once the journal is full, a new snapshot is
+// written to the other bank, which only gets its sequence number, and replaces the old bank, once the
+// snapshot is complete. A bank without the magic, like the pages of an older firmware, is not valid.
+// Every byte is also kept in RAM, so a smaller size can be chosen to save RAM. By default the snapshot
+// takes all pages of a bank but the last one, which keeps the size of the previous driver.
+#define FEE_BANK_PAGES (FEE_DENSITY_PAGES / 2)
+#define FEE_BANK_SIZE (FEE_PAGE_SIZE * FEE_BANK_PAGES)
+#ifndef FEE_DENSITY_BYTES
+#    define FEE_DENSITY_BYTES (FEE_BANK_SIZE - FEE_PAGE_SIZE)
+#endif
+#define FEE_FORMAT_OFFSET 2
+#define FEE_FORMAT_MAGIC ((uint16_t)0x514B)  // change it when the layout changes
+#define FEE_SNAPSHOT_OFFSET 4
+#define FEE_LOG_OFFSET (FEE_SNAPSHOT_OFFSET + FEE_DENSITY_BYTES)
+
+// Journal entries of the first bytes take a single half-word: the address in the high byte and the
+// value in the low byte. The others take two: the address with FEE_LOG_LONG_ENTRY set, then the value.
+#define FEE_LOG_SHORT_ADDRESS_LIMIT 0x80
+#define FEE_LOG_LONG_ENTRY ((uint16_t)0x8000)
 
 // Use this function to initialize the functionality
 uint16_t EEPROM_Init(void);
 void     EEPROM_Erase(void);
+uint16_t EEPROM_Compact(void);
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte);
 uint8_t  EEPROM_ReadDataByte(uint16_t Address);
@@ -22,8 +22,12 @@
 extern "C" {
 #endif
 
-#include <ch.h>
-#include <hal.h>
+#include <stdint.h>
+
+#ifndef FLASH_STM32_MOCKED
+#    include <ch.h>
+#    include <hal.h>
+#endif
 
 typedef enum { FLASH_BUSY = 1, FLASH_ERROR_PG, FLASH_ERROR_WRP, FLASH_ERROR_OPT, FLASH_COMPLETE, FLASH_TIMEOUT, FLASH_BAD_ADDRESS } FLASH_Status;
 
@@ -37,6 +41,13 @@ void FLASH_Unlock(void);
 void FLASH_Lock(void);
 void FLASH_ClearFlag(uint32_t FLASH_FLAG);
 
+#ifdef FLASH_STM32_MOCKED
+// The unit tests simulate the flash, see tmk_core/common/chibios/tests/flash_stm32_mock.c
+uint16_t FLASH_ReadHalfWord(uint32_t Address);
+#else
+#    define FLASH_ReadHalfWord(Address) (*(__IO uint16_t *)(Address))
+#endif
+
 #ifdef __cplusplus
 }
 #endif
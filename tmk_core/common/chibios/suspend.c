@@ -11,6 +11,7 @@
 #include "suspend.h"
 #include "led.h"
 #include "wait.h"
+#include "eeconfig.h"
 
 #ifdef AUDIO_ENABLE
 #    include "audio.h"
@@ -49,6 +50,9 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+    // Write back the configuration the host may never give us the chance to save
+    eeconfig_flush();
+
 #ifdef BACKLIGHT_ENABLE
     backlight_set(0);
 #endif
@@ -0,0 +1,284 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom.h"
+#include "eeprom_stm32.h"
+#include "flash_stm32_mock.h"
+}
+
+// Addresses of the EEPROM, as the eeprom_* functions take them
+#define EEPROM_ADDR(address) ((uint8_t *)(uintptr_t)(address))
+
+class EepromStm32Test : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        flash_mock_reset();
+        EEPROM_Init();
+        memset(expected, 0xFF, sizeof(expected));
+    }
+
+    void TearDown() override { EXPECT_EQ(flash_mock_stats.errors, 0u); }
+
+    // Power cycles the keyboard, only what is in flash is kept
+    void reboot() {
+        flash_mock_operations_left = -1;
+        EEPROM_Init();
+    }
+
+    void write(uint16_t address, uint8_t value) {
+        eeprom_update_byte(EEPROM_ADDR(address), value);
+        expected[address] = value;
+    }
+
+    void expect_contents(const char *when) {
+        for (uint16_t address = 0; address < FEE_DENSITY_BYTES; address++) {
+            ASSERT_EQ(eeprom_read_byte(EEPROM_ADDR(address)), expected[address]) << "address " << address << " " << when;
+        }
+    }
+
+    uint32_t page_erases() {
+        uint32_t erases = 0;
+        for (auto count : flash_mock_stats.page_erases) {
+            erases += count;
+        }
+        return erases;
+    }
+
+    // Bytes left in the journal of the bank in use
+    uint32_t journal_space() {
+        uint32_t bank           = FEE_PAGE_BASE_ADDRESS;
+        uint16_t sequence       = FLASH_ReadHalfWord(bank);
+        uint16_t other_sequence = FLASH_ReadHalfWord(bank + FEE_BANK_SIZE);
+        if (sequence == FEE_EMPTY_WORD || (other_sequence != FEE_EMPTY_WORD && other_sequence > sequence)) {
+            bank += FEE_BANK_SIZE;
+        }
+        uint32_t end = bank + FEE_BANK_SIZE;
+        while (end > bank + FEE_LOG_OFFSET && FLASH_ReadHalfWord(end - 2) == FEE_EMPTY_WORD) {
+            end -= 2;
+        }
+        return bank + FEE_BANK_SIZE - end;
+    }
+
+    // Fills the journal until the next long entry doesn't fit, without changing the snapshot
+    void fill_journal() {
+        while (journal_space() >= 4) {
+            write(0x100, expected[0x100] == 0 ? 1 : 0);
+        }
+    }
+
+    uint8_t expected[FEE_DENSITY_BYTES];
+};
+
+TEST_F(EepromStm32Test, StartsErased) { expect_contents("after the first boot"); }
+
+TEST_F(EepromStm32Test, KeepsWritesAcrossReboots) {
+    write(0, 0x12);
+    write(0x7F, 0x34);
+    write(0x80, 0x56);
+    write(FEE_DENSITY_BYTES - 1, 0x78);
+    eeprom_update_dword((uint32_t *)EEPROM_ADDR(0x20), 0xCAFEF00D);
+    expected[0x20] = 0x0D;
+    expected[0x21] = 0xF0;
+    expected[0x22] = 0xFE;
+    expected[0x23] = 0xCA;
+    expect_contents("before rebooting");
+
+    reboot();
+    expect_contents("after rebooting");
+    EXPECT_EQ(page_erases(), 0u);
+}
+
+TEST_F(EepromStm32Test, IgnoresAddressesPastTheEnd) {
+    uint32_t programs = flash_mock_stats.half_word_programs;
+    eeprom_update_byte(EEPROM_ADDR(FEE_DENSITY_BYTES), 0);
+    EXPECT_EQ(eeprom_read_byte(EEPROM_ADDR(FEE_DENSITY_BYTES)), 0xFF);
+    EXPECT_EQ(flash_mock_stats.half_word_programs, programs);
+}
+
+TEST_F(EepromStm32Test, SkipsUnchangedBytes) {
+    write(0x10, 0x42);
+    uint32_t programs = flash_mock_stats.half_word_programs;
+    write(0x10, 0x42);
+    eeprom_update_block(expected, EEPROM_ADDR(0), FEE_DENSITY_BYTES);
+    EXPECT_EQ(flash_mock_stats.half_word_programs, programs);
+}
+
+TEST_F(EepromStm32Test, CompactsWhenTheJournalIsFull) {
+    // bytes in every page of the next snapshot, the pages left blank aren't erased
+    for (uint16_t address = 0; address < FEE_DENSITY_BYTES; address += 256) {
+        write(address, 0x42);
+    }
+    fill_journal();
+    EXPECT_EQ(page_erases(), 0u);
+
+    // the snapshot goes to the second bank, which is still erased, then the first bank is erased,
+    // where only the pages of the header and the journal were programmed
+    write(0x101, 0x99);
+    for (int page = 0; page < FEE_DENSITY_PAGES; page++) {
+        EXPECT_EQ(flash_mock_stats.page_erases[page], page == 0 || page == FEE_BANK_PAGES - 1 ? 1u : 0u) << "page " << page;
+    }
+    expect_contents("after compacting");
+
+    reboot();
+    expect_contents("after rebooting");
+
+    // and back to the first bank
+    fill_journal();
+    write(0x102, 0x98);
+    for (int page = FEE_BANK_PAGES; page < FEE_DENSITY_PAGES; page++) {
+        EXPECT_EQ(flash_mock_stats.page_erases[page], 1u) << "page " << page;
+    }
+    reboot();
+    expect_contents("after compacting twice");
+}
+
+TEST_F(EepromStm32Test, SurvivesAnInterruptedCompaction) {
+    for (int32_t operations = 0;; operations++) {
+        flash_mock_reset();
+        EEPROM_Init();
+        memset(expected, 0xFF, sizeof(expected));
+        write(0x10, 0x22);
+        write(0x300, 0x33);
+        fill_journal();
+        uint8_t before[FEE_DENSITY_BYTES];
+        memcpy(before, expected, sizeof(before));
+
+        // the power is cut after a given number of flash operations of the compaction
+        flash_mock_operations_left = operations;
+        write(0x101, 0x99);
+        bool completed = flash_mock_operations_left != 0;
+        reboot();
+
+        // either the compaction made it, or the byte that triggered it is lost
+        if (eeprom_read_byte(EEPROM_ADDR(0x101)) != 0x99) {
+            memcpy(expected, before, sizeof(expected));
+        }
+        std::ostringstream when;
+        when << "after losing the power " << operations << " operations into the compaction";
+        expect_contents(when.str().c_str());
+
+        // the EEPROM keeps working, including the next compaction
+        write(0x11, 0x44);
+        fill_journal();
+        write(0x102, 0x98);
+        reboot();
+        expect_contents("after compacting again");
+
+        if (completed) {
+            break;
+        }
+    }
+}
+
+TEST_F(EepromStm32Test, ErasesThePagesOfAnOlderFirmware) {
+    // the previous driver kept a byte per half-word, 0xFF00 | value at twice its address
+    srand(1);
+    for (uint32_t offset = 0; offset < MOCK_FLASH_SIZE; offset += 2) {
+        if (rand() % 2) {
+            FlashBuf[offset]     = rand();
+            FlashBuf[offset + 1] = 0xFF;
+        }
+    }
+    FlashBuf[0] = 0x12;
+    FlashBuf[1] = 0xFF;
+    reboot();
+    expect_contents("after the upgrade");
+
+    // the journal only programs erased flash, which the mock checks
+    for (int step = 0; step < 2000; step++) {
+        write(rand() % FEE_DENSITY_BYTES, rand());
+    }
+    reboot();
+    expect_contents("after writing over the old pages");
+}
+
+TEST_F(EepromStm32Test, SkipsAnInterruptedJournalEntry) {
+    write(0x200, 0x11);
+    write(0x10, 0x22);
+
+    // the power is cut between the address and the value of a long entry
+    flash_mock_operations_left = 1;
+    eeprom_update_byte(EEPROM_ADDR(0x200), 0x33);
+    reboot();
+    expect_contents("after losing the write");
+
+    write(0x200, 0x44);
+    write(0x10, 0x55);
+    reboot();
+    expect_contents("after writing past the lost entry");
+}
+
+TEST_F(EepromStm32Test, MatchesAPlainArray) {
+    srand(1);
+    for (int step = 0; step < 20000; step++) {
+        // most writes go to the first bytes, like the configuration of the keyboard does
+        uint16_t address = rand() % 4 ? rand() % FEE_LOG_SHORT_ADDRESS_LIMIT : rand() % FEE_DENSITY_BYTES;
+        write(address, rand() % 4 ? rand() : 0xFF);
+        if (step % 997 == 0) {
+            reboot();
+            expect_contents("after a reboot");
+        }
+    }
+    expect_contents("at the end");
+}
+
+TEST_F(EepromStm32Test, WriteAmplification) {
+    // What the configuration of a keyboard goes through: a VIA keymap upload, then many RGB changes
+    srand(1);
+    uint8_t keymap[1024];
+    for (auto &value : keymap) {
+        value = rand();
+    }
+
+    const struct {
+        const char *name;
+        int         updates;
+    } workloads[] = {{"keymap upload", 1}, {"rgb matrix updates", 1000}};
+
+    for (auto &workload : workloads) {
+        flash_mock_reset();
+        EEPROM_Init();
+
+        uint32_t bytes = 0;
+        for (int i = 0; i < workload.updates; i++) {
+            if (workload.updates == 1) {
+                eeprom_update_block(keymap, EEPROM_ADDR(0x40), sizeof(keymap));
+                bytes += sizeof(keymap);
+            } else {
+                // eeconfig_update_rgb_matrix() with a new hue
+                uint32_t config = 0x7F000001 | ((i & 0xFF) << 8);
+                eeprom_update_dword((uint32_t *)EEPROM_ADDR(0x18), config);
+                bytes += 4;
+            }
+        }
+
+        std::ostringstream report;
+        report << page_erases() << " page erases, " << flash_mock_stats.half_word_programs << " half-word programs for " << bytes << " bytes";
+        std::cout << "[ EEPROM     ] " << workload.name << ": " << report.str() << std::endl;
+        RecordProperty(workload.name, report.str());
+
+        // The previous driver erased a page for almost every one of these bytes
+        EXPECT_LE(page_erases(), bytes / 64) << workload.name;
+    }
+}
@@ -0,0 +1,93 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "flash_stm32_mock.h"
+
+uint8_t            FlashBuf[MOCK_FLASH_SIZE];
+flash_mock_stats_t flash_mock_stats;
+int32_t            flash_mock_operations_left = -1;
+
+void flash_mock_reset(void) {
+    memset(FlashBuf, 0xFF, sizeof(FlashBuf));
+    memset(&flash_mock_stats, 0, sizeof(flash_mock_stats));
+    flash_mock_operations_left = -1;
+}
+
+static bool flash_mock_powered(void) {
+    if (flash_mock_operations_left == 0) {
+        return false;
+    }
+    if (flash_mock_operations_left > 0) {
+        flash_mock_operations_left--;
+    }
+    return true;
+}
+
+static bool flash_mock_in_range(uint32_t Address, uint32_t size) {
+    if (Address < FEE_PAGE_BASE_ADDRESS || Address + size > FEE_LAST_PAGE_ADDRESS || Address % 2) {
+        flash_mock_stats.errors++;
+        return false;
+    }
+    return true;
+}
+
+FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout) { return FLASH_COMPLETE; }
+
+FLASH_Status FLASH_ErasePage(uint32_t Page_Address) {
+    if (!flash_mock_in_range(Page_Address, FEE_PAGE_SIZE) || (Page_Address - FEE_PAGE_BASE_ADDRESS) % FEE_PAGE_SIZE) {
+        return FLASH_BAD_ADDRESS;
+    }
+    if (flash_mock_powered()) {
+        uint32_t offset = Page_Address - FEE_PAGE_BASE_ADDRESS;
+        memset(&FlashBuf[offset], 0xFF, FEE_PAGE_SIZE);
+        flash_mock_stats.page_erases[offset / FEE_PAGE_SIZE]++;
+    }
+    return FLASH_COMPLETE;
+}
+
+FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data) {
+    if (!flash_mock_in_range(Address, 2)) {
+        return FLASH_BAD_ADDRESS;
+    }
+    // like the hardware, only erased half-words can be programmed
+    if (FLASH_ReadHalfWord(Address) != 0xFFFF) {
+        flash_mock_stats.errors++;
+        return FLASH_ERROR_PG;
+    }
+    if (flash_mock_powered()) {
+        uint32_t offset      = Address - FEE_PAGE_BASE_ADDRESS;
+        FlashBuf[offset]     = (uint8_t)Data;
+        FlashBuf[offset + 1] = (uint8_t)(Data >> 8);
+        flash_mock_stats.half_word_programs++;
+    }
+    return FLASH_COMPLETE;
+}
+
+uint16_t FLASH_ReadHalfWord(uint32_t Address) {
+    if (!flash_mock_in_range(Address, 2)) {
+        return 0xFFFF;
+    }
+    uint32_t offset = Address - FEE_PAGE_BASE_ADDRESS;
+    return FlashBuf[offset] | (FlashBuf[offset + 1] << 8);
+}
+
+void FLASH_Unlock(void) {}
+
+void FLASH_Lock(void) {}
+
+void FLASH_ClearFlag(uint32_t FLASH_FLAG) {}
@@ -0,0 +1,39 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "eeprom_stm32.h"
+
+#define MOCK_FLASH_SIZE (FEE_PAGE_SIZE * FEE_DENSITY_PAGES)
+
+// Simulated pages of the emulated EEPROM, at FEE_PAGE_BASE_ADDRESS
+extern uint8_t FlashBuf[MOCK_FLASH_SIZE];
+
+typedef struct {
+    uint32_t page_erases[FEE_DENSITY_PAGES];
+    uint32_t half_word_programs;
+    uint32_t errors;  // programmed half-words that were not erased, and out of range accesses
+} flash_mock_stats_t;
+
+extern flash_mock_stats_t flash_mock_stats;
+
+// Erases the whole simulated flash and clears the stats
+void flash_mock_reset(void);
+
+// The flash ignores the operations past this many, as if the power was cut. Negative is unlimited.
+extern int32_t flash_mock_operations_left;
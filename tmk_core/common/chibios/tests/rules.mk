@@ -0,0 +1,7 @@
+eeprom_stm32_DEFS := -DNO_PRINT -DFLASH_STM32_MOCKED -DEEPROM_EMU_STM32F303xC
+eeprom_stm32_INC := $(TMK_PATH)/common/chibios
+
+eeprom_stm32_SRC := \
+	$(TMK_PATH)/common/chibios/tests/eeprom_stm32_tests.cpp \
+	$(TMK_PATH)/common/chibios/tests/flash_stm32_mock.c \
+	$(TMK_PATH)/common/chibios/eeprom_stm32.c
@@ -0,0 +1,181 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Deferred execution backed by a hashed timer wheel.
+Each scheduled callback is linked into the wheel slot of the millisecond it is due at, modulo
+DEFERRED_EXEC_WHEEL_SIZE. deferred_exec_task() only visits the slots of the milliseconds that passed
+since its last call, so a main loop iteration that doesn't cross a millisecond costs a single timer
+read, and one that does only looks at the callbacks hashed to that millisecond. Callbacks due more
+than a wheel turn ahead stay in their slot until a visit finds them expired.
+*/
+
+#include <stddef.h>
+#include "deferred_exec.h"
+#include "timer.h"
+
+#if MAX_DEFERRED_EXECUTORS > 254
+#    error MAX_DEFERRED_EXECUTORS must be 254 or less
+#endif
+#if DEFERRED_EXEC_WHEEL_SIZE & (DEFERRED_EXEC_WHEEL_SIZE - 1)
+#    error DEFERRED_EXEC_WHEEL_SIZE must be a power of two
+#endif
+
+#define WHEEL_SLOT(time) ((time) & (DEFERRED_EXEC_WHEEL_SIZE - 1))
+
+typedef struct {
+    uint32_t               due;
+    deferred_exec_callback callback;
+    void *                 cb_arg;
+    deferred_token         token;  // INVALID_DEFERRED_TOKEN while the executor is free
+    uint8_t                generation;
+    uint8_t                next;  // next executor in the same wheel slot, as index + 1
+    bool                   linked;
+} deferred_executor_t;
+
+static deferred_executor_t executors[MAX_DEFERRED_EXECUTORS];
+// first executor of every wheel slot, as index + 1
+static uint8_t  wheel[DEFERRED_EXEC_WHEEL_SIZE];
+static uint8_t  scheduled = 0;
+static uint32_t last_tick = 0;
+
+static deferred_executor_t *find_executor(deferred_token token) {
+    uint8_t index = (token & 0xFF) - 1;
+    if (token == INVALID_DEFERRED_TOKEN || index >= MAX_DEFERRED_EXECUTORS || executors[index].token != token) {
+        return NULL;
+    }
+    return &executors[index];
+}
+
+static void link_executor(deferred_executor_t *executor, uint32_t due) {
+    // the slots up to last_tick have already been visited
+    if (timer_expired32(last_tick, due)) {
+        due = last_tick + 1;
+    }
+    uint8_t *head    = &wheel[WHEEL_SLOT(due)];
+    executor->due    = due;
+    executor->next   = *head;
+    executor->linked = true;
+    *head            = executor - executors + 1;
+}
+
+static void unlink_executor(deferred_executor_t *executor) {
+    uint8_t *link = &wheel[WHEEL_SLOT(executor->due)];
+    while (*link) {
+        if (&executors[*link - 1] == executor) {
+            *link = executor->next;
+            break;
+        }
+        link = &executors[*link - 1].next;
+    }
+    executor->next   = 0;
+    executor->linked = false;
+}
+
+static void free_executor(deferred_executor_t *executor) {
+    executor->token = INVALID_DEFERRED_TOKEN;
+    scheduled--;
+}
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        deferred_executor_t *executor = &executors[i];
+        if (executor->token != INVALID_DEFERRED_TOKEN) continue;
+
+        executor->generation++;
+        executor->token    = ((deferred_token)executor->generation << 8) | (i + 1);
+        executor->callback = callback;
+        executor->cb_arg   = cb_arg;
+        link_executor(executor, timer_read32() + delay_ms);
+        scheduled++;
+        return executor->token;
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    deferred_executor_t *executor = find_executor(token);
+    if (!executor) return false;
+
+    if (executor->linked) {
+        unlink_executor(executor);
+    }
+    link_executor(executor, timer_read32() + delay_ms);
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    deferred_executor_t *executor = find_executor(token);
+    if (!executor) return false;
+
+    if (executor->linked) {
+        unlink_executor(executor);
+    }
+    free_executor(executor);
+    return true;
+}
+
+void deferred_exec_task(void) {
+    uint32_t now = timer_read32();
+    if (now == last_tick) return;
+
+    uint32_t ticks = TIMER_DIFF_32(now, last_tick);
+    last_tick      = now;
+    if (!scheduled) return;
+
+    // a full turn of the wheel visits every executor
+    if (ticks > DEFERRED_EXEC_WHEEL_SIZE) {
+        ticks = DEFERRED_EXEC_WHEEL_SIZE;
+    }
+
+    // unlink everything that is due first, so the callbacks are free to (re)schedule and cancel
+    uint8_t        due_count = 0;
+    uint8_t        due[MAX_DEFERRED_EXECUTORS];
+    deferred_token due_tokens[MAX_DEFERRED_EXECUTORS];
+    for (uint32_t tick = now - ticks + 1; ticks--; tick++) {
+        uint8_t *link = &wheel[WHEEL_SLOT(tick)];
+        while (*link) {
+            deferred_executor_t *executor = &executors[*link - 1];
+            if (timer_expired32(now, executor->due)) {
+                due[due_count]        = *link - 1;
+                due_tokens[due_count] = executor->token;
+                due_count++;
+                *link            = executor->next;
+                executor->next   = 0;
+                executor->linked = false;
+            } else {
+                link = &executor->next;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < due_count; i++) {
+        deferred_executor_t *executor = &executors[due[i]];
+        // cancelled, or extended and linked again, by an earlier callback
+        if (executor->token != due_tokens[i] || executor->linked || !timer_expired32(now, executor->due)) continue;
+
+        uint32_t delay_ms = executor->callback(executor->due, executor->cb_arg);
+
+        // cancelled or rescheduled by the callback itself
+        if (executor->token != due_tokens[i] || executor->linked) continue;
+
+        if (delay_ms) {
+            link_executor(executor, executor->due + delay_ms);
+        } else {
+            free_executor(executor);
+        }
+    }
+}
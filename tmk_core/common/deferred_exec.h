@@ -0,0 +1,71 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* number of callbacks that can be scheduled at the same time */
+#ifndef MAX_DEFERRED_EXECUTORS
+#    define MAX_DEFERRED_EXECUTORS 8
+#endif
+
+/* number of slots of the timer wheel, one per millisecond, must be a power of two */
+#ifndef DEFERRED_EXEC_WHEEL_SIZE
+#    define DEFERRED_EXEC_WHEEL_SIZE 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Identifies a scheduled callback. Tokens are not reused right away, so a stale token is simply ignored. */
+typedef uint16_t deferred_token;
+#define INVALID_DEFERRED_TOKEN 0
+
+/** \brief Deferred callback
+ *
+ * Called from the main loop with the time it was due at, which may be a little earlier than now.
+ * Returns the delay in milliseconds, counted from trigger_time, until it should be called again,
+ * or 0 to be descheduled.
+ */
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+/** \brief Schedules a callback to be run in delay_ms milliseconds
+ *
+ * Returns INVALID_DEFERRED_TOKEN if all MAX_DEFERRED_EXECUTORS are in use.
+ */
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+
+/** \brief Reschedules a callback to be run delay_ms milliseconds from now
+ *
+ * Returns false if the token is no longer scheduled.
+ */
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+
+/** \brief Deschedules a callback
+ *
+ * Returns false if the token is no longer scheduled.
+ */
+bool cancel_deferred_exec(deferred_token token);
+
+/** \brief Runs the callbacks that are due, called from keyboard_task() */
+void deferred_exec_task(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,6 +3,8 @@
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "deferred_exec.h"
+#include <string.h>
 
 #ifdef STM32_EEPROM_ENABLE
 #    include <hal.h>
@@ -33,10 +35,93 @@ __attribute__((weak)) void eeconfig_init_kb(void) {
     eeconfig_init_user();
 }
 
+typedef struct {
+    void *  addr;
+    uint8_t size;
+    uint8_t data[EECONFIG_DEFERRED_BLOCK_SIZE];
+} eeconfig_deferred_block_t;
+
+static eeconfig_deferred_block_t eeconfig_deferred_blocks[EECONFIG_DEFERRED_BLOCKS];
+static uint8_t                   eeconfig_deferred_count = 0;
+static deferred_token            eeconfig_flush_token    = INVALID_DEFERRED_TOKEN;
+
+static uint32_t eeconfig_flush_callback(uint32_t trigger_time, void *cb_arg) {
+    eeconfig_flush_token = INVALID_DEFERRED_TOKEN;
+    eeconfig_flush();
+    return 0;
+}
+
+/** \brief Writes the blocks waiting for EECONFIG_WRITE_DELAY now
+ */
+void eeconfig_flush(void) {
+    for (uint8_t i = 0; i < eeconfig_deferred_count; i++) {
+        eeprom_update_block(eeconfig_deferred_blocks[i].data, eeconfig_deferred_blocks[i].addr, eeconfig_deferred_blocks[i].size);
+    }
+    eeconfig_deferred_count = 0;
+    cancel_deferred_exec(eeconfig_flush_token);
+    eeconfig_flush_token = INVALID_DEFERRED_TOKEN;
+}
+
+/** \brief Drops the blocks waiting to be written, before the EEPROM is reset
+ */
+static void eeconfig_discard(void) {
+    eeconfig_deferred_count = 0;
+    cancel_deferred_exec(eeconfig_flush_token);
+    eeconfig_flush_token = INVALID_DEFERRED_TOKEN;
+}
+
+/** \brief Updates a block of EEPROM once the updates to it stop
+ *
+ * A block waiting at the same address is replaced, so only the last update is written.
+ */
+void eeconfig_update_deferred(void *addr, const void *data, uint8_t size) {
+#if EECONFIG_WRITE_DELAY > 0
+    if (size <= EECONFIG_DEFERRED_BLOCK_SIZE) {
+        uint8_t i = 0;
+        while (i < eeconfig_deferred_count && (eeconfig_deferred_blocks[i].addr != addr || eeconfig_deferred_blocks[i].size != size)) {
+            i++;
+        }
+        if (i == EECONFIG_DEFERRED_BLOCKS) {
+            eeconfig_flush();
+            i = 0;
+        }
+        if (i == eeconfig_deferred_count) {
+            eeconfig_deferred_blocks[i].addr = addr;
+            eeconfig_deferred_blocks[i].size = size;
+            eeconfig_deferred_count++;
+        }
+        memcpy(eeconfig_deferred_blocks[i].data, data, size);
+
+        if (!extend_deferred_exec(eeconfig_flush_token, EECONFIG_WRITE_DELAY)) {
+            eeconfig_flush_token = defer_exec(EECONFIG_WRITE_DELAY, eeconfig_flush_callback, NULL);
+        }
+        if (eeconfig_flush_token == INVALID_DEFERRED_TOKEN) {
+            // no deferred executor left, write it now
+            eeconfig_flush();
+        }
+        return;
+    }
+#endif
+    eeprom_update_block(data, addr, size);
+}
+
+/** \brief Reads a block of EEPROM, including an update still waiting to be written
+ */
+void eeconfig_read_deferred(void *data, const void *addr, uint8_t size) {
+    for (uint8_t i = 0; i < eeconfig_deferred_count; i++) {
+        if (eeconfig_deferred_blocks[i].addr == addr && eeconfig_deferred_blocks[i].size == size) {
+            memcpy(data, eeconfig_deferred_blocks[i].data, size);
+            return;
+        }
+    }
+    eeprom_read_block(data, addr, size);
+}
+
 /*
  * FIXME: needs doc
  */
 void eeconfig_init_quantum(void) {
+    eeconfig_discard();
 #ifdef STM32_EEPROM_ENABLE
     EEPROM_Erase();
 #endif
@@ -98,6 +183,7 @@ void eeconfig_enable(void) { eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_N
  * FIXME: needs doc
  */
 void eeconfig_disable(void) {
+    eeconfig_discard();
 #ifdef STM32_EEPROM_ENABLE
     EEPROM_Erase();
 #endif
@@ -159,12 +245,16 @@ void eeconfig_update_keymap(uint16_t val) {
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_backlight(void) { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
+uint8_t eeconfig_read_backlight(void) {
+    uint8_t val;
+    eeconfig_read_deferred(&val, EECONFIG_BACKLIGHT, sizeof(val));
+    return val;
+}
 /** \brief eeconfig update backlight
  *
  * FIXME: needs doc
  */
-void eeconfig_update_backlight(uint8_t val) { eeprom_update_byte(EECONFIG_BACKLIGHT, val); }
+void eeconfig_update_backlight(uint8_t val) { eeconfig_update_deferred(EECONFIG_BACKLIGHT, &val, sizeof(val)); }
 
 /** \brief eeconfig read audio
  *
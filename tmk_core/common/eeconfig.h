@@ -110,3 +110,26 @@ void     eeconfig_update_haptic(uint32_t val);
 
 bool eeconfig_read_handedness(void);
 void eeconfig_update_handedness(bool val);
+
+/* Deferred writes
+ *
+ * Settings that keys change in quick succession, like the lighting, are written with
+ * eeconfig_update_deferred(). The block is kept in RAM and only written once no update
+ * came for EECONFIG_WRITE_DELAY milliseconds, on suspend or before jumping to the
+ * bootloader, so holding a key down writes the EEPROM once.
+ */
+#ifndef EECONFIG_WRITE_DELAY
+#    define EECONFIG_WRITE_DELAY 2000
+#endif
+
+/* number of blocks that can wait to be written at the same time */
+#ifndef EECONFIG_DEFERRED_BLOCKS
+#    define EECONFIG_DEFERRED_BLOCKS 4
+#endif
+
+/* largest block that can wait, larger ones are written right away */
+#define EECONFIG_DEFERRED_BLOCK_SIZE 8
+
+void eeconfig_update_deferred(void *addr, const void *data, uint8_t size);
+void eeconfig_read_deferred(void *data, const void *addr, uint8_t size);
+void eeconfig_flush(void);
@@ -16,9 +16,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 //#include <avr/interrupt.h>
 #include "keycode.h"
 #include "host.h"
+#include "keyboard.h"
 #include "util.h"
 #include "debug.h"
 
@@ -45,9 +47,47 @@ led_t host_keyboard_led_state(void) {
     return (led_t)((*driver->keyboard_leds)());
 }
 
-/* send report */
-void host_keyboard_send(report_keyboard_t *report) {
-    if (!driver) return;
+#if QMK_KEYS_PER_SCAN > 1
+static report_keyboard_t last_keyboard_report;
+static report_keyboard_t pending_keyboard_report;
+static bool              keyboard_report_coalescing = false;
+static bool              keyboard_report_pending    = false;
+
+/** \brief Checks whether replacing the pending report would hide a key transition from the host
+ *
+ * A press is lost when a key only appears in the pending report, and a release is lost when a key
+ * only disappears in the pending report.
+ */
+static bool keyboard_report_loses_edge(report_keyboard_t *sent, report_keyboard_t *pending, report_keyboard_t *next) {
+    if ((pending->mods & ~sent->mods & ~next->mods) | (~pending->mods & sent->mods & next->mods)) {
+        return true;
+    }
+#    ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            if ((pending->nkro.bits[i] & ~sent->nkro.bits[i] & ~next->nkro.bits[i]) | (~pending->nkro.bits[i] & sent->nkro.bits[i] & next->nkro.bits[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+#    endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (is_key_pressed(pending, pending->keys[i]) && !is_key_pressed(sent, pending->keys[i]) && !is_key_pressed(next, pending->keys[i])) {
+            return true;
+        }
+        if (is_key_pressed(sent, sent->keys[i]) && !is_key_pressed(pending, sent->keys[i]) && is_key_pressed(next, sent->keys[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+static void host_keyboard_send_now(report_keyboard_t *report) {
+#if QMK_KEYS_PER_SCAN > 1
+    memcpy(&last_keyboard_report, report, sizeof(report_keyboard_t));
+#endif
 #if defined(NKRO_ENABLE) && defined(NKRO_SHARED_EP)
     if (keyboard_protocol && keymap_config.nkro) {
         /* The callers of this function assume that report->mods is where mods go in.
@@ -73,6 +113,45 @@ void host_keyboard_send(report_keyboard_t *report) {
     }
 }
 
+/* send report */
+void host_keyboard_send(report_keyboard_t *report) {
+    if (!driver) return;
+#if QMK_KEYS_PER_SCAN > 1
+    if (keyboard_report_coalescing) {
+        if (keyboard_report_pending && keyboard_report_loses_edge(&last_keyboard_report, &pending_keyboard_report, report)) {
+            host_keyboard_send_now(&pending_keyboard_report);
+        }
+        memcpy(&pending_keyboard_report, report, sizeof(report_keyboard_t));
+        keyboard_report_pending = true;
+        return;
+    }
+#endif
+    host_keyboard_send_now(report);
+}
+
+/** \brief Start holding back keyboard reports
+ *
+ * Until host_keyboard_coalesce_end() is called, consecutive reports are merged into one as long as
+ * no key press or release would be hidden from the host by doing so.
+ */
+void host_keyboard_coalesce_begin(void) {
+#if QMK_KEYS_PER_SCAN > 1
+    keyboard_report_coalescing = true;
+#endif
+}
+
+/** \brief Stop holding back keyboard reports and send the pending one, if any
+ */
+void host_keyboard_coalesce_end(void) {
+#if QMK_KEYS_PER_SCAN > 1
+    keyboard_report_coalescing = false;
+    if (keyboard_report_pending) {
+        keyboard_report_pending = false;
+        if (driver) host_keyboard_send_now(&pending_keyboard_report);
+    }
+#endif
+}
+
 void host_mouse_send(report_mouse_t *report) {
     if (!driver) return;
 #ifdef MOUSE_SHARED_EP
@@ -48,6 +48,10 @@ void    host_mouse_send(report_mouse_t *report);
 void    host_system_send(uint16_t data);
 void    host_consumer_send(uint16_t data);
 
+/* keyboard report coalescing */
+void host_keyboard_coalesce_begin(void);
+void host_keyboard_coalesce_end(void);
+
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "keycode.h"
 #include "timer.h"
 #include "sync_timer.h"
+#include "deferred_exec.h"
 #include "print.h"
 #include "debug.h"
 #include "command.h"
@@ -31,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "send_string.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -57,6 +59,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef RGB_MATRIX_ENABLE
 #    include "rgb_matrix.h"
 #endif
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+#    include "led_governor.h"
+#endif
 #ifdef ENCODER_ENABLE
 #    include "encoder.h"
 #endif
@@ -136,6 +141,12 @@ uint32_t get_matrix_scan_rate(void) { return last_matrix_scan_count; }
 #    define matrix_scan_perf_task()
 #endif
 
+#if (MATRIX_COLS <= 16)
+#    define matrix_row_ctz(row) __builtin_ctz(row)
+#else
+#    define matrix_row_ctz(row) __builtin_ctzl(row)
+#endif
+
 #ifdef MATRIX_HAS_GHOST
 extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
 static matrix_row_t   get_real_keys(uint8_t row, matrix_row_t rowdata) {
@@ -192,6 +203,18 @@ void disable_jtag(void) {
 #endif
 }
 
+/** \brief matrix_get_dirty_rows
+ *
+ * Default for matrices that don't keep track of the rows changed by matrix_scan().
+ */
+__attribute__((weak)) bool matrix_get_dirty_rows(uint8_t dirty_rows[]) { return false; }
+
+/** \brief matrix_get_row_change_time
+ *
+ * Default for matrices that don't stamp their changes, the events are stamped with the time of the scan instead.
+ */
+__attribute__((weak)) uint16_t matrix_get_row_change_time(uint8_t row) { return 0; }
+
 /** \brief matrix_setup
  *
  * FIXME: needs doc
@@ -342,6 +365,145 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
 #endif
 }
 
+static matrix_row_t matrix_prev[MATRIX_ROWS];
+static uint8_t      rows_pending[MATRIX_DIRTY_ROWS_SIZE];
+
+_Static_assert(KEY_EVENT_QUEUE_SIZE >= 2 && KEY_EVENT_QUEUE_SIZE <= 256, "KEY_EVENT_QUEUE_SIZE must be between 2 and 256, the queue is indexed with uint8_t");
+
+/* key events waiting for action_exec(), oldest first */
+static keyevent_t key_event_queue[KEY_EVENT_QUEUE_SIZE];
+static uint8_t    key_event_queue_head = 0;
+static uint8_t    key_event_queue_tail = 0;
+
+static inline bool key_event_queue_full(void) { return (key_event_queue_head + 1) % KEY_EVENT_QUEUE_SIZE == key_event_queue_tail; }
+
+static inline uint8_t key_event_queue_count(void) { return (key_event_queue_head + KEY_EVENT_QUEUE_SIZE - key_event_queue_tail) % KEY_EVENT_QUEUE_SIZE; }
+
+static inline void key_event_enqueue(keyevent_t event) {
+    key_event_queue[key_event_queue_head] = event;
+    key_event_queue_head                  = (key_event_queue_head + 1) % KEY_EVENT_QUEUE_SIZE;
+}
+
+static inline keyevent_t key_event_dequeue(void) {
+    keyevent_t event     = key_event_queue[key_event_queue_tail];
+    key_event_queue_tail = (key_event_queue_tail + 1) % KEY_EVENT_QUEUE_SIZE;
+    return event;
+}
+
+/** \brief row_change_age
+ *
+ * How long ago the row changed, as seen at scan_time.
+ */
+static inline uint16_t row_change_age(uint8_t row, uint16_t scan_time) {
+    uint16_t time = matrix_get_row_change_time(row);
+    return time ? scan_time - time : 0;
+}
+
+/** \brief queue_matrix_events
+ *
+ * Queues a key event for every switch that changed since the last call, stamped with the time the
+ * matrix saw the row change, or scan_time if it doesn't track it. The rows are queued oldest change
+ * first. Rows that don't fit into the queue stay pending and are picked up later with the time of the
+ * row's latest change, ahead of the rows that changed after it.
+ */
+static void queue_matrix_events(uint16_t scan_time) {
+    uint8_t rows_dirty[MATRIX_DIRTY_ROWS_SIZE] = {0};
+    uint8_t rows_changed[MATRIX_DIRTY_ROWS_SIZE];
+    uint8_t rows_carried[MATRIX_DIRTY_ROWS_SIZE];
+
+    if (!matrix_get_dirty_rows(rows_dirty)) {
+        // the matrix doesn't track its changes, so every row has to be checked
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            rows_dirty[r / 8] |= 1 << (r % 8);
+        }
+    }
+
+    // only the rows that differ from what was queued so far stay pending
+    for (uint8_t i = 0; i < MATRIX_DIRTY_ROWS_SIZE; i++) {
+        rows_carried[i] = rows_pending[i];
+        rows_pending[i] |= rows_dirty[i];
+        uint8_t rows = rows_pending[i];
+        while (rows) {
+            uint8_t r = i * 8 + __builtin_ctz(rows);
+            rows &= rows - 1;
+            if (matrix_get_row(r) == matrix_prev[r]) {
+                rows_pending[i] &= ~(1 << (r % 8));
+            }
+        }
+        rows_changed[i] = rows_pending[i];
+    }
+
+    while (!key_event_queue_full()) {
+        // the row that changed first, on a tie the one left pending by an earlier call, then the lowest one
+        uint8_t  r       = 0;
+        uint16_t age     = 0;
+        bool     carried = false;
+        bool     found   = false;
+        for (uint8_t i = 0; i < MATRIX_DIRTY_ROWS_SIZE; i++) {
+            uint8_t rows = rows_changed[i];
+            while (rows) {
+                uint8_t row = i * 8 + __builtin_ctz(rows);
+                rows &= rows - 1;
+                uint16_t row_age     = row_change_age(row, scan_time);
+                bool     row_carried = rows_carried[i] & (1 << (row % 8));
+                if (!found || row_age > age || (row_age == age && row_carried && !carried)) {
+                    r       = row;
+                    age     = row_age;
+                    carried = row_carried;
+                    found   = true;
+                }
+            }
+        }
+        if (!found) break;
+        rows_changed[r / 8] &= ~(1 << (r % 8));
+
+        matrix_row_t matrix_row    = matrix_get_row(r);
+        matrix_row_t matrix_change = matrix_row ^ matrix_prev[r];
+        uint16_t     time          = scan_time - age;
+#ifdef MATRIX_HAS_GHOST
+        if (has_ghost_in_row(r, matrix_row)) {
+            // keep the row pending until the ghost is gone
+            continue;
+        }
+#endif
+        if (debug_matrix) matrix_print();
+        while (matrix_change && !key_event_queue_full()) {
+            uint8_t      c        = matrix_row_ctz(matrix_change);
+            matrix_row_t col_mask = MATRIX_ROW_SHIFTER << c;
+            key_event_enqueue((keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = time});
+            // record a processed key
+            matrix_prev[r] ^= col_mask;
+            matrix_change ^= col_mask;
+        }
+        if (!matrix_change) {
+            // otherwise the queue is full, the rest of the row is picked up on the next scan
+            rows_pending[r / 8] &= ~(1 << (r % 8));
+        }
+    }
+}
+
+/** \brief dispatch_key_events
+ *
+ * Runs up to QMK_KEYS_PER_SCAN queued key events through the action layer in the order they were
+ * detected, merging the keyboard reports they produce so that a chord reaches the host in a single
+ * report instead of one report per key. Returns the number of events dispatched.
+ */
+static uint8_t dispatch_key_events(void) {
+    uint8_t count = key_event_queue_count();
+    if (count > QMK_KEYS_PER_SCAN) count = QMK_KEYS_PER_SCAN;
+
+    if (count > 1) host_keyboard_coalesce_begin();
+    for (uint8_t i = 0; i < count; i++) {
+        keyevent_t event = key_event_dequeue();
+        if (should_process_keypress()) {
+            action_exec(event);
+        }
+        switch_events(event.key.row, event.key.col, event.pressed);
+    }
+    if (count > 1) host_keyboard_coalesce_end();
+    return count;
+}
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs:
@@ -355,13 +517,7 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
  * This is repeatedly called as fast as possible.
  */
 void keyboard_task(void) {
-    static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
-    uint8_t keys_processed = 0;
-#endif
+    static uint8_t led_status = 0;
 #ifdef ENCODER_ENABLE
     bool encoders_changed = false;
 #endif
@@ -372,52 +528,28 @@ void keyboard_task(void) {
     uint8_t matrix_changed = matrix_scan();
     if (matrix_changed) last_matrix_activity_trigger();
 
-    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
-        matrix_row    = matrix_get_row(r);
-        matrix_change = matrix_row ^ matrix_prev[r];
-        if (matrix_change) {
-#ifdef MATRIX_HAS_GHOST
-            if (has_ghost_in_row(r, matrix_row)) {
-                continue;
-            }
-#endif
-            if (debug_matrix) matrix_print();
-            matrix_row_t col_mask = 1;
-            for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
-                if (matrix_change & col_mask) {
-                    if (should_process_keypress()) {
-                        action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
-                        });
-                    }
-                    // record a processed key
-                    matrix_prev[r] ^= col_mask;
-
-                    switch_events(r, c, (matrix_row & col_mask));
-
-#ifdef QMK_KEYS_PER_SCAN
-                    // only jump out if we have processed "enough" keys.
-                    if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
-                        // process a key per task call
-                        goto MATRIX_LOOP_END;
-                }
-            }
-        }
-    }
-    // call with pseudo tick event when no real key event.
-#ifdef QMK_KEYS_PER_SCAN
-    // we can get here with some keys processed now.
-    if (!keys_processed)
-#endif
+    // timeouts that expired are handled before the key events of this scan
+    deferred_exec_task();
+
+    // changes keep the time they were detected at while waiting in the queue
+    queue_matrix_events(timer_read() | 1); /* time should not be 0 */
+
+    if (!dispatch_key_events()) {
+        // call with pseudo tick event when no real key event.
         action_exec(TICK);
+    }
 
-MATRIX_LOOP_END:
+    // type what send_string_async() queued, one report change at a time
+    send_string_task();
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+    led_governor_task();
+#endif
+
 #if defined(RGBLIGHT_ENABLE)
     rgblight_task();
 #endif
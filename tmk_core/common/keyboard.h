@@ -48,6 +48,18 @@ static inline bool IS_NOEVENT(keyevent_t event) { return event.time == 0 || (eve
 static inline bool IS_PRESSED(keyevent_t event) { return (!IS_NOEVENT(event) && event.pressed); }
 static inline bool IS_RELEASED(keyevent_t event) { return (!IS_NOEVENT(event) && !event.pressed); }
 
+/* Maximum number of key events collected from the matrix and dispatched in one keyboard_task() call.
+ * Changes beyond this are left in the matrix and picked up on the next scan. */
+#ifndef QMK_KEYS_PER_SCAN
+#    define QMK_KEYS_PER_SCAN 8
+#endif
+
+/* Number of slots in the queue holding detected key events until they are dispatched. Events keep
+ * the time they were detected at while queued. One slot is always left unused. */
+#ifndef KEY_EVENT_QUEUE_SIZE
+#    define KEY_EVENT_QUEUE_SIZE (2 * QMK_KEYS_PER_SCAN + 1)
+#endif
+
 /* Tick event */
 #define TICK \
     (keyevent_t) { .key = (keypos_t){.row = 255, .col = 255}, .pressed = false, .time = (timer_read() | 1) }